@@ -178,6 +178,16 @@ namespace pimax_openxr {
         // Maintain a list of known actionsets for validation.
         m_actions.insert(*action);
 
+        // The snapshot is only updated upon attach and sync. The action set of a new action is not attached, which is
+        // what the queries report for an action missing from the snapshot. Unless the action reuses the address of a
+        // destroyed one, that is still in the snapshot.
+        {
+            const auto snapshot = m_actionSnapshot.get();
+            if (snapshot && snapshot->get(*action)) {
+                updateActionSnapshot(false);
+            }
+        }
+
         TraceLoggingWrite(g_traceProvider, "xrCreateAction", TLXArg(*action, "Action"));
 
         return XR_SUCCESS;
@@ -267,6 +277,10 @@ namespace pimax_openxr {
 
             m_activeActionSets.insert(attachInfo->actionSets[i]);
         }
+        updateActionSnapshot(false);
+
+        // Unlike controllers, the eye tracker cannot come and go, so we bind it once and for all.
+        rebindEyeGazeActions();
 
         return XR_SUCCESS;
     }
@@ -292,6 +306,8 @@ namespace pimax_openxr {
         const int side = topLevelUserPath != XR_NULL_PATH ? getActionSide(getXrPath(topLevelUserPath)) : 0;
         if (side >= 0) {
             interactionProfile->interactionProfile = m_currentInteractionProfile[side];
+        } else if (has_XR_EXT_eye_gaze_interaction && isEyeGazePath(getXrPath(topLevelUserPath))) {
+            interactionProfile->interactionProfile = m_eyeGazeInteractionProfile;
         } else {
             // Paths we don't support (eg: gamepad).
             interactionProfile->interactionProfile = XR_NULL_PATH;
@@ -322,58 +338,16 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_BOOLEAN_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
-        }
-
-        std::optional<bool> combinedState;
-        const std::string subActionPath = getXrPath(getInfo->subactionPath);
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            const auto& value = source.second;
-            const bool isBound = value.buttonMap != nullptr || value.floatValue != nullptr;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrGetActionStateBoolean",
-                              TLArg(fullPath.c_str(), "ActionSourcePath"),
-                              TLArg(isBound, "Bound"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (isBound && side >= 0) {
-                if (m_isControllerActive[side] && m_validActionSets.count(xrAction.actionSet)) {
-                    // Per spec, the combined state is the OR of all values.
-                    if (value.buttonMap) {
-                        combinedState = combinedState.value_or(false) || value.buttonMap[side] & value.buttonType;
-                    } else {
-                        combinedState = combinedState.value_or(false) || value.floatValue[side] > 0.99f;
-                    }
-                }
-            }
+        action_snapshot::State actionState;
+        const XrResult result = getActionState(*getInfo, XR_ACTION_TYPE_BOOLEAN_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        state->isActive = combinedState ? XR_TRUE : XR_FALSE;
-        state->currentState = combinedState.value_or(xrAction.lastBoolValue);
-
-        state->changedSinceLastSync = !!state->currentState != xrAction.lastBoolValue;
-        state->lastChangeTime = state->changedSinceLastSync ? pvrTimeToXrTime(m_cachedInputState.TimeInSeconds)
-                                                            : xrAction.lastBoolValueChangedTime;
-
-        xrAction.lastBoolValue = state->currentState;
-        xrAction.lastBoolValueChangedTime = state->lastChangeTime;
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
+        state->currentState = actionState.boolValue ? XR_TRUE : XR_FALSE;
+        state->changedSinceLastSync = actionState.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = actionState.lastChangeTime;
 
         TraceLoggingWrite(g_traceProvider,
                           "xrGetActionStateBoolean",
@@ -403,67 +377,16 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_FLOAT_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
-        }
-
-        std::optional<float> combinedState;
-        const std::string subActionPath = getXrPath(getInfo->subactionPath);
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            const auto& value = source.second;
-            const bool isBound = value.floatValue != nullptr ||
-                                 (value.vector2fValue != nullptr && value.vector2fIndex >= 0) ||
-                                 value.buttonMap != nullptr;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrGetActionStateFloat",
-                              TLArg(fullPath.c_str(), "ActionSourcePath"),
-                              TLArg(isBound, "Bound"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (isBound && side >= 0) {
-                if (m_isControllerActive[side] && m_validActionSets.count(xrAction.actionSet)) {
-                    // Per spec, the combined state is the absolute maximum of all values.
-                    if (value.floatValue) {
-                        combinedState = std::max(combinedState.value_or(-std::numeric_limits<float>::infinity()),
-                                                 value.floatValue[side]);
-                    } else if (value.buttonMap) {
-                        combinedState = std::max(combinedState.value_or(-std::numeric_limits<float>::infinity()),
-                                                 value.buttonMap[side] & value.buttonType ? 1.f : 0.f);
-                    } else {
-                        const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
-
-                        combinedState = std::max(combinedState.value_or(-std::numeric_limits<float>::infinity()),
-                                                 value.vector2fIndex == 0 ? vector2fValue.x : vector2fValue.y);
-                    }
-                }
-            }
+        action_snapshot::State actionState;
+        const XrResult result = getActionState(*getInfo, XR_ACTION_TYPE_FLOAT_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        state->isActive = combinedState ? XR_TRUE : XR_FALSE;
-        state->currentState = combinedState.value_or(xrAction.lastFloatValue);
-
-        state->changedSinceLastSync = state->currentState != xrAction.lastFloatValue;
-        state->lastChangeTime = state->changedSinceLastSync ? pvrTimeToXrTime(m_cachedInputState.TimeInSeconds)
-                                                            : xrAction.lastFloatValueChangedTime;
-
-        xrAction.lastFloatValue = state->currentState;
-        xrAction.lastFloatValueChangedTime = state->lastChangeTime;
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
+        state->currentState = actionState.floatValue;
+        state->changedSinceLastSync = actionState.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = actionState.lastChangeTime;
 
         TraceLoggingWrite(g_traceProvider,
                           "xrGetActionStateFloat",
@@ -493,63 +416,16 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_VECTOR2F_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
-        }
-
-        std::optional<XrVector2f> combinedState;
-        const std::string subActionPath = getXrPath(getInfo->subactionPath);
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            const auto& value = source.second;
-            const bool isBound = value.vector2fValue != nullptr;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrGetActionStateVector2f",
-                              TLArg(fullPath.c_str(), "ActionSourcePath"),
-                              TLArg(isBound, "Bound"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (isBound && side >= 0) {
-                if (m_isControllerActive[side] && m_validActionSets.count(xrAction.actionSet)) {
-                    const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
-
-                    // Per spec, the combined state if the one of the vector with the longest length.
-                    const float l1 = combinedState ? sqrt(combinedState.value().x * combinedState.value().x +
-                                                          combinedState.value().y * combinedState.value().y)
-                                                   : 0.f;
-                    const float l2 = sqrt(vector2fValue.x * vector2fValue.x + vector2fValue.y * vector2fValue.y);
-                    if (l2 >= l1) {
-                        combinedState = vector2fValue;
-                    }
-                }
-            }
+        action_snapshot::State actionState;
+        const XrResult result = getActionState(*getInfo, XR_ACTION_TYPE_VECTOR2F_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        state->isActive = combinedState ? XR_TRUE : XR_FALSE;
-        state->currentState = combinedState.value_or(xrAction.lastVector2fValue);
-
-        state->changedSinceLastSync = state->currentState.x != xrAction.lastVector2fValue.x ||
-                                      state->currentState.y != xrAction.lastVector2fValue.y;
-        state->lastChangeTime = state->changedSinceLastSync ? pvrTimeToXrTime(m_cachedInputState.TimeInSeconds)
-                                                            : xrAction.lastVector2fValueChangedTime;
-
-        xrAction.lastVector2fValue = state->currentState;
-        xrAction.lastVector2fValueChangedTime = state->lastChangeTime;
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
+        state->currentState = {actionState.x, actionState.y};
+        state->changedSinceLastSync = actionState.changedSinceLastSync ? XR_TRUE : XR_FALSE;
+        state->lastChangeTime = actionState.lastChangeTime;
 
         TraceLoggingWrite(
             g_traceProvider,
@@ -580,38 +456,13 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (!m_actions.count(getInfo->action)) {
-            return XR_ERROR_HANDLE_INVALID;
-        }
-
-        Action& xrAction = *(Action*)getInfo->action;
-
-        if (xrAction.type != XR_ACTION_TYPE_POSE_INPUT) {
-            return XR_ERROR_ACTION_TYPE_MISMATCH;
-        }
-
-        if (!m_activeActionSets.count(xrAction.actionSet)) {
-            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        action_snapshot::State actionState;
+        const XrResult result = getActionState(*getInfo, XR_ACTION_TYPE_POSE_INPUT, actionState);
+        if (XR_FAILED(result)) {
+            return result;
         }
 
-        const std::string subActionPath = getXrPath(getInfo->subactionPath);
-        for (const auto& source : xrAction.actionSources) {
-            if (!startsWith(source.first, subActionPath)) {
-                continue;
-            }
-
-            const std::string& fullPath = source.first;
-            TraceLoggingWrite(g_traceProvider, "xrGetActionStatePose", TLArg(fullPath.c_str(), "ActionSourcePath"));
-
-            // We only support hands paths, not gamepad etc.
-            const int side = getActionSide(fullPath);
-            if (side >= 0) {
-                state->isActive = m_isControllerActive[side] ? XR_TRUE : XR_FALSE;
-
-                // Per spec we must consistently pick one source. We pick the first one.
-                break;
-            }
-        }
+        state->isActive = actionState.isActive ? XR_TRUE : XR_FALSE;
 
         TraceLoggingWrite(g_traceProvider, "xrGetActionStatePose", TLArg(!!state->isActive, "Active"));
 
@@ -657,7 +508,11 @@ namespace pimax_openxr {
         }
 
         // Latch the state of all inputs, and we will let the further calls to xrGetActionState*() do the triage.
-        CHECK_PVRCMD(pvr_getInputState(m_pvrSession, &m_cachedInputState));
+        if (m_inputSamplerThread.joinable()) {
+            latchInputHistory();
+        } else {
+            CHECK_PVRCMD(pvr_getInputState(m_pvrSession, &m_cachedInputState));
+        }
         for (uint32_t side = 0; side < 2; side++) {
             if (!doSide[side]) {
                 continue;
@@ -723,6 +578,8 @@ namespace pimax_openxr {
         }
         m_lastForcedInteractionProfile = m_forcedInteractionProfile;
 
+        updateActionSnapshot(true);
+
         return XR_SUCCESS;
     }
 
@@ -833,6 +690,29 @@ namespace pimax_openxr {
                 }
                 needSpace = true;
             }
+        } else if (isEyeGazePath(path)) {
+            bool needSpace = false;
+
+            if ((getInfo->whichComponents & XR_INPUT_SOURCE_LOCALIZED_NAME_USER_PATH_BIT)) {
+                localizedName += "Eyes";
+                needSpace = true;
+            }
+
+            if ((getInfo->whichComponents & XR_INPUT_SOURCE_LOCALIZED_NAME_INTERACTION_PROFILE_BIT)) {
+                if (needSpace) {
+                    localizedName += " ";
+                }
+                localizedName += "Eye Tracker";
+                needSpace = true;
+            }
+
+            if ((getInfo->whichComponents & XR_INPUT_SOURCE_LOCALIZED_NAME_COMPONENT_BIT)) {
+                if (needSpace) {
+                    localizedName += " ";
+                }
+                localizedName += "Gaze Pose";
+                needSpace = true;
+            }
         }
 
         if (bufferCapacityInput && bufferCapacityInput < localizedName.length()) {
@@ -907,6 +787,18 @@ namespace pimax_openxr {
                                           TLArg(vibration->frequency, "Frequency"),
                                           TLArg(vibration->duration, "Duration"));
 
+                        if (m_hapticsThread.joinable()) {
+                            // The haptics thread synthesizes the pulses for the frequency and duration. An amplitude
+                            // of 0 stops the current vibration.
+                            haptic_timeline::Vibration request;
+                            request.amplitude = vibration->amplitude;
+                            request.frequency = vibration->frequency;
+                            request.duration =
+                                vibration->duration == XR_MIN_HAPTIC_DURATION ? 0.0 : vibration->duration / 1e9;
+                            queueHaptics(side, request);
+                            break;
+                        }
+
                         // NOTE: PVR only supports pulses, so there is nothing we can do with the frequency/duration?
                         // OpenComposite seems to pass an amplitude of 0 sometimes, which is not supported.
                         if (vibration->amplitude > 0) {
@@ -969,7 +861,10 @@ namespace pimax_openxr {
             // We only support hands paths, not gamepad etc.
             const int side = getActionSide(fullPath);
             if (isOutput && side >= 0) {
-                // Nothing to do here.
+                // Without the haptics thread, there is nothing to do here: a pulse cannot be interrupted.
+                if (m_hapticsThread.joinable()) {
+                    queueHaptics(side, std::nullopt);
+                }
             }
         }
 
@@ -1109,8 +1004,9 @@ namespace pimax_openxr {
             m_currentInteractionProfile[side] = XR_NULL_PATH;
             m_controllerGripPose[side] = m_controllerAimPose[side] = Pose::Identity();
         }
+        m_actionSpaceBindingsVersion++;
 
-        m_currentInteractionProfileDirty = true;
+        queueInteractionProfileChanged();
     }
 
     std::string OpenXrRuntime::getXrPath(XrPath path) const {
@@ -1146,4 +1042,170 @@ namespace pimax_openxr {
         return {normalizedInput.x * scaling, normalizedInput.y * scaling};
     }
 
+    void OpenXrRuntime::initializeActionSnapshot() {
+        m_actionFilterPaths[action_snapshot::FilterNone] = XR_NULL_PATH;
+        for (uint32_t filter = action_snapshot::FilterNone + 1; filter < action_snapshot::FilterCount; filter++) {
+            CHECK_XRCMD(
+                xrStringToPath(XR_NULL_HANDLE, action_snapshot::FilterPaths[filter], &m_actionFilterPaths[filter]));
+        }
+
+        // No state carries over from a previous session.
+        m_actionSnapshot.publish(nullptr);
+        updateActionSnapshot(false);
+    }
+
+    // Publish the actions for the xrGetActionState*() functions. Their state is computed upon a sync. Otherwise (eg:
+    // when the action sets are attached), only the validation information is updated, and the states of the previous
+    // sync are kept.
+    void OpenXrRuntime::updateActionSnapshot(bool isSync) {
+        const auto previous = m_actionSnapshot.get();
+        auto snapshot = std::make_unique<ActionSnapshot>();
+        for (const auto& action : m_actions) {
+            const Action& xrAction = *(Action*)action;
+            auto& entry = snapshot->add(action);
+            entry.type = xrAction.type;
+            entry.isAttached = m_activeActionSets.count(xrAction.actionSet);
+            if (xrAction.type == XR_ACTION_TYPE_VIBRATION_OUTPUT) {
+                continue;
+            }
+
+            const action_snapshot::Entry* previousEntry = previous ? previous->get(action) : nullptr;
+            if (!isSync) {
+                if (previousEntry) {
+                    entry.states = previousEntry->states;
+                }
+                continue;
+            }
+
+            for (uint32_t filter = 0; filter < action_snapshot::FilterCount; filter++) {
+                double changeTime = 0.0;
+                entry.states[filter] = computeActionState(xrAction, action_snapshot::FilterPaths[filter], changeTime);
+
+                action_snapshot::trackChanges(entry.states[filter],
+                                              previousEntry ? previousEntry->states[filter] : action_snapshot::State{},
+                                              pvrTimeToXrTime(changeTime));
+            }
+        }
+
+        m_actionSnapshot.publish(std::move(snapshot));
+    }
+
+    // Combine the values of all the sources of an action under a subaction path.
+    action_snapshot::State OpenXrRuntime::computeActionState(const Action& xrAction,
+                                                             const std::string& subActionPath,
+                                                             double& changeTime) const {
+        action_snapshot::State state;
+
+        for (const auto& source : xrAction.actionSources) {
+            if (!startsWith(source.first, subActionPath)) {
+                continue;
+            }
+
+            const std::string& fullPath = source.first;
+            const auto& value = source.second;
+
+            // We only support hands paths (and eyes for poses), not gamepad etc.
+            const int side = getActionSide(fullPath);
+            if (xrAction.type == XR_ACTION_TYPE_POSE_INPUT) {
+                if (side >= 0) {
+                    state.isActive = m_isControllerActive[side];
+
+                    // Per spec we must consistently pick one source. We pick the first one.
+                    break;
+                } else if (isEyeGazePath(fullPath)) {
+                    // Sources are only bound when eye tracking is available.
+                    state.isActive = true;
+
+                    // Per spec we must consistently pick one source. We pick the first one.
+                    break;
+                }
+                continue;
+            }
+
+            if (side < 0 || !m_isControllerActive[side] || !m_validActionSets.count(xrAction.actionSet)) {
+                continue;
+            }
+
+            if (xrAction.type == XR_ACTION_TYPE_BOOLEAN_INPUT) {
+                // Per spec, the combined state is the OR of all values.
+                if (value.buttonMap) {
+                    state.boolValue = state.boolValue || value.buttonMap[side] & value.buttonType;
+                } else if (value.floatValue) {
+                    state.boolValue = state.boolValue || value.floatValue[side] > 0.99f;
+                } else {
+                    continue;
+                }
+            } else if (xrAction.type == XR_ACTION_TYPE_FLOAT_INPUT) {
+                float floatValue;
+                if (value.floatValue) {
+                    floatValue = value.floatValue[side];
+                } else if (value.buttonMap) {
+                    floatValue = value.buttonMap[side] & value.buttonType ? 1.f : 0.f;
+                } else if (value.vector2fValue && value.vector2fIndex >= 0) {
+                    const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
+                    floatValue = value.vector2fIndex == 0 ? vector2fValue.x : vector2fValue.y;
+                } else {
+                    continue;
+                }
+
+                // Per spec, the combined state is the absolute maximum of all values.
+                state.floatValue = state.isActive ? std::max(state.floatValue, floatValue) : floatValue;
+            } else if (xrAction.type == XR_ACTION_TYPE_VECTOR2F_INPUT) {
+                if (!value.vector2fValue) {
+                    continue;
+                }
+
+                const XrVector2f vector2fValue = handleJoystickDeadzone(value.vector2fValue[side]);
+
+                // Per spec, the combined state if the one of the vector with the longest length.
+                const float l1 = std::sqrt(state.x * state.x + state.y * state.y);
+                const float l2 = std::sqrt(vector2fValue.x * vector2fValue.x + vector2fValue.y * vector2fValue.y);
+                if (!state.isActive || l2 >= l1) {
+                    state.x = vector2fValue.x;
+                    state.y = vector2fValue.y;
+                }
+            } else {
+                continue;
+            }
+
+            state.isActive = true;
+            changeTime = std::max(changeTime, getInputChangeTime(value, side));
+        }
+
+        return state;
+    }
+
+    // Validate a query and read the state of an action from the latest snapshot. This can be called from any thread.
+    XrResult OpenXrRuntime::getActionState(const XrActionStateGetInfo& getInfo,
+                                           XrActionType type,
+                                           action_snapshot::State& state) const {
+        if (getInfo.action == XR_NULL_HANDLE) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        // Actions created since the last update of the snapshot belong to action sets that are not attached.
+        const auto snapshot = m_actionSnapshot.get();
+        const action_snapshot::Entry* entry = snapshot ? snapshot->get(getInfo.action) : nullptr;
+        if (!entry) {
+            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        }
+
+        if (entry->type != type) {
+            return XR_ERROR_ACTION_TYPE_MISMATCH;
+        }
+
+        if (!entry->isAttached) {
+            return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+        }
+
+        uint32_t filter = 0;
+        while (filter < action_snapshot::FilterCount && m_actionFilterPaths[filter] != getInfo.subactionPath) {
+            filter++;
+        }
+
+        // Unknown subaction paths have no source, and are inactive.
+        state = filter < action_snapshot::FilterCount ? entry->states[filter] : action_snapshot::State{};
+        return XR_SUCCESS;
+    }
+
 } // namespace pimax_openxr
@@ -0,0 +1,220 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The state of all actions, computed once per xrSyncActions() and published as an immutable snapshot, so that the
+// xrGetActionState*() functions can be called from any thread while the next sync is being prepared.
+
+namespace pimax_openxr::action_snapshot {
+
+    // The subaction paths that an application may query a state for.
+    enum Filter : uint32_t {
+        FilterNone = 0,
+        FilterLeftHand,
+        FilterRightHand,
+        FilterEyes,
+
+        FilterCount
+    };
+
+    constexpr const char* FilterPaths[FilterCount] = {"", "/user/hand/left", "/user/hand/right", "/user/eyes_ext"};
+
+    struct State {
+        bool isActive{false};
+
+        // Only the value for the type of the action is used.
+        bool boolValue{false};
+        float floatValue{0.f};
+        float x{0.f};
+        float y{0.f};
+
+        bool changedSinceLastSync{false};
+        int64_t lastChangeTime{0};
+
+        bool hasSameValue(const State& other) const {
+            return boolValue == other.boolValue && floatValue == other.floatValue && x == other.x && y == other.y;
+        }
+    };
+
+    // Complete a state computed for the current sync from the state published by the previous sync. An inactive action
+    // keeps its previous value.
+    static inline void trackChanges(State& state, const State& previous, int64_t changeTime) {
+        if (!state.isActive) {
+            state.boolValue = previous.boolValue;
+            state.floatValue = previous.floatValue;
+            state.x = previous.x;
+            state.y = previous.y;
+        }
+
+        state.changedSinceLastSync = !state.hasSameValue(previous);
+        state.lastChangeTime = state.changedSinceLastSync ? changeTime : previous.lastChangeTime;
+    }
+
+    // An action, with what is needed to validate a query for it, so that the queries never look at the bookkeeping of
+    // the runtime while another thread modifies it.
+    struct Entry {
+        // The type of the action, as an XrActionType.
+        int32_t type{0};
+
+        // Whether the action set of the action is attached to the session.
+        bool isAttached{false};
+
+        std::array<State, FilterCount> states;
+    };
+
+    template <typename Key>
+    class Snapshot {
+      public:
+        Entry& add(Key key) {
+            return m_entries[key];
+        }
+
+        // Returns nullptr for an action that does not exist (anymore).
+        const Entry* get(Key key) const {
+            const auto it = m_entries.find(key);
+            return it != m_entries.cend() ? &it->second : nullptr;
+        }
+
+        const State* find(Key key, uint32_t filter) const {
+            const Entry* entry = get(key);
+            if (!entry || filter >= FilterCount) {
+                return nullptr;
+            }
+            return &entry->states[filter];
+        }
+
+      private:
+        std::map<Key, Entry> m_entries;
+    };
+
+    // Holds the latest snapshot. Reading is lock-free: a reader only increments the count of readers of the current
+    // epoch, then loads the pointer. A replaced snapshot is freed by a publication once the epoch moved twice, which
+    // requires all the readers that could have loaded it to be gone. Publications are serialized, they are rare.
+    template <typename T>
+    class Publisher {
+      public:
+        // Keeps the snapshot that it read alive, even if a newer one is published meanwhile.
+        class Reader {
+          public:
+            explicit Reader(const Publisher& publisher) : m_publisher(publisher) {
+                while (true) {
+                    const uint64_t epoch = m_publisher.m_epoch.load();
+                    m_slot = epoch % 2;
+                    m_publisher.m_readers[m_slot].fetch_add(1);
+                    if (m_publisher.m_epoch.load() == epoch) {
+                        break;
+                    }
+                    m_publisher.m_readers[m_slot].fetch_sub(1);
+                }
+                reload();
+            }
+
+            ~Reader() {
+                m_publisher.m_readers[m_slot].fetch_sub(1);
+            }
+
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+
+            // Read the latest snapshot again (eg: after publishing one). The previous one remains alive as well.
+            void reload() {
+                m_value = m_publisher.m_latest.load();
+            }
+
+            const T* get() const {
+                return m_value;
+            }
+
+            const T* operator->() const {
+                return m_value;
+            }
+
+            const T& operator*() const {
+                return *m_value;
+            }
+
+            explicit operator bool() const {
+                return m_value != nullptr;
+            }
+
+          private:
+            const Publisher& m_publisher;
+            uint32_t m_slot{0};
+            const T* m_value{nullptr};
+        };
+
+        Publisher() = default;
+        Publisher(const Publisher&) = delete;
+        Publisher& operator=(const Publisher&) = delete;
+
+        // There must be no readers left.
+        ~Publisher() {
+            delete m_latest.load();
+            for (const auto& retired : m_retired) {
+                delete retired.first;
+            }
+        }
+
+        void publish(std::unique_ptr<const T> snapshot) {
+            std::unique_lock lock(m_publishLock);
+
+            const T* previous = m_latest.exchange(snapshot.release());
+            if (previous) {
+                m_retired.push_back({previous, m_epoch.load()});
+            }
+
+            // Move to the next epoch once the readers of the previous one are gone, since they count in the same slot.
+            // Without readers, moving twice frees the snapshot just replaced.
+            uint64_t epoch = m_epoch.load();
+            for (int i = 0; i < 2 && !m_readers[(epoch + 1) % 2].load(); i++) {
+                m_epoch.store(++epoch);
+            }
+
+            while (!m_retired.empty() && m_retired.front().second + 2 <= epoch) {
+                delete m_retired.front().first;
+                m_retired.pop_front();
+            }
+        }
+
+        Reader get() const {
+            return Reader(*this);
+        }
+
+        // The number of replaced snapshots not freed yet.
+        size_t getRetiredCount() const {
+            std::unique_lock lock(m_publishLock);
+            return m_retired.size();
+        }
+
+      private:
+        std::atomic<const T*> m_latest{nullptr};
+        std::atomic<uint64_t> m_epoch{0};
+        mutable std::atomic<uint32_t> m_readers[2]{};
+
+        mutable std::mutex m_publishLock;
+        std::deque<std::pair<const T*, uint64_t>> m_retired;
+    };
+
+} // namespace pimax_openxr::action_snapshot
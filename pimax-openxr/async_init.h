@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// An initialization running on a background thread, so that it overlaps with the application's own initialization. The
+// callers needing its outcome wait for it.
+
+namespace pimax_openxr::async_init {
+
+    class Task {
+      public:
+        Task() = default;
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        // The task must complete before its owner's state goes away.
+        ~Task() {
+            if (m_future.valid()) {
+                m_future.wait();
+            }
+        }
+
+        template <typename Init>
+        void start(Init&& init) {
+            m_future = std::async(std::launch::async, std::forward<Init>(init)).share();
+        }
+
+        // Block until the initialization completed. A failure is rethrown to every caller, since the state that the
+        // initialization was supposed to produce is not usable. A task that was never started counts as completed.
+        void wait() const {
+            if (m_future.valid()) {
+                m_future.get();
+            }
+        }
+
+        bool isReady() const {
+            return !m_future.valid() || m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+      private:
+        std::shared_future<void> m_future;
+    };
+
+} // namespace pimax_openxr::async_init
@@ -0,0 +1,332 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Math shared between the GPU composition passes and their CPU reference implementations. The CPU versions are
+// written to mirror the HLSL line by line, so that placement and blending can be validated without a GPU.
+
+namespace pimax_openxr::composition {
+
+    // A linear mapping between two normalized coordinate spaces: out = in * scale + offset.
+    struct UvTransform {
+        XrVector2f scale{1.f, 1.f};
+        XrVector2f offset{0.f, 0.f};
+    };
+
+    static inline XrVector2f apply(const UvTransform& transform, const XrVector2f& uv) {
+        return {uv.x * transform.scale.x + transform.offset.x, uv.y * transform.scale.y + transform.offset.y};
+    }
+
+    // Mapping from the sub-image of a view (0..1) to the texture coordinates of the whole swapchain image.
+    static inline UvTransform computeSubImageTransform(const XrRect2Di& imageRect, uint32_t width, uint32_t height) {
+        UvTransform transform;
+        transform.scale = {(float)imageRect.extent.width / width, (float)imageRect.extent.height / height};
+        transform.offset = {(float)imageRect.offset.x / width, (float)imageRect.offset.y / height};
+        return transform;
+    }
+
+    // Mapping from the peripheral view (0..1) to the focus view (0..1). Both views are assumed to share the same pose,
+    // which is true for the views returned by xrLocateViews().
+    static inline UvTransform computeInsetTransform(const XrFovf& peripheralFov, const XrFovf& focusFov) {
+        const float pl = std::tan(peripheralFov.angleLeft);
+        const float pr = std::tan(peripheralFov.angleRight);
+        const float pu = std::tan(peripheralFov.angleUp);
+        const float pd = std::tan(peripheralFov.angleDown);
+        const float fl = std::tan(focusFov.angleLeft);
+        const float fr = std::tan(focusFov.angleRight);
+        const float fu = std::tan(focusFov.angleUp);
+        const float fd = std::tan(focusFov.angleDown);
+
+        // Texture coordinates go top to bottom, while the up tangent is the largest.
+        UvTransform transform;
+        transform.scale = {(pr - pl) / (fr - fl), (pu - pd) / (fu - fd)};
+        transform.offset = {(pl - fl) / (fr - fl), (fu - pu) / (fu - fd)};
+        return transform;
+    }
+
+    // Place a focus view of the given relative size (0..1) within the peripheral view. The focus view is centered on
+    // the given tangents (eg: the eye gaze), and shifted as needed to remain fully inside the peripheral view.
+    static inline XrFovf computeFocusFov(const XrFovf& peripheralFov, float size, const XrVector2f& centerTan) {
+        const float pl = std::tan(peripheralFov.angleLeft);
+        const float pr = std::tan(peripheralFov.angleRight);
+        const float pu = std::tan(peripheralFov.angleUp);
+        const float pd = std::tan(peripheralFov.angleDown);
+
+        const float halfWidth = (pr - pl) * size / 2;
+        const float halfHeight = (pu - pd) * size / 2;
+        const float cx = std::clamp(centerTan.x, pl + halfWidth, pr - halfWidth);
+        const float cy = std::clamp(centerTan.y, pd + halfHeight, pu - halfHeight);
+
+        XrFovf focusFov;
+        focusFov.angleLeft = std::atan(cx - halfWidth);
+        focusFov.angleRight = std::atan(cx + halfWidth);
+        focusFov.angleUp = std::atan(cy + halfHeight);
+        focusFov.angleDown = std::atan(cy - halfHeight);
+        return focusFov;
+    }
+
+    // The center of a view, expressed as tangents.
+    static inline XrVector2f getFovCenter(const XrFovf& fov) {
+        return {(std::tan(fov.angleLeft) + std::tan(fov.angleRight)) / 2,
+                (std::tan(fov.angleUp) + std::tan(fov.angleDown)) / 2};
+    }
+
+    static inline float smoothstep(float edge0, float edge1, float x) {
+        const float t = std::clamp((x - edge0) / (edge1 - edge0), 0.f, 1.f);
+        return t * t * (3.f - 2.f * t);
+    }
+
+    // Weight of the focus view at a given location of the focus view (0..1). The edges of the inset are feathered
+    // over the given width (in the same normalized unit) to hide the seam between the two views.
+    static inline float computeInsetWeight(const XrVector2f& focusUv, float feather) {
+        const float edge = std::min(std::min(focusUv.x, 1.f - focusUv.x), std::min(focusUv.y, 1.f - focusUv.y));
+        if (edge < 0.f) {
+            return 0.f;
+        }
+        return feather > 0.f ? smoothstep(0.f, feather, edge) : 1.f;
+    }
+
+    // A very simple RGBA image for the CPU reference implementation.
+    struct CpuImage {
+        uint32_t width{0};
+        uint32_t height{0};
+        std::vector<XrColor4f> pixels;
+
+        CpuImage() = default;
+        CpuImage(uint32_t width, uint32_t height) : width(width), height(height), pixels(width * height) {
+        }
+
+        XrColor4f& at(uint32_t x, uint32_t y) {
+            return pixels[y * width + x];
+        }
+
+        const XrColor4f& at(uint32_t x, uint32_t y) const {
+            return pixels[y * width + x];
+        }
+
+        // Texel fetch with clamp-to-edge addressing, like Load() with clamped coordinates on the GPU.
+        const XrColor4f& load(int x, int y) const {
+            return at(std::clamp(x, 0, (int)width - 1), std::clamp(y, 0, (int)height - 1));
+        }
+
+        // Bilinear sampling with clamp-to-edge addressing, like the linear clamp sampler used on the GPU.
+        XrColor4f sample(const XrVector2f& uv) const {
+            const float x = std::clamp(uv.x * width - 0.5f, 0.f, (float)width - 1);
+            const float y = std::clamp(uv.y * height - 0.5f, 0.f, (float)height - 1);
+            const uint32_t x0 = (uint32_t)x;
+            const uint32_t y0 = (uint32_t)y;
+            const uint32_t x1 = std::min(x0 + 1, width - 1);
+            const uint32_t y1 = std::min(y0 + 1, height - 1);
+            const float fx = x - x0;
+            const float fy = y - y0;
+
+            auto lerp = [](const XrColor4f& a, const XrColor4f& b, float t) {
+                return XrColor4f{
+                    a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, a.a + (b.a - a.a) * t};
+            };
+            return lerp(lerp(at(x0, y0), at(x1, y0), fx), lerp(at(x0, y1), at(x1, y1), fx), fy);
+        }
+    };
+
+    // CPU reference for the quad views composition: merge the focus view into the peripheral view. The output has the
+    // resolution of the peripheral view.
+    static inline void compositeInsetCpu(const CpuImage& peripheral,
+                                         const CpuImage& focus,
+                                         const UvTransform& inset,
+                                         float feather,
+                                         CpuImage& output) {
+        output = CpuImage(peripheral.width, peripheral.height);
+        for (uint32_t y = 0; y < output.height; y++) {
+            for (uint32_t x = 0; x < output.width; x++) {
+                const XrVector2f uv{(x + 0.5f) / output.width, (y + 0.5f) / output.height};
+                const XrVector2f focusUv = apply(inset, uv);
+                const float weight = computeInsetWeight(focusUv, feather);
+
+                const XrColor4f peripheralColor = peripheral.sample(uv);
+                const XrColor4f focusColor = weight > 0.f ? focus.sample(focusUv) : XrColor4f{};
+                output.at(x, y) = {peripheralColor.r + (focusColor.r - peripheralColor.r) * weight,
+                                   peripheralColor.g + (focusColor.g - peripheralColor.g) * weight,
+                                   peripheralColor.b + (focusColor.b - peripheralColor.b) * weight,
+                                   peripheralColor.a + (focusColor.a - peripheralColor.a) * weight};
+            }
+        }
+    }
+
+    // Helpers for the per-channel math below.
+    static inline XrColor4f operator+(const XrColor4f& a, const XrColor4f& b) {
+        return {a.r + b.r, a.g + b.g, a.b + b.b, a.a + b.a};
+    }
+
+    static inline XrColor4f operator*(const XrColor4f& a, float b) {
+        return {a.r * b, a.g * b, a.b * b, a.a * b};
+    }
+
+    static inline XrColor4f minColor(const XrColor4f& a, const XrColor4f& b) {
+        return {std::min(a.r, b.r), std::min(a.g, b.g), std::min(a.b, b.b), std::min(a.a, b.a)};
+    }
+
+    static inline XrColor4f maxColor(const XrColor4f& a, const XrColor4f& b) {
+        return {std::max(a.r, b.r), std::max(a.g, b.g), std::max(a.b, b.b), std::max(a.a, b.a)};
+    }
+
+    static inline float luma(const XrColor4f& color) {
+        return 0.299f * color.r + 0.587f * color.g + 0.114f * color.b;
+    }
+
+    // Lanczos kernel with a window of 2 texels.
+    static inline float lanczos2(float x) {
+        constexpr float Pi = 3.14159265358979f;
+        if (x < 1e-5f) {
+            return 1.f;
+        }
+        if (x >= 2.f) {
+            return 0.f;
+        }
+        return 2.f * std::sin(Pi * x) * std::sin(Pi * x / 2.f) / (Pi * Pi * x * x);
+    }
+
+    // How quickly the upscaling kernel becomes anisotropic with the local contrast.
+    constexpr float UpscalingEdgeSensitivity = 4.f;
+
+    // Maximum negative lobe of the sharpening kernel (same as AMD FSR1 RCAS).
+    constexpr float SharpeningLimit = 0.25f - 1.f / 16.f;
+
+    // Edge-adaptive upscaling of one output texel: a 4x4 Lanczos-2 filter, stretched along the edge direction detected
+    // in the nearest 2x2 texels to avoid jaggies, and clamped to these 2x2 texels to avoid ringing. This follows the
+    // principles of AMD FSR1 EASU in a simpler form. The fetch function must clamp to the edges of the input.
+    template <typename Fetch>
+    static inline XrColor4f upscaleEdgeAdaptive(const Fetch& fetch, float inputX, float inputY) {
+        const float px = inputX - 0.5f;
+        const float py = inputY - 0.5f;
+        const int bx = (int)std::floor(px);
+        const int by = (int)std::floor(py);
+        const float fx = px - bx;
+        const float fy = py - by;
+
+        // Detect the edge direction from the gradient of the nearest 2x2 texels.
+        const XrColor4f c00 = fetch(bx, by);
+        const XrColor4f c10 = fetch(bx + 1, by);
+        const XrColor4f c01 = fetch(bx, by + 1);
+        const XrColor4f c11 = fetch(bx + 1, by + 1);
+        const float l00 = luma(c00);
+        const float l10 = luma(c10);
+        const float l01 = luma(c01);
+        const float l11 = luma(c11);
+        const float gx = ((l10 - l00) + (l11 - l01)) * 0.5f;
+        const float gy = ((l01 - l00) + (l11 - l10)) * 0.5f;
+        const float gradient = std::sqrt(gx * gx + gy * gy);
+        const float dx = gradient > 1e-4f ? gx / gradient : 1.f;
+        const float dy = gradient > 1e-4f ? gy / gradient : 0.f;
+        const float stretch = 1.f / (1.f + std::clamp(gradient * UpscalingEdgeSensitivity, 0.f, 1.f));
+
+        XrColor4f sum{0, 0, 0, 0};
+        float weights = 0.f;
+        for (int j = -1; j <= 2; j++) {
+            for (int i = -1; i <= 2; i++) {
+                const float ox = i - fx;
+                const float oy = j - fy;
+                const float across = ox * dx + oy * dy;
+                const float along = (oy * dx - ox * dy) * stretch;
+                const float weight = lanczos2(std::sqrt(across * across + along * along));
+                sum = sum + fetch(bx + i, by + j) * weight;
+                weights += weight;
+            }
+        }
+        const XrColor4f color = sum * (1.f / std::max(weights, 1e-5f));
+
+        // Anti-ringing.
+        return maxColor(minColor(color, maxColor(maxColor(c00, c10), maxColor(c01, c11))),
+                        minColor(minColor(c00, c10), minColor(c01, c11)));
+    }
+
+    // Contrast-adaptive sharpening of one texel: a 5-tap cross whose negative lobe is limited so that the output never
+    // exceeds the local minimum/maximum. This follows AMD FSR1 RCAS. Sharpness goes from 0 (none) to 1 (maximum).
+    template <typename Fetch>
+    static inline XrColor4f sharpenContrastAdaptive(const Fetch& fetch, int x, int y, float sharpness) {
+        const XrColor4f b = fetch(x, y - 1);
+        const XrColor4f d = fetch(x - 1, y);
+        const XrColor4f e = fetch(x, y);
+        const XrColor4f f = fetch(x + 1, y);
+        const XrColor4f h = fetch(x, y + 1);
+
+        auto channelLobe = [](float b, float d, float e, float f, float h) {
+            b = std::clamp(b, 0.f, 1.f);
+            d = std::clamp(d, 0.f, 1.f);
+            e = std::clamp(e, 0.f, 1.f);
+            f = std::clamp(f, 0.f, 1.f);
+            h = std::clamp(h, 0.f, 1.f);
+            const float mn = std::min(std::min(b, d), std::min(f, h));
+            const float mx = std::max(std::max(b, d), std::max(f, h));
+            const float hitMin = std::min(mn, e) / std::max(4.f * mx, 1e-5f);
+            const float hitMax = (1.f - std::max(mx, e)) / std::min(4.f * mn - 4.f, -1e-5f);
+            return std::max(-hitMin, hitMax);
+        };
+        const float lobeR = channelLobe(b.r, d.r, e.r, f.r, h.r);
+        const float lobeG = channelLobe(b.g, d.g, e.g, f.g, h.g);
+        const float lobeB = channelLobe(b.b, d.b, e.b, f.b, h.b);
+        const float lobe =
+            std::max(-SharpeningLimit, std::min(std::max(std::max(lobeR, lobeG), lobeB), 0.f)) * sharpness;
+
+        XrColor4f color = ((b + d + f + h) * lobe + e) * (1.f / (4.f * lobe + 1.f));
+        color.a = e.a;
+        return color;
+    }
+
+    // CPU reference for the upscaling pass. The output resolution is given by the output image.
+    static inline void upscaleCpu(const CpuImage& input, CpuImage& output) {
+        const auto fetch = [&](int x, int y) { return input.load(x, y); };
+        const float scaleX = (float)input.width / output.width;
+        const float scaleY = (float)input.height / output.height;
+        for (uint32_t y = 0; y < output.height; y++) {
+            for (uint32_t x = 0; x < output.width; x++) {
+                output.at(x, y) = upscaleEdgeAdaptive(fetch, (x + 0.5f) * scaleX, (y + 0.5f) * scaleY);
+            }
+        }
+    }
+
+    // CPU reference for the depth upscaling pass, with the depth in the red channel. Depth is never interpolated, since
+    // blending the depth of a foreground and a background object gives a depth that belongs to neither.
+    static inline void upscaleDepthCpu(const CpuImage& input, CpuImage& output) {
+        const float scaleX = (float)input.width / output.width;
+        const float scaleY = (float)input.height / output.height;
+        for (uint32_t y = 0; y < output.height; y++) {
+            for (uint32_t x = 0; x < output.width; x++) {
+                output.at(x, y) = input.load((int)((x + 0.5f) * scaleX), (int)((y + 0.5f) * scaleY));
+            }
+        }
+    }
+
+    // CPU reference for the sharpening pass.
+    static inline void sharpenCpu(const CpuImage& input, float sharpness, CpuImage& output) {
+        const auto fetch = [&](int x, int y) { return input.load(x, y); };
+        output = CpuImage(input.width, input.height);
+        for (uint32_t y = 0; y < output.height; y++) {
+            for (uint32_t x = 0; x < output.width; x++) {
+                output.at(x, y) = sharpenContrastAdaptive(fetch, (int)x, (int)y, sharpness);
+            }
+        }
+    }
+
+} // namespace pimax_openxr::composition
@@ -57,6 +57,15 @@ void main(uint2 pos : SV_DispatchThreadID)
 }
     )_"};
 
+    // Vertex shader for a full screen triangle, used by the composition passes.
+    const std::string_view FullScreenShaderHlsl = R"_(
+void main(uint id : SV_VertexID, out float4 position : SV_POSITION, out float2 uv : TEXCOORD0)
+{
+    uv = float2((id << 1) & 2, id & 2);
+    position = float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+}
+    )_";
+
 } // namespace
 
 namespace pimax_openxr {
@@ -134,6 +143,16 @@ namespace pimax_openxr {
             return XR_ERROR_GRAPHICS_DEVICE_INVALID;
         }
 
+        // Reuse the device-level resources of the previous session if it was on the same device.
+        ComPtr<IUnknown> deviceIdentity;
+        CHECK_HRCMD(d3dBindings.device->QueryInterface(IID_PPV_ARGS(deviceIdentity.ReleaseAndGetAddressOf())));
+        m_d3d11DeviceKey = {device_cache::toKey(desc.AdapterLuid.LowPart, desc.AdapterLuid.HighPart),
+                            deviceIdentity.Get(),
+                            interop};
+        m_isD3D11DeviceReused = canReuseD3D11Device(m_d3d11DeviceKey);
+        m_keptD3D11Device.reset();
+        TraceLoggingWrite(g_traceProvider, "xrCreateSession", TLArg(m_isD3D11DeviceReused, "ReusedDevice"));
+
         ComPtr<ID3D11DeviceContext> deviceContext;
         d3dBindings.device->GetImmediateContext(deviceContext.ReleaseAndGetAddressOf());
 
@@ -142,47 +161,22 @@ namespace pimax_openxr {
         CHECK_HRCMD(d3dBindings.device->QueryInterface(m_d3d11Device.ReleaseAndGetAddressOf()));
         CHECK_HRCMD(deviceContext->QueryInterface(m_d3d11DeviceContext.ReleaseAndGetAddressOf()));
 
-        // Create the resources for depth resolve.
-        for (int i = 0; i < ARRAYSIZE(m_resolveShader); i++) {
-            ComPtr<ID3DBlob> shaderBytes;
-            ComPtr<ID3DBlob> errMsgs;
-            DWORD flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
-
-#ifdef _DEBUG
-            flags |= D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_DEBUG;
-#else
-            flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-#endif
-
-            HRESULT hr = D3DCompile(ResolveShaderHlsl[i].data(),
-                                    ResolveShaderHlsl[i].size(),
-                                    nullptr,
-                                    nullptr,
-                                    nullptr,
-                                    "main",
-                                    "cs_5_0",
-                                    flags,
-                                    0,
-                                    shaderBytes.ReleaseAndGetAddressOf(),
-                                    errMsgs.ReleaseAndGetAddressOf());
-            if (FAILED(hr)) {
-                std::string errMsg((const char*)errMsgs->GetBufferPointer(), errMsgs->GetBufferSize());
-                ErrorLog("D3DCompile failed %X: %s\n", hr, errMsg.c_str());
-                CHECK_HRESULT(hr, "D3DCompile failed");
+        if (!m_isD3D11DeviceReused) {
+            // Create the fence tracking the GPU usage of the swapchains destroyed by the application. A reused fence
+            // keeps counting from its current value.
+            CHECK_HRCMD(m_d3d11Device->CreateFence(
+                0, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(m_retirementFence.ReleaseAndGetAddressOf())));
+            m_retirementFenceValue = 0;
+
+            for (uint32_t i = 0; i < k_numGpuTimers; i++) {
+                m_gpuTimerApp[i] = std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
+                m_gpuTimerSynchronizationDuration[i] =
+                    std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
+                m_gpuTimerPrecomposition[i] =
+                    std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
+                m_gpuTimerPvrComposition[i] =
+                    std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
             }
-            CHECK_HRCMD(m_d3d11Device->CreateComputeShader(shaderBytes->GetBufferPointer(),
-                                                           shaderBytes->GetBufferSize(),
-                                                           nullptr,
-                                                           m_resolveShader[i].ReleaseAndGetAddressOf()));
-            setDebugName(m_resolveShader[i].Get(), "DepthResolve CS");
-        }
-
-        for (uint32_t i = 0; i < k_numGpuTimers; i++) {
-            m_gpuTimerApp[i] = std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
-            m_gpuTimerSynchronizationDuration[i] =
-                std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
-            m_gpuTimerPrecomposition[i] = std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
-            m_gpuTimerPvrComposition[i] = std::make_unique<GpuTimer>(m_d3d11Device.Get(), m_d3d11DeviceContext.Get());
         }
 
         // If RenderDoc is loaded, then create a DXGI swapchain to signal events. Otherwise RenderDoc will
@@ -213,18 +207,93 @@ namespace pimax_openxr {
     void OpenXrRuntime::cleanupD3D11() {
         flushD3D11Context();
 
+        cleanupQuadViews();
+        cleanupUpscaling();
+
+        m_dxgiSwapchain.Reset();
+        evictResolveScratch(true);
+
+        if (device_cache::shouldKeep(m_d3d11DeviceKey, m_useWarmSessionRestart, m_useWarmSessionRestartAppDevice)) {
+            // Keep the device-level resources for the next session, see canReuseD3D11Device().
+            m_keptD3D11Device = m_d3d11DeviceKey;
+            TraceLoggingWrite(g_traceProvider, "KeepD3D11Device", TLArg(m_d3d11DeviceKey.interop, "Interop"));
+        } else {
+            releaseD3D11DeviceResources();
+        }
+    }
+
+    // Create the device that PVR uses for D3D12, Vulkan and OpenGL sessions, or reuse the one of the previous session.
+    ComPtr<ID3D11Device> OpenXrRuntime::createInteropD3D11Device(IDXGIAdapter* adapter) {
+        DXGI_ADAPTER_DESC desc;
+        CHECK_HRCMD(adapter->GetDesc(&desc));
+
+        ComPtr<ID3D11Device> device;
+        if (canReuseD3D11Device(
+                {device_cache::toKey(desc.AdapterLuid.LowPart, desc.AdapterLuid.HighPart), nullptr, true})) {
+            CHECK_HRCMD(m_d3d11Device->QueryInterface(IID_PPV_ARGS(device.ReleaseAndGetAddressOf())));
+            return device;
+        }
+
+        ComPtr<ID3D11DeviceContext> deviceContext;
+        D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+        UINT flags = 0;
+#ifdef _DEBUG
+        flags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+        CHECK_HRCMD(D3D11CreateDevice(adapter,
+                                      D3D_DRIVER_TYPE_UNKNOWN,
+                                      0,
+                                      flags,
+                                      &featureLevel,
+                                      1,
+                                      D3D11_SDK_VERSION,
+                                      device.ReleaseAndGetAddressOf(),
+                                      nullptr,
+                                      deviceContext.ReleaseAndGetAddressOf()));
+
+        return device;
+    }
+
+    // Whether the device-level resources kept from the previous session can serve a session on the given device. They
+    // are released otherwise, since the application moved to another device.
+    bool OpenXrRuntime::canReuseD3D11Device(const device_cache::Key& key) {
+        if (!m_keptD3D11Device) {
+            return false;
+        }
+
+        if (device_cache::canReuse(*m_keptD3D11Device, key) && m_d3d11Device->GetDeviceRemovedReason() == S_OK) {
+            return true;
+        }
+
+        TraceLoggingWrite(g_traceProvider, "ReleaseKeptD3D11Device");
+        releaseD3D11DeviceResources();
+        return false;
+    }
+
+    // Release the resources tied to the D3D11 device, including the device itself.
+    void OpenXrRuntime::releaseD3D11DeviceResources() {
         for (uint32_t i = 0; i < k_numGpuTimers; i++) {
+            m_gpuTimerApp[i].reset();
             m_gpuTimerSynchronizationDuration[i].reset();
             m_gpuTimerPrecomposition[i].reset();
             m_gpuTimerPvrComposition[i].reset();
         }
 
-        m_dxgiSwapchain.Reset();
+        releaseQuadViewsResources();
+        releaseUpscalingResources();
+        releaseCompositionResources();
+
+        // The recycled swapchains were created on the device.
+        clearSwapchainPool();
+
+        m_retirementFence.Reset();
+        m_retirementFenceValue = 0;
         for (int i = 0; i < ARRAYSIZE(m_resolveShader); i++) {
             m_resolveShader[i].Reset();
         }
         m_d3d11DeviceContext.Reset();
         m_d3d11Device.Reset();
+        m_keptD3D11Device.reset();
     }
 
     // Retrieve the swapchain images (ID3D11Texture2D) for the application to use.
@@ -239,6 +308,8 @@ namespace pimax_openxr {
         // app to use, then perform additional conversion steps during xrEndFrame().
         D3D11_TEXTURE2D_DESC desc{};
         if (!initialized && xrSwapchain.needDepthResolve) {
+            initializeResolveShaders();
+
             // FIXME: Today we only do resolve for D32_FLOAT_S8X24 to D32_FLOAT, so we hard-code the
             // corresponding formats below.
 
@@ -249,16 +320,6 @@ namespace pimax_openxr {
             desc.MipLevels = xrSwapchain.xrDesc.mipCount;
             desc.SampleDesc.Count = xrSwapchain.xrDesc.sampleCount;
 
-            // PVR does not support creating a depth texture with the RTV/UAV capability. We must use another
-            // intermediate texture to run our shader.
-            D3D11_TEXTURE2D_DESC resolvedDesc = desc;
-            resolvedDesc.ArraySize = 1;
-            resolvedDesc.Format = DXGI_FORMAT_R32_TYPELESS;
-            resolvedDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
-            CHECK_HRCMD(
-                m_d3d11Device->CreateTexture2D(&resolvedDesc, nullptr, xrSwapchain.resolved.ReleaseAndGetAddressOf()));
-            setDebugName(xrSwapchain.resolved.Get(), fmt::format("DepthResolve Texture[{}]", (void*)&xrSwapchain));
-
             // The texture will be sampled by our resolve shader.
             desc.BindFlags |= D3D11_BIND_SHADER_RESOURCE;
 
@@ -325,6 +386,16 @@ namespace pimax_openxr {
                     for (uint32_t i = 0; i < xrSwapchain.xrDesc.arraySize; i++) {
                         xrSwapchain.imagesResourceView[i].push_back({});
                     }
+
+                    const uint32_t bitsPerPixel = pvrGetBitsPerPixel(PVR_FORMAT_D32_FLOAT_S8X24_UINT);
+                    m_gpuMemory.add(gpu_memory::Category::DepthResolveImage,
+                                    &xrSwapchain,
+                                    gpu_memory::estimateTextureSize(desc.Width,
+                                                                    desc.Height,
+                                                                    desc.ArraySize,
+                                                                    desc.MipLevels,
+                                                                    desc.SampleDesc.Count,
+                                                                    bitsPerPixel));
                 }
             }
 
@@ -343,12 +414,114 @@ namespace pimax_openxr {
             }
         }
 
+        if (!initialized && xrSwapchain.needDepthResolve) {
+            reportGpuMemory();
+        }
+
+        // Create the swapchains for the other slices of the array now, rather than during the first xrEndFrame() that
+        // uses them. The ones that end up never used are released later.
+        if (!initialized && m_useEagerSliceSwapchains) {
+            const uint64_t deadline = xrSwapchain.sliceTracker.createAll(
+                m_sessionTotalFrameCount, [&](uint32_t slice) { createSliceSwapchain(xrSwapchain, slice, true); });
+            m_unusedSlicesDeadline = slice_swapchains::earliestDeadline(m_unusedSlicesDeadline, deadline);
+        }
+
         return XR_SUCCESS;
     }
 
+    // Create the PVR swapchain receiving the copy of a slice of a texture array.
+    void OpenXrRuntime::createSliceSwapchain(Swapchain& xrSwapchain, uint32_t slice, bool eager) {
+        TraceLocalActivity(createSlice);
+        TraceLoggingWriteStart(createSlice,
+                               "CreateSliceSwapchain",
+                               TLPArg(&xrSwapchain, "Swapchain"),
+                               TLArg(slice, "Slice"),
+                               TLArg(eager, "Eager"));
+
+        auto desc = xrSwapchain.pvrDesc;
+        desc.ArraySize = 1;
+        xrSwapchain.pvrSwapchain[slice] = createPvrSwapchain(desc);
+
+        int count = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, xrSwapchain.pvrSwapchain[slice], &count));
+        if (count != xrSwapchain.slices[0].size()) {
+            throw std::runtime_error("Swapchain image count mismatch");
+        }
+
+        // Query the textures for the swapchain.
+        for (int i = 0; i < count; i++) {
+            ID3D11Texture2D* texture = nullptr;
+            CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(
+                m_pvrSession, xrSwapchain.pvrSwapchain[slice], i, IID_PPV_ARGS(&texture)));
+            setDebugName(texture, fmt::format("Runtime Sliced Texture[{}, {}, {}]", slice, i, (void*)&xrSwapchain));
+
+            xrSwapchain.slices[slice].push_back(texture);
+        }
+
+        trackSwapchainMemory(gpu_memory::Category::SliceSwapchain, &xrSwapchain, desc, xrSwapchain.pvrSwapchain[slice]);
+
+        TraceLoggingWriteStop(createSlice, "CreateSliceSwapchain");
+    }
+
+    // Release the slice swapchains created ahead of time that the application did not use.
+    void OpenXrRuntime::releaseUnusedSliceSwapchains() {
+        if (!m_unusedSlicesDeadline || m_sessionTotalFrameCount < m_unusedSlicesDeadline) {
+            return;
+        }
+
+        uint64_t nextDeadline = 0;
+        bool released = false;
+        for (auto swapchain : m_swapchains) {
+            Swapchain& xrSwapchain = *(Swapchain*)swapchain;
+            auto desc = xrSwapchain.pvrDesc;
+            desc.ArraySize = 1;
+            const auto release = [&](uint32_t slice) {
+                const pvrTextureSwapChain pvrSwapchain = xrSwapchain.pvrSwapchain[slice];
+
+                TraceLoggingWrite(g_traceProvider,
+                                  "ReleaseUnusedSliceSwapchain",
+                                  TLPArg(&xrSwapchain, "Swapchain"),
+                                  TLArg(slice, "Slice"));
+
+                // The swapchain was never committed, therefore the GPU never used it. It will be created again if the
+                // application starts using the slice.
+                m_gpuMemory.release(gpu_memory::Category::SliceSwapchain,
+                                    &xrSwapchain,
+                                    getSwapchainMemorySize(desc, pvrSwapchain));
+                retirePvrSwapchain(desc, pvrSwapchain);
+                xrSwapchain.pvrSwapchain[slice] = nullptr;
+                xrSwapchain.slices[slice].clear();
+                released = true;
+            };
+            nextDeadline = slice_swapchains::earliestDeadline(
+                nextDeadline, xrSwapchain.sliceTracker.releaseUnused(m_sessionTotalFrameCount, release));
+        }
+        m_unusedSlicesDeadline = nextDeadline;
+
+        if (released) {
+            reportGpuMemory();
+        }
+    }
+
+    // Lazily create the resources for depth resolve. Only the applications using D32_FLOAT_S8X24 need them.
+    void OpenXrRuntime::initializeResolveShaders() {
+        if (m_resolveShader[0]) {
+            return;
+        }
+
+        for (int i = 0; i < ARRAYSIZE(m_resolveShader); i++) {
+            const auto shaderBytes = compileShader(ResolveShaderHlsl[i], "main", "cs_5_0");
+            CHECK_HRCMD(m_d3d11Device->CreateComputeShader(shaderBytes->GetBufferPointer(),
+                                                           shaderBytes->GetBufferSize(),
+                                                           nullptr,
+                                                           m_resolveShader[i].ReleaseAndGetAddressOf()));
+            setDebugName(m_resolveShader[i].Get(), "DepthResolve CS");
+        }
+    }
+
     // Prepare a PVR swapchain to be used by PVR.
     void OpenXrRuntime::prepareAndCommitSwapchainImage(
-        Swapchain& xrSwapchain, uint32_t slice, std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed) const {
+        Swapchain& xrSwapchain, uint32_t slice, std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed) {
         // If the texture was already committed, do nothing.
         if (committed.count(std::make_pair(xrSwapchain.pvrSwapchain[0], slice))) {
             return;
@@ -359,30 +532,8 @@ namespace pimax_openxr {
         // - For unsupported depth format, we must do a conversion.
         // For unsupported depth formats with texture arrays, we must do both!
         if (slice > 0 || xrSwapchain.needDepthResolve) {
-            // Lazily create a second swapchain for this slice of the array.
-            if (!xrSwapchain.pvrSwapchain[slice]) {
-                auto desc = xrSwapchain.pvrDesc;
-                desc.ArraySize = 1;
-                CHECK_PVRCMD(pvr_createTextureSwapChainDX(
-                    m_pvrSession, m_d3d11Device.Get(), &desc, &xrSwapchain.pvrSwapchain[slice]));
-
-                int count = -1;
-                CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, xrSwapchain.pvrSwapchain[slice], &count));
-                if (count != xrSwapchain.slices[0].size()) {
-                    throw std::runtime_error("Swapchain image count mismatch");
-                }
-
-                // Query the textures for the swapchain.
-                for (int i = 0; i < count; i++) {
-                    ID3D11Texture2D* texture = nullptr;
-                    CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(
-                        m_pvrSession, xrSwapchain.pvrSwapchain[slice], i, IID_PPV_ARGS(&texture)));
-                    setDebugName(texture,
-                                 fmt::format("Runtime Sliced Texture[{}, {}, {}]", slice, i, (void*)&xrSwapchain));
-
-                    xrSwapchain.slices[slice].push_back(texture);
-                }
-            }
+            // Create a second swapchain for this slice of the array, unless it was done with the images.
+            xrSwapchain.sliceTracker.use(slice, [&](uint32_t) { createSliceSwapchain(xrSwapchain, slice, false); });
 
             // Copy or convert into the PVR swapchain.
             int pvrDestIndex = -1;
@@ -425,18 +576,7 @@ namespace pimax_openxr {
                                              xrSwapchain.currentAcquiredIndex,
                                              (void*)&xrSwapchain));
                 }
-                if (!xrSwapchain.resolvedAccessView) {
-                    D3D11_UNORDERED_ACCESS_VIEW_DESC desc{};
-
-                    desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-                    desc.Format = DXGI_FORMAT_R32_FLOAT;
-                    desc.Texture2D.MipSlice = 0;
-
-                    CHECK_HRCMD(m_d3d11Device->CreateUnorderedAccessView(
-                        xrSwapchain.resolved.Get(), &desc, xrSwapchain.resolvedAccessView.ReleaseAndGetAddressOf()));
-                    setDebugName(xrSwapchain.resolvedAccessView.Get(),
-                                 fmt::format("DepthResolve UAV[{}]", (void*)&xrSwapchain));
-                }
+                const ResolveScratch& resolved = getResolveScratch(xrSwapchain);
 
                 // 0: shader for Tex2D, 1: shader for Tex2DArray.
                 const int shaderToUse = xrSwapchain.xrDesc.arraySize == 1 ? 0 : 1;
@@ -444,8 +584,7 @@ namespace pimax_openxr {
 
                 m_d3d11DeviceContext->CSSetShaderResources(
                     0, 1, xrSwapchain.imagesResourceView[slice][xrSwapchain.currentAcquiredIndex].GetAddressOf());
-                m_d3d11DeviceContext->CSSetUnorderedAccessViews(
-                    0, 1, xrSwapchain.resolvedAccessView.GetAddressOf(), nullptr);
+                m_d3d11DeviceContext->CSSetUnorderedAccessViews(0, 1, resolved.accessView.GetAddressOf(), nullptr);
 
                 m_d3d11DeviceContext->Dispatch((unsigned int)std::ceil(xrSwapchain.xrDesc.width / 8),
                                                (unsigned int)std::ceil(xrSwapchain.xrDesc.height / 8),
@@ -460,7 +599,7 @@ namespace pimax_openxr {
 
                 // Final copy into the PVR texture.
                 m_d3d11DeviceContext->CopySubresourceRegion(
-                    xrSwapchain.slices[slice][pvrDestIndex], 0, 0, 0, 0, xrSwapchain.resolved.Get(), 0, nullptr);
+                    xrSwapchain.slices[slice][pvrDestIndex], 0, 0, 0, 0, resolved.texture.Get(), 0, nullptr);
             }
         } else {
             // The app may render to certain swapchains (eg: quad layers) at a lower frame rate. We must perform a copy
@@ -485,6 +624,81 @@ namespace pimax_openxr {
         committed.insert(std::make_pair(xrSwapchain.pvrSwapchain[0], slice));
     }
 
+    // PVR does not support creating a depth texture with the RTV/UAV capability. We must use another intermediate
+    // texture to run our shader. It is only used while recording the resolve, so it is shared between swapchains.
+    const OpenXrRuntime::ResolveScratch& OpenXrRuntime::getResolveScratch(const Swapchain& xrSwapchain) {
+        // FIXME: Today we only do resolve for D32_FLOAT_S8X24 to D32_FLOAT, so we hard-code the corresponding formats
+        // below.
+        gpu_memory::ScratchPool<ResolveScratch>::Key key;
+        key.width = xrSwapchain.xrDesc.width;
+        key.height = xrSwapchain.xrDesc.height;
+        key.format = DXGI_FORMAT_R32_TYPELESS;
+        key.mipCount = xrSwapchain.xrDesc.mipCount;
+        key.sampleCount = xrSwapchain.xrDesc.sampleCount;
+
+        return m_resolveScratchPool.acquire(key, m_sessionTotalFrameCount, [&](uint64_t& size) {
+            ResolveScratch scratch;
+
+            D3D11_TEXTURE2D_DESC desc{};
+            desc.ArraySize = 1;
+            desc.Format = (DXGI_FORMAT)key.format;
+            desc.Width = key.width;
+            desc.Height = key.height;
+            desc.MipLevels = key.mipCount;
+            desc.SampleDesc.Count = key.sampleCount;
+            desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+            CHECK_HRCMD(m_d3d11Device->CreateTexture2D(&desc, nullptr, scratch.texture.ReleaseAndGetAddressOf()));
+            setDebugName(scratch.texture.Get(), fmt::format("DepthResolve Texture[{}x{}]", key.width, key.height));
+
+            D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+            uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+            uavDesc.Format = DXGI_FORMAT_R32_FLOAT;
+            uavDesc.Texture2D.MipSlice = 0;
+            CHECK_HRCMD(m_d3d11Device->CreateUnorderedAccessView(
+                scratch.texture.Get(), &uavDesc, scratch.accessView.ReleaseAndGetAddressOf()));
+            setDebugName(scratch.accessView.Get(), fmt::format("DepthResolve UAV[{}x{}]", key.width, key.height));
+
+            size = gpu_memory::estimateTextureSize(
+                key.width, key.height, 1, key.mipCount, key.sampleCount, pvrGetBitsPerPixel(PVR_FORMAT_D32_FLOAT));
+            m_gpuMemory.add(gpu_memory::Category::ResolveScratch, &m_resolveScratchPool, size);
+            reportGpuMemory();
+
+            TraceLoggingWrite(g_traceProvider,
+                              "ResolveScratch_Create",
+                              TLArg(key.width, "Width"),
+                              TLArg(key.height, "Height"),
+                              TLArg(size, "Size"));
+
+            return scratch;
+        });
+    }
+
+    // Release the resolve targets that are no longer used, eg: after the swapchains using them were destroyed.
+    void OpenXrRuntime::evictResolveScratch(bool all) {
+        // Keep the targets for a few seconds in case the application recreates its swapchains.
+        constexpr uint64_t MaxIdleFrames = 300;
+        constexpr uint64_t MaxSize = 256 * 1024 * 1024;
+
+        const auto onEvict = [&](const gpu_memory::ScratchPool<ResolveScratch>::Key& key, uint64_t size) {
+            TraceLoggingWrite(g_traceProvider,
+                              "ResolveScratch_Evict",
+                              TLArg(key.width, "Width"),
+                              TLArg(key.height, "Height"),
+                              TLArg(size, "Size"));
+            m_gpuMemory.release(gpu_memory::Category::ResolveScratch, &m_resolveScratchPool, size);
+        };
+
+        const auto countBefore = m_resolveScratchPool.getCount();
+        if (all) {
+            m_resolveScratchPool.clear(onEvict);
+        } else {
+            m_resolveScratchPool.evict(m_sessionTotalFrameCount, MaxIdleFrames, MaxSize, onEvict);
+        }
+        if (m_resolveScratchPool.getCount() != countBefore) {
+            reportGpuMemory();
+        }
+    }
+
     // Flush any pending work.
     void OpenXrRuntime::flushD3D11Context() {
         wil::unique_handle eventHandle;
@@ -492,4 +706,272 @@ namespace pimax_openxr {
         WaitForSingleObject(eventHandle.get(), INFINITE);
     }
 
+    ComPtr<ID3DBlob>
+    OpenXrRuntime::compileShader(std::string_view hlsl, const char* entryPoint, const char* target) const {
+        ComPtr<ID3DBlob> shaderBytes;
+        ComPtr<ID3DBlob> errMsgs;
+        DWORD flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
+
+#ifdef _DEBUG
+        flags |= D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_DEBUG;
+#else
+        flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+        // Reuse the bytecode from a previous start of the same runtime version.
+        const auto cacheDirectory = localAppData / "shaders";
+        const uint64_t key =
+            shader_cache::computeKey(hlsl, entryPoint, target, flags, D3D_COMPILER_VERSION, RuntimePrettyName);
+        const auto cached = shader_cache::load(cacheDirectory, key);
+        TraceLoggingWrite(g_traceProvider,
+                          "ShaderCache",
+                          TLArg(entryPoint, "EntryPoint"),
+                          TLArg(target, "Target"),
+                          TLArg(key, "Key"),
+                          TLArg(cached.has_value(), "Hit"));
+        if (cached) {
+            CHECK_HRCMD(D3DCreateBlob(cached->size(), shaderBytes.ReleaseAndGetAddressOf()));
+            memcpy(shaderBytes->GetBufferPointer(), cached->data(), cached->size());
+            return shaderBytes;
+        }
+
+        HRESULT hr = D3DCompile(hlsl.data(),
+                                hlsl.size(),
+                                nullptr,
+                                nullptr,
+                                nullptr,
+                                entryPoint,
+                                target,
+                                flags,
+                                0,
+                                shaderBytes.ReleaseAndGetAddressOf(),
+                                errMsgs.ReleaseAndGetAddressOf());
+        if (FAILED(hr)) {
+            std::string errMsg((const char*)errMsgs->GetBufferPointer(), errMsgs->GetBufferSize());
+            ErrorLog("D3DCompile failed %X: %s\n", hr, errMsg.c_str());
+            CHECK_HRESULT(hr, "D3DCompile failed");
+        }
+
+        // Failing to write the cache is not an error, the shader will be compiled again next time.
+        shader_cache::store(cacheDirectory, key, shaderBytes->GetBufferPointer(), shaderBytes->GetBufferSize());
+
+        return shaderBytes;
+    }
+
+    void OpenXrRuntime::releaseCompositionResources() {
+        m_compositionContextState.Reset();
+        m_linearClampSampler.Reset();
+        m_fullScreenVertexShader.Reset();
+    }
+
+    // Lazily create the resources common to all the composition passes (eg: quad views). Most apps never need them.
+    void OpenXrRuntime::initializeCompositionResources() {
+        if (m_compositionContextState) {
+            return;
+        }
+
+        const auto shaderBytes = compileShader(FullScreenShaderHlsl, "main", "vs_5_0");
+        CHECK_HRCMD(m_d3d11Device->CreateVertexShader(shaderBytes->GetBufferPointer(),
+                                                      shaderBytes->GetBufferSize(),
+                                                      nullptr,
+                                                      m_fullScreenVertexShader.ReleaseAndGetAddressOf()));
+        setDebugName(m_fullScreenVertexShader.Get(), "FullScreen VS");
+
+        D3D11_SAMPLER_DESC samplerDesc{};
+        samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        samplerDesc.AddressU = samplerDesc.AddressV = samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+        CHECK_HRCMD(m_d3d11Device->CreateSamplerState(&samplerDesc, m_linearClampSampler.ReleaseAndGetAddressOf()));
+        setDebugName(m_linearClampSampler.Get(), "LinearClamp Sampler");
+
+        // We use our own context state in order to leave the application's state untouched.
+        const D3D_FEATURE_LEVEL featureLevel = m_d3d11Device->GetFeatureLevel();
+        CHECK_HRCMD(m_d3d11Device->CreateDeviceContextState(m_d3d11Device->GetCreationFlags() &
+                                                                D3D11_CREATE_DEVICE_SINGLETHREADED,
+                                                            &featureLevel,
+                                                            1,
+                                                            D3D11_SDK_VERSION,
+                                                            __uuidof(ID3D11Device),
+                                                            nullptr,
+                                                            m_compositionContextState.ReleaseAndGetAddressOf()));
+    }
+
+    // (Re)create a runtime swapchain if its properties changed. The previous swapchain may still be used by the GPU, so
+    // it is recycled once the GPU is done with it, see releaseRetiredSwapchains().
+    void OpenXrRuntime::ensureRuntimeSwapchain(RuntimeSwapchain& swapchain,
+                                               pvrTextureFormat format,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               std::string_view name) {
+        auto& desc = swapchain.pvrDesc;
+        if (swapchain.pvrSwapchain && desc.Format == format && desc.Width == width && desc.Height == height) {
+            return;
+        }
+
+        if (swapchain.pvrSwapchain) {
+            swapchain.renderTargetView.clear();
+            swapchain.depthStencilView.clear();
+            m_retiredRuntimeSwapchains.push(signalRetirementFence(), std::make_pair(desc, swapchain.pvrSwapchain));
+            swapchain.pvrSwapchain = nullptr;
+
+            m_gpuMemory.releaseAll(&swapchain);
+            reportGpuMemory();
+        }
+
+        desc = {};
+        desc.Type = pvrTexture_2D;
+        desc.Format = format;
+        desc.MiscFlags = pvrTextureMisc_DX_Typeless;
+        desc.ArraySize = 1;
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.SampleCount = 1;
+        // D32_FLOAT is the only depth format produced by the runtime's processing.
+        const bool isDepth = format == PVR_FORMAT_D32_FLOAT;
+        desc.BindFlags = isDepth ? pvrTextureBind_DX_DepthStencil : pvrTextureBind_DX_RenderTarget;
+        swapchain.pvrSwapchain = createPvrSwapchain(desc);
+
+        int count = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, swapchain.pvrSwapchain, &count));
+        trackSwapchainMemory(gpu_memory::Category::RuntimeSwapchain, &swapchain, desc, swapchain.pvrSwapchain);
+        for (int i = 0; i < count; i++) {
+            ComPtr<ID3D11Texture2D> texture;
+            CHECK_PVRCMD(pvr_getTextureSwapChainBufferDX(
+                m_pvrSession, swapchain.pvrSwapchain, i, IID_PPV_ARGS(texture.ReleaseAndGetAddressOf())));
+            setDebugName(texture.Get(), fmt::format("{} Texture[{}]", name, i));
+
+            if (isDepth) {
+                D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc{};
+                dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+                dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+                ComPtr<ID3D11DepthStencilView> dsv;
+                CHECK_HRCMD(
+                    m_d3d11Device->CreateDepthStencilView(texture.Get(), &dsvDesc, dsv.ReleaseAndGetAddressOf()));
+                setDebugName(dsv.Get(), fmt::format("{} DSV[{}]", name, i));
+
+                swapchain.depthStencilView.push_back(dsv);
+                continue;
+            }
+
+            // Keep the sRGB format, so that blending happens in linear space.
+            D3D11_RENDER_TARGET_VIEW_DESC rtvDesc{};
+            rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+            rtvDesc.Format = pvrToDxgiTextureFormat(format);
+            ComPtr<ID3D11RenderTargetView> rtv;
+            CHECK_HRCMD(m_d3d11Device->CreateRenderTargetView(texture.Get(), &rtvDesc, rtv.ReleaseAndGetAddressOf()));
+            setDebugName(rtv.Get(), fmt::format("{} RTV[{}]", name, i));
+
+            swapchain.renderTargetView.push_back(rtv);
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "RuntimeSwapchain_Create",
+                          TLArg(std::string(name).c_str(), "Name"),
+                          TLArg(desc.Width, "Width"),
+                          TLArg(desc.Height, "Height"),
+                          TLArg((int)desc.Format, "Format"),
+                          TLArg(count, "Length"));
+    }
+
+    // Lazily create the SRV to sample the last released image of an application's swapchain. The slice of a
+    // multisampled color swapchain is resolved first, into a copy that keeps the slice indices of the swapchain. Depth
+    // swapchains are sampled through their depth component, from the application's texture when they need a resolve
+    // (see prepareAndCommitSwapchainImage()).
+    ID3D11ShaderResourceView* OpenXrRuntime::getCompositionResourceView(Swapchain& xrSwapchain, uint32_t slice) {
+        DXGI_FORMAT format = pvrToDxgiTextureFormat(xrSwapchain.pvrDesc.Format);
+        if (xrSwapchain.needDepthResolve) {
+            format = DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS;
+        } else if (format == DXGI_FORMAT_UNKNOWN) {
+            format = pvrToDxgiDepthResourceFormat(xrSwapchain.pvrDesc.Format);
+        }
+        const int index =
+            xrSwapchain.needDepthResolve ? xrSwapchain.currentAcquiredIndex : xrSwapchain.pvrLastReleasedIndex;
+        ID3D11Texture2D* const texture =
+            xrSwapchain.needDepthResolve ? xrSwapchain.images[index].Get() : xrSwapchain.slices[0][index];
+
+        if (xrSwapchain.xrDesc.sampleCount > 1) {
+            if (!xrSwapchain.compositionResolved) {
+                D3D11_TEXTURE2D_DESC desc{};
+                desc.ArraySize = xrSwapchain.xrDesc.arraySize;
+                desc.Format = format;
+                desc.Width = xrSwapchain.xrDesc.width;
+                desc.Height = xrSwapchain.xrDesc.height;
+                desc.MipLevels = 1;
+                desc.SampleDesc.Count = 1;
+                desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+                CHECK_HRCMD(m_d3d11Device->CreateTexture2D(
+                    &desc, nullptr, xrSwapchain.compositionResolved.ReleaseAndGetAddressOf()));
+                setDebugName(xrSwapchain.compositionResolved.Get(),
+                             fmt::format("Composition Resolved[{}]", (void*)&xrSwapchain));
+
+                D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+                srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+                srvDesc.Format = format;
+                srvDesc.Texture2DArray.MipLevels = 1;
+                srvDesc.Texture2DArray.ArraySize = desc.ArraySize;
+                CHECK_HRCMD(m_d3d11Device->CreateShaderResourceView(
+                    xrSwapchain.compositionResolved.Get(),
+                    &srvDesc,
+                    xrSwapchain.compositionResolvedResourceView.ReleaseAndGetAddressOf()));
+                setDebugName(xrSwapchain.compositionResolvedResourceView.Get(),
+                             fmt::format("Composition Resolved SRV[{}]", (void*)&xrSwapchain));
+
+                m_gpuMemory.add(gpu_memory::Category::CompositionResolveImage,
+                                &xrSwapchain,
+                                gpu_memory::estimateTextureSize(desc.Width,
+                                                                desc.Height,
+                                                                desc.ArraySize,
+                                                                1,
+                                                                1,
+                                                                pvrGetBitsPerPixel(xrSwapchain.pvrDesc.Format)));
+                reportGpuMemory();
+            }
+
+            m_d3d11DeviceContext->ResolveSubresource(xrSwapchain.compositionResolved.Get(),
+                                                     D3D11CalcSubresource(0, slice, 1),
+                                                     texture,
+                                                     D3D11CalcSubresource(0, slice, 1),
+                                                     format);
+
+            TraceLoggingWrite(g_traceProvider,
+                              "Composition_Resolve",
+                              TLPArg(&xrSwapchain, "Swapchain"),
+                              TLArg(slice, "Slice"),
+                              TLArg(xrSwapchain.xrDesc.sampleCount, "SampleCount"));
+
+            return xrSwapchain.compositionResolvedResourceView.Get();
+        }
+
+        if (xrSwapchain.compositionResourceView.empty()) {
+            xrSwapchain.compositionResourceView.resize(xrSwapchain.slices[0].size());
+        }
+
+        auto& srv = xrSwapchain.compositionResourceView[index];
+        if (!srv) {
+            D3D11_SHADER_RESOURCE_VIEW_DESC desc{};
+            desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            desc.Format = format;
+            desc.Texture2DArray.MipLevels = 1;
+            desc.Texture2DArray.ArraySize = xrSwapchain.xrDesc.arraySize;
+            CHECK_HRCMD(m_d3d11Device->CreateShaderResourceView(texture, &desc, srv.ReleaseAndGetAddressOf()));
+            setDebugName(srv.Get(), fmt::format("Composition SRV[{}, {}]", index, (void*)&xrSwapchain));
+        }
+
+        return srv.Get();
+    }
+
+    // Release a runtime swapchain for a later creation. The GPU must be done with the swapchain.
+    void OpenXrRuntime::destroyRuntimeSwapchain(RuntimeSwapchain& swapchain) {
+        swapchain.renderTargetView.clear();
+        swapchain.depthStencilView.clear();
+        if (swapchain.pvrSwapchain) {
+            retirePvrSwapchain(swapchain.pvrDesc, swapchain.pvrSwapchain);
+            swapchain.pvrSwapchain = nullptr;
+
+            m_gpuMemory.releaseAll(&swapchain);
+            reportGpuMemory();
+        }
+    }
+
 } // namespace pimax_openxr
@@ -115,23 +115,7 @@ namespace pimax_openxr {
         m_d3d12CommandQueue = d3dBindings.queue;
 
         // Create the interop device that PVR will be using.
-        ComPtr<ID3D11Device> device;
-        ComPtr<ID3D11DeviceContext> deviceContext;
-        D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
-        UINT flags = 0;
-#ifdef _DEBUG
-        flags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-        CHECK_HRCMD(D3D11CreateDevice(dxgiAdapter.Get(),
-                                      D3D_DRIVER_TYPE_UNKNOWN,
-                                      0,
-                                      flags,
-                                      &featureLevel,
-                                      1,
-                                      D3D11_SDK_VERSION,
-                                      device.ReleaseAndGetAddressOf(),
-                                      nullptr,
-                                      deviceContext.ReleaseAndGetAddressOf()));
+        const ComPtr<ID3D11Device> device = createInteropD3D11Device(dxgiAdapter.Get());
 
         ComPtr<ID3D11Device5> device5;
         CHECK_HRCMD(device->QueryInterface(m_d3d11Device.ReleaseAndGetAddressOf()));
@@ -278,18 +262,24 @@ namespace pimax_openxr {
     // Wait for all pending commands to finish.
     void OpenXrRuntime::flushD3D12CommandQueue() {
         if (m_d3d12CommandQueue && m_d3d12Fence) {
-            wil::unique_handle eventHandle;
             m_fenceValue++;
             TraceLoggingWrite(
-                g_traceProvider, "xrDestroySwapchain_Wait", TLArg("D3D12", "Api"), TLArg(m_fenceValue, "FenceValue"));
+                g_traceProvider, "FlushCommandQueue_Wait", TLArg("D3D12", "Api"), TLArg(m_fenceValue, "FenceValue"));
             m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), m_fenceValue);
-            *eventHandle.put() = CreateEventEx(nullptr, L"Flush Fence", 0, EVENT_ALL_ACCESS);
-            CHECK_HRCMD(m_d3d12Fence->SetEventOnCompletion(m_fenceValue, eventHandle.get()));
-            WaitForSingleObject(eventHandle.get(), INFINITE);
-            ResetEvent(eventHandle.get());
+
+            // Without an event, the call blocks until the fence value is reached.
+            CHECK_HRCMD(m_d3d12Fence->SetEventOnCompletion(m_fenceValue, nullptr));
         }
     }
 
+    // Make the D3D11 context wait for the commands submitted so far on the D3D12 queue, without blocking the CPU.
+    void OpenXrRuntime::serializeD3D12Work() {
+        m_fenceValue++;
+        TraceLoggingWrite(g_traceProvider, "SerializeWork", TLArg("D3D12", "Api"), TLArg(m_fenceValue, "FenceValue"));
+        CHECK_HRCMD(m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), m_fenceValue));
+        CHECK_HRCMD(m_d3d11DeviceContext->Wait(m_d3d11Fence.Get(), m_fenceValue));
+    }
+
     // Serialize commands from the D3D12 queue to the D3D11 context used by PVR.
     void OpenXrRuntime::serializeD3D12Frame() {
         m_fenceValue++;
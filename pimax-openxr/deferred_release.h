@@ -0,0 +1,71 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Resources released by the application (eg: swapchains) are destroyed once the GPU has passed a fence value recorded
+// at the time of their release, instead of waiting for the GPU to be idle.
+
+namespace pimax_openxr::deferred_release {
+
+    template <typename T>
+    class Queue {
+      public:
+        // The fence values are expected to increase with each push.
+        void push(uint64_t fenceValue, T item) {
+            m_items.push_back({fenceValue, std::move(item)});
+        }
+
+        // Release the items whose fence value was reached, in the order they were pushed. An item is never released
+        // before an item pushed earlier.
+        template <typename Release>
+        size_t drain(uint64_t completedValue, Release&& release) {
+            size_t count = 0;
+            while (!m_items.empty() && m_items.front().fenceValue <= completedValue) {
+                T item = std::move(m_items.front().item);
+                m_items.pop_front();
+                release(item);
+                count++;
+            }
+            return count;
+        }
+
+        size_t size() const {
+            return m_items.size();
+        }
+
+        bool empty() const {
+            return m_items.empty();
+        }
+
+      private:
+        struct Entry {
+            uint64_t fenceValue;
+            T item;
+        };
+
+        std::deque<Entry> m_items;
+    };
+
+} // namespace pimax_openxr::deferred_release
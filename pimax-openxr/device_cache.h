@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The device-level resources (eg: shaders, fences, the interop device itself) are kept when a session is destroyed, so
+// that an application recreating its session on the same device (eg: when loading a level) does not pay for them again.
+
+namespace pimax_openxr::device_cache {
+
+    // Identifies the device that the resources were created on.
+    struct Key {
+        uint64_t adapterLuid{0};
+
+        // The identity (IUnknown) of the device. Keeping the resources holds a reference to the device, so the
+        // identity cannot be reused by another device while the resources are kept.
+        const void* device{nullptr};
+
+        // Whether the device is the runtime's own device for D3D12, Vulkan or OpenGL interop.
+        bool interop{false};
+    };
+
+    static inline uint64_t toKey(uint32_t lowPart, int32_t highPart) {
+        return ((uint64_t)(uint32_t)highPart << 32) | lowPart;
+    }
+
+    // The application's device can only be reused for the same device object. The runtime's interop device can serve
+    // any interop session on the same adapter, which is requested with no device.
+    static inline bool canReuse(const Key& kept, const Key& requested) {
+        if (kept.adapterLuid != requested.adapterLuid || kept.interop != requested.interop) {
+            return false;
+        }
+        if (kept.interop && !requested.device) {
+            return true;
+        }
+        return kept.device == requested.device;
+    }
+
+    // Whether to keep the resources when the session is destroyed. The application's own device is only kept upon
+    // request, since the reference keeps the device alive after the application released it.
+    static inline bool shouldKeep(const Key& key, bool warmRestart, bool warmRestartAppDevice) {
+        return warmRestart && (key.interop || warmRestartAppDevice);
+    }
+
+} // namespace pimax_openxr::device_cache
@@ -26,9 +26,98 @@
 #include "runtime.h"
 #include "utils.h"
 
-// Implements the mock support for the XR_FB_display_refresh_rate extension:
+// Implements the XR_FB_display_refresh_rate extension:
 // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_FB_display_refresh_rate
 
+namespace {
+
+    using namespace pimax_openxr;
+    using namespace pimax_openxr::log;
+
+    // The display as driven by pi_server. The supported modes depend on the headset model and connection.
+    class PvrDisplay : public refresh_rate::IDisplay {
+      public:
+        PvrDisplay(pvrSessionHandle pvrSession) : m_pvrSession(pvrSession) {
+        }
+
+        std::vector<float> getSupportedRates() override {
+            std::vector<float> rates;
+
+            // The list is formatted as "72,90,120".
+            char buf[256]{};
+            pvr_getStringConfig(m_pvrSession, "supported_refresh_rates", buf, sizeof(buf));
+            std::stringstream list(buf);
+            std::string entry;
+            while (std::getline(list, entry, ',')) {
+                try {
+                    const float rate = std::stof(entry);
+                    if (rate > 0.f) {
+                        rates.push_back(rate);
+                    }
+                } catch (std::exception&) {
+                }
+            }
+
+            // Older versions of pi_server do not report the list. We can only offer the current rate.
+            const float currentRate = getCurrentRate();
+            if (std::find_if(rates.cbegin(), rates.cend(), [&](float rate) {
+                    return refresh_rate::isSameRate(rate, currentRate);
+                }) == rates.cend()) {
+                rates.push_back(currentRate);
+            }
+
+            return rates;
+        }
+
+        float getCurrentRate() override {
+            pvrDisplayInfo info{};
+            CHECK_PVRCMD(pvr_getEyeDisplayInfo(m_pvrSession, pvrEye_Left, &info));
+            return info.refresh_rate;
+        }
+
+        bool requestRate(float rate) override {
+            return pvr_setFloatConfig(m_pvrSession, "refresh_rate", rate) == pvr_success;
+        }
+
+      private:
+        const pvrSessionHandle m_pvrSession;
+    };
+
+    // A display that takes some time to switch modes, so that the feature can be exercised without the hardware.
+    class SimulatedDisplay : public refresh_rate::IDisplay {
+      public:
+        SimulatedDisplay(pvrEnvHandle pvr) : m_pvr(pvr) {
+        }
+
+        std::vector<float> getSupportedRates() override {
+            return {72.f, 90.f, 120.f};
+        }
+
+        float getCurrentRate() override {
+            if (m_pendingRate && pvr_getTimeSeconds(m_pvr) >= m_switchTime) {
+                m_currentRate = m_pendingRate.value();
+                m_pendingRate.reset();
+            }
+            return m_currentRate;
+        }
+
+        bool requestRate(float rate) override {
+            m_pendingRate = rate;
+            m_switchTime = pvr_getTimeSeconds(m_pvr) + SwitchLatency;
+            return true;
+        }
+
+      private:
+        static constexpr double SwitchLatency = 1.5;
+
+        const pvrEnvHandle m_pvr;
+        float m_currentRate{90.f};
+        std::optional<float> m_pendingRate;
+        double m_switchTime{0.0};
+    };
+
+} // namespace
+
 namespace pimax_openxr {
 
     using namespace pimax_openxr::log;
@@ -51,20 +140,23 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (displayRefreshRateCapacityInput && displayRefreshRateCapacityInput < 1) {
+        if (displayRefreshRateCapacityInput &&
+            displayRefreshRateCapacityInput < m_supportedDisplayRefreshRates.size()) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
 
-        *displayRefreshRateCountOutput = 1;
+        *displayRefreshRateCountOutput = (uint32_t)m_supportedDisplayRefreshRates.size();
         TraceLoggingWrite(g_traceProvider,
                           "xrEnumerateDisplayRefreshRatesFB",
                           TLArg(*displayRefreshRateCountOutput, "DisplayRefreshRateCountOutput"));
 
         if (displayRefreshRateCapacityInput && displayRefreshRates) {
-            displayRefreshRates[0] = m_displayRefreshRate;
-            TraceLoggingWrite(g_traceProvider,
-                              "xrEnumerateDisplayRefreshRatesFB",
-                              TLArg(displayRefreshRates[0], "DisplayRefreshRate"));
+            for (uint32_t i = 0; i < *displayRefreshRateCountOutput; i++) {
+                displayRefreshRates[i] = m_supportedDisplayRefreshRates[i];
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrEnumerateDisplayRefreshRatesFB",
+                                  TLArg(displayRefreshRates[i], "DisplayRefreshRate"));
+            }
         }
 
         return XR_SUCCESS;
@@ -81,7 +173,11 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        *displayRefreshRate = m_displayRefreshRate;
+        {
+            std::unique_lock lock(m_frameLock);
+
+            *displayRefreshRate = m_displayRefreshRate;
+        }
 
         TraceLoggingWrite(
             g_traceProvider, "xrGetDisplayRefreshRateFB", TLArg(*displayRefreshRate, "DisplayRefreshRate"));
@@ -103,11 +199,123 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (std::abs(displayRefreshRate - m_displayRefreshRate) > FLT_EPSILON) {
+        // A value of 0 means that the application has no preference.
+        if (displayRefreshRate == 0.f) {
+            displayRefreshRate = m_defaultDisplayRefreshRate;
+        }
+
+        const auto it = std::find_if(
+            m_supportedDisplayRefreshRates.cbegin(), m_supportedDisplayRefreshRates.cend(), [&](float rate) {
+                return refresh_rate::isSameRate(rate, displayRefreshRate);
+            });
+        if (it == m_supportedDisplayRefreshRates.cend()) {
             return XR_ERROR_DISPLAY_REFRESH_RATE_UNSUPPORTED_FB;
         }
 
+        // Critical section.
+        {
+            std::unique_lock lock(m_frameLock);
+
+            // The switch completes asynchronously, see updateDisplayRefreshRate().
+            if (!m_refreshRateSwitcher.request(*m_display, *it, pvr_getTimeSeconds(m_pvr))) {
+                ErrorLog("Failed to request display refresh rate %.1f Hz\n", *it);
+                return XR_ERROR_DISPLAY_REFRESH_RATE_UNSUPPORTED_FB;
+            }
+
+            m_isDisplayRefreshRateRequested = !refresh_rate::isSameRate(*it, m_defaultDisplayRefreshRate);
+        }
+
+        LOG_TELEMETRY_ONCE(logFeature("DisplayRefreshRate"));
+
         return XR_SUCCESS;
     }
 
+    void OpenXrRuntime::initializeDisplayRefreshRate() {
+        // The simulated display lets us exercise the mode switches without the hardware.
+        if (getSetting("debug_refresh_rate").value_or(0)) {
+            m_display = std::make_unique<SimulatedDisplay>(m_pvr);
+        } else {
+            m_display = std::make_unique<PvrDisplay>(m_pvrSession);
+        }
+
+        m_supportedDisplayRefreshRates = m_display->getSupportedRates();
+        std::sort(m_supportedDisplayRefreshRates.begin(), m_supportedDisplayRefreshRates.end());
+        m_defaultDisplayRefreshRate = m_display->getCurrentRate();
+
+        std::string list;
+        for (const float rate : m_supportedDisplayRefreshRates) {
+            list += fmt::format("{}{:.1f}", list.empty() ? "" : ", ", rate);
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "PVR_DisplayRefreshRates",
+                          TLArg(list.c_str(), "SupportedRates"),
+                          TLArg(m_defaultDisplayRefreshRate, "CurrentRate"));
+        Log("Supported refresh rates: %s Hz\n", list.c_str());
+    }
+
+    // Give the user back the refresh rate that was configured before the application changed it. pi_server keeps the
+    // requested rate after the session ends otherwise.
+    void OpenXrRuntime::restoreDisplayRefreshRate() {
+        if (!m_isDisplayRefreshRateRequested) {
+            return;
+        }
+        m_isDisplayRefreshRateRequested = false;
+
+        Log("Restoring display refresh rate %.1f Hz\n", m_defaultDisplayRefreshRate);
+        TraceLoggingWrite(
+            g_traceProvider, "DisplayRefreshRate_Restore", TLArg(m_defaultDisplayRefreshRate, "DefaultRate"));
+
+        std::unique_lock lock(m_frameLock);
+
+        if (!m_refreshRateSwitcher.request(*m_display, m_defaultDisplayRefreshRate, pvr_getTimeSeconds(m_pvr))) {
+            ErrorLog("Failed to restore display refresh rate %.1f Hz\n", m_defaultDisplayRefreshRate);
+        }
+    }
+
+    // Track the switching of the display refresh rate. Must be called with m_frameLock held.
+    void OpenXrRuntime::updateDisplayRefreshRate() {
+        const double now = pvr_getTimeSeconds(m_pvr);
+
+        const std::optional<float> pendingRate = m_refreshRateSwitcher.getPendingRate();
+        const auto status = m_refreshRateSwitcher.update(*m_display, now);
+        if (status == refresh_rate::SwitchStatus::Pending) {
+            return;
+        }
+
+        if (status == refresh_rate::SwitchStatus::TimedOut) {
+            ErrorLog("Timed out switching to display refresh rate %.1f Hz\n", pendingRate.value());
+            TraceLoggingWrite(g_traceProvider, "DisplayRefreshRate_TimedOut", TLArg(pendingRate.value(), "Rate"));
+        }
+
+        // The rate may also be changed outside of the application, eg: from the Pimax Client. We do not need to poll
+        // for that as often.
+        if (status == refresh_rate::SwitchStatus::Idle && now - m_lastDisplayRefreshRatePollTime < 1.0) {
+            return;
+        }
+        m_lastDisplayRefreshRatePollTime = now;
+
+        const float newRate = m_display->getCurrentRate();
+        if (refresh_rate::isSameRate(newRate, m_displayRefreshRate) || newRate <= 0.f) {
+            return;
+        }
+
+        Log("Display refresh rate changed from %.1f Hz to %.1f Hz\n", m_displayRefreshRate, newRate);
+        TraceLoggingWrite(g_traceProvider,
+                          "DisplayRefreshRate_Changed",
+                          TLArg(m_displayRefreshRate, "FromRate"),
+                          TLArg(newRate, "ToRate"));
+
+        Event event{};
+        event.displayRefreshRateChanged = {XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB};
+        event.displayRefreshRateChanged.fromDisplayRefreshRate = m_displayRefreshRate;
+        event.displayRefreshRateChanged.toDisplayRefreshRate = newRate;
+        queueEvent(event);
+
+        // Frame timing values derived from the frame duration must be updated together.
+        const double newFrameDuration = 1.0 / newRate;
+        m_gpuFrameTimeOverrideUs = (uint64_t)(m_gpuFrameTimeOverrideUs * newFrameDuration / m_frameDuration);
+        m_displayRefreshRate = newRate;
+        m_frameDuration = newFrameDuration;
+    }
+
 } // namespace pimax_openxr
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// A governor for the render scale of the application, driven by the measured GPU frame time.
+
+namespace pimax_openxr::dynamic_resolution {
+
+    struct GovernorSettings {
+        // The fraction of the frame budget that the application's GPU work should use.
+        float targetUtilization{0.9f};
+
+        // The relative error above which the governor starts adjusting the scale, and below which it stops.
+        float engageThreshold{0.08f};
+        float releaseThreshold{0.02f};
+
+        // Gains of the PI controller. The controller operates on the logarithm of the render area, since the GPU time
+        // is expected to be roughly proportional to the number of pixels.
+        float proportionalGain{0.25f};
+        float integralGain{0.1f};
+
+        // Bounds of the render scale, applied to each dimension.
+        float minScale{0.5f};
+        float maxScale{1.f};
+    };
+
+    class Governor {
+      public:
+        Governor() = default;
+        explicit Governor(const GovernorSettings& settings) : m_settings(settings) {
+            reset();
+        }
+
+        void reset() {
+            m_logArea = 2.f * std::log(m_settings.maxScale);
+            m_lastError = 0.f;
+            m_isEngaged = false;
+        }
+
+        // Update the governor with the latest measurement, and return the new recommended render scale.
+        // appliedScale is the scale that the application actually rendered at for that measurement, or 0 if unknown.
+        float update(double gpuFrameTimeUs, double frameBudgetUs, float appliedScale = 0.f) {
+            // The GPU timers are not ready for the first few frames.
+            if (gpuFrameTimeUs <= 0.0 || frameBudgetUs <= 0.0) {
+                return getScale();
+            }
+
+            const float utilization = (float)(gpuFrameTimeUs / frameBudgetUs);
+            float error = std::log(m_settings.targetUtilization / utilization);
+
+            // Hysteresis: only start adjusting when far enough from the target, then keep adjusting until close to it.
+            // This avoids chasing the noise of the measurements.
+            if (!m_isEngaged && std::abs(error) > m_settings.engageThreshold) {
+                m_isEngaged = true;
+            } else if (m_isEngaged && std::abs(error) < m_settings.releaseThreshold) {
+                m_isEngaged = false;
+            }
+            if (!m_isEngaged) {
+                error = 0.f;
+            }
+
+            // Anti-windup: do not keep moving away from what the application is actually rendering at.
+            if (appliedScale > 0.f) {
+                const float appliedLogArea = 2.f * std::log(appliedScale);
+                if ((error > 0.f && m_logArea > appliedLogArea + m_settings.engageThreshold) ||
+                    (error < 0.f && m_logArea < appliedLogArea - m_settings.engageThreshold)) {
+                    error = 0.f;
+                }
+            }
+
+            // PI controller in velocity form. Clamping the output also clamps the integral term.
+            const float delta =
+                m_settings.proportionalGain * (error - m_lastError) + m_settings.integralGain * error;
+            m_lastError = error;
+            m_logArea = std::clamp(
+                m_logArea + delta, 2.f * std::log(m_settings.minScale), 2.f * std::log(m_settings.maxScale));
+
+            return getScale();
+        }
+
+        float getScale() const {
+            return std::exp(m_logArea / 2.f);
+        }
+
+        bool isEngaged() const {
+            return m_isEngaged;
+        }
+
+        const GovernorSettings& getSettings() const {
+            return m_settings;
+        }
+
+      private:
+        GovernorSettings m_settings;
+        float m_logArea{0.f};
+        float m_lastError{0.f};
+        bool m_isEngaged{false};
+    };
+
+} // namespace pimax_openxr::dynamic_resolution
@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// A bounded multi-producer queue, so that events can be posted from any thread without taking a lock, and be delivered
+// in order by xrPollEvent().
+
+namespace pimax_openxr::event_queue {
+
+    // Each cell carries a sequence number telling whether it is ready to be written (sequence == position) or read
+    // (sequence == position + 1) for a given position in the queue.
+    // The last ReservedCapacity cells can only be taken by priority items, so that a flood of other items cannot cause
+    // a priority item to be dropped.
+    template <typename T, size_t Capacity, size_t ReservedCapacity = 0>
+    class BoundedQueue {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+        static_assert(ReservedCapacity < Capacity, "Some capacity must be left for non-priority items");
+
+      public:
+        BoundedQueue() {
+            for (size_t i = 0; i < Capacity; i++) {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Returns false (and counts the item as lost) when the queue is full, or when only the reserved cells are left
+        // for a non-priority item.
+        bool push(const T& item, bool isPriority = false) {
+            size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = m_cells[position % Capacity];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+                // The cell is free, so the dequeue position cannot be past it. It only moves forward, so a stale value
+                // can only overestimate the occupancy.
+                if (!isPriority && difference == 0 &&
+                    position - m_dequeuePosition.load(std::memory_order_acquire) >= Capacity - ReservedCapacity) {
+                    m_lostCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                if (difference == 0) {
+                    if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.item = item;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    m_lostCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    position = m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool pop(T& item) {
+            size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = m_cells[position % Capacity];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+                if (difference == 0) {
+                    if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        item = cell.item;
+                        cell.sequence.store(position + Capacity, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = m_dequeuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void clear() {
+            T item;
+            while (pop(item)) {
+            }
+            m_lostCount = 0;
+        }
+
+        // The number of items dropped since the previous call.
+        uint32_t takeLostCount() {
+            return m_lostCount.exchange(0, std::memory_order_relaxed);
+        }
+
+      private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T item;
+        };
+
+        std::array<Cell, Capacity> m_cells;
+        alignas(64) std::atomic<size_t> m_enqueuePosition{0};
+        alignas(64) std::atomic<size_t> m_dequeuePosition{0};
+        std::atomic<uint32_t> m_lostCount{0};
+    };
+
+} // namespace pimax_openxr::event_queue
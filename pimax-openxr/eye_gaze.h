@@ -0,0 +1,67 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The gaze reported for XR_EXT_eye_gaze_interaction, from the PVR eye tracker or from the simulated one.
+
+namespace pimax_openxr::eye_gaze {
+
+    // Samples older than this are reported as valid but not tracked (eg: during a blink).
+    constexpr double TrackedMaxAge = 0.05;
+
+    // Samples older than this are not reported at all.
+    constexpr double ValidMaxAge = 0.5;
+
+    // The scripted gaze of the simulated eye tracker: a slow Lissajous sweep (15 degrees horizontally at 0.25 Hz, 10
+    // degrees vertically at 0.5 Hz) that is reproducible from the timestamp alone. The angles are in radians.
+    static inline void getSimulatedGaze(double time, float& angleHorizontal, float& angleVertical) {
+        constexpr double Pi = 3.14159265358979323846;
+        angleHorizontal = (float)(15.0 * Pi / 180.0 * std::sin(2.0 * Pi * 0.25 * time));
+        angleVertical = (float)(10.0 * Pi / 180.0 * std::sin(2.0 * Pi * 0.5 * time));
+    }
+
+    // Combine the gaze of both eyes, given as tangents, into a single (cyclopean) gaze. The angles are in radians.
+    template <typename Vector2>
+    static inline void
+    combineEyes(const Vector2& leftTan, const Vector2& rightTan, float& angleHorizontal, float& angleVertical) {
+        angleHorizontal = std::atan((leftTan.x + rightTan.x) / 2.f);
+        angleVertical = std::atan((leftTan.y + rightTan.y) / 2.f);
+    }
+
+    // The location flags for a gaze sample, using the age of the sample as the confidence level. Returns 0 when the
+    // sample must not be reported.
+    static inline XrSpaceLocationFlags getLocationFlags(float angleHorizontal, float angleVertical, double age) {
+        if (!std::isfinite(angleHorizontal) || !std::isfinite(angleVertical) || age > ValidMaxAge) {
+            return 0;
+        }
+
+        XrSpaceLocationFlags locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+        if (age <= TrackedMaxAge) {
+            locationFlags |= XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+        }
+        return locationFlags;
+    }
+
+} // namespace pimax_openxr::eye_gaze
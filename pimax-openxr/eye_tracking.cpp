@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the necessary support for the XR_EXT_eye_gaze_interaction extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_EXT_eye_gaze_interaction
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+    using namespace xr::math;
+
+    // Update all actions with the appropriate bindings for the eye tracker.
+    void OpenXrRuntime::rebindEyeGazeActions() {
+        // Remove all old bindings for the eye tracker.
+        for (const auto& action : m_actions) {
+            Action& xrAction = *(Action*)action;
+
+            for (auto it = xrAction.actionSources.begin(); it != xrAction.actionSources.end();) {
+                if (isEyeGazePath(it->first)) {
+                    it = xrAction.actionSources.erase(it);
+                } else {
+                    it++;
+                }
+            }
+        }
+        m_actionSpaceBindingsVersion++;
+
+        m_eyeGazeInteractionProfile = XR_NULL_PATH;
+        if (!has_XR_EXT_eye_gaze_interaction || !m_isEyeTrackingAvailable) {
+            return;
+        }
+
+        const auto bindings = m_suggestedBindings.find("/interaction_profiles/ext/eye_gaze_interaction");
+        if (bindings == m_suggestedBindings.cend()) {
+            return;
+        }
+
+        for (const auto& binding : bindings->second) {
+            if (!m_actions.count(binding.action)) {
+                continue;
+            }
+
+            Action& xrAction = *(Action*)binding.action;
+
+            const auto& sourcePath = getXrPath(binding.binding);
+            if (xrAction.type != XR_ACTION_TYPE_POSE_INPUT || !isEyeGazePath(sourcePath) ||
+                !endsWith(sourcePath, "/input/gaze_ext/pose")) {
+                continue;
+            }
+
+            // There is no PVR input state to map to, the pose is queried on-demand.
+            ActionSource newSource{};
+            newSource.realPath = sourcePath;
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrSyncActions_MapActionSource",
+                              TLXArg(binding.action, "Action"),
+                              TLXArg(xrAction.actionSet, "ActionSet"),
+                              TLArg(sourcePath.c_str(), "ActionPath"),
+                              TLArg(newSource.realPath.c_str(), "SourcePath"));
+            xrAction.actionSources.insert_or_assign(sourcePath, newSource);
+        }
+
+        CHECK_XRCMD(xrStringToPath(
+            XR_NULL_HANDLE, "/interaction_profiles/ext/eye_gaze_interaction", &m_eyeGazeInteractionProfile));
+
+        queueInteractionProfileChanged();
+    }
+
+    bool OpenXrRuntime::isEyeGazePath(const std::string& fullPath) const {
+        return startsWith(fullPath, "/user/eyes_ext");
+    }
+
+    // Retrieve the gaze orientation relative to the headset. PVR only gives us the latest gaze sample: eye motion is
+    // not predictable (saccades), so we hold the latest sample and let the caller compose it with the head pose
+    // predicted at the requested time.
+    XrSpaceLocationFlags
+    OpenXrRuntime::getEyeGaze(XrTime time, XrQuaternionf& orientation, XrTime& sampleTime) const {
+        const double now = pvr_getTimeSeconds(m_pvr);
+
+        float angleHorizontal = 0.f;
+        float angleVertical = 0.f;
+        double sampleTimeInSeconds = 0.0;
+        double age = 0.0;
+        if (m_useSimulatedEyeTracker) {
+            // The angle is exact for the requested time, so that is the time of the sample, and it never ages.
+            sampleTimeInSeconds = xrTimeToPvrTime(time);
+            eye_gaze::getSimulatedGaze(sampleTimeInSeconds, angleHorizontal, angleVertical);
+        } else {
+            // The eye tracker may stop (eg: the headset is removed) while the application queries the gaze every frame.
+            // This is not an error, the gaze is only reported as not located.
+            pvrEyeTrackingInfo state{};
+            const pvrResult result = pvr_getEyeTrackingInfo(m_pvrSession, xrTimeToPvrTime(time), &state);
+            TraceLoggingWrite(
+                g_traceProvider,
+                "PVR_EyeTrackerInfo",
+                TLArg((int)result, "Result"),
+                TLArg(state.TimeInSeconds, "TimeInSeconds"),
+                TLArg(fmt::format("{}, {}", state.GazeTan[0].x, state.GazeTan[0].y).c_str(), "LeftGazeTan"),
+                TLArg(fmt::format("{}, {}", state.GazeTan[1].x, state.GazeTan[1].y).c_str(), "RightGazeTan"));
+
+            if (result != pvr_success || state.TimeInSeconds <= 0) {
+                return 0;
+            }
+
+            eye_gaze::combineEyes(state.GazeTan[0], state.GazeTan[1], angleHorizontal, angleVertical);
+            sampleTimeInSeconds = state.TimeInSeconds;
+            age = now - sampleTimeInSeconds;
+        }
+
+        const XrSpaceLocationFlags locationFlags = eye_gaze::getLocationFlags(angleHorizontal, angleVertical, age);
+        if (!locationFlags) {
+            return 0;
+        }
+
+        orientation = Quaternion::RotationRollPitchYaw({angleVertical, -angleHorizontal, 0});
+        sampleTime = pvrTimeToXrTime(sampleTimeInSeconds);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "EyeGaze",
+                          TLArg(m_useSimulatedEyeTracker, "Simulated"),
+                          TLArg(age, "SampleAge"),
+                          TLArg(DirectX::XMConvertToDegrees(angleHorizontal), "HorizontalAngle"),
+                          TLArg(DirectX::XMConvertToDegrees(angleVertical), "VerticalAngle"),
+                          TLArg(locationFlags, "LocationFlags"));
+
+        return locationFlags;
+    }
+
+} // namespace pimax_openxr
@@ -60,58 +60,49 @@ namespace pimax_openxr {
                           TLArg(!!status.DisplayLost, "DisplayLost"),
                           TLArg(!!status.ShouldQuit, "ShouldQuit"));
         if (!(status.ServiceReady && status.HmdPresent) || status.DisplayLost || status.ShouldQuit) {
-            m_sessionState = XR_SESSION_STATE_LOSS_PENDING;
-            m_sessionStateDirty = true;
-            m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
+            setSessionState(XR_SESSION_STATE_LOSS_PENDING);
 
             return XR_SESSION_LOSS_PENDING;
         }
 
-        // Important: for state transitions, we must wait for the application to poll the session state to make sure
-        // that it sees every single state.
-
-        bool wasSessionStateDirty = m_sessionStateDirty;
-        if (!wasSessionStateDirty && status.IsVisible && !m_sessionExiting) {
+        // Every transition is queued as an event, so we can go through several states at once without the application
+        // missing any of them.
+        if (status.IsVisible && !m_sessionExiting) {
             if (m_sessionState == XR_SESSION_STATE_SYNCHRONIZED) {
-                m_sessionState = XR_SESSION_STATE_VISIBLE;
-                m_sessionStateDirty = true;
+                setSessionState(XR_SESSION_STATE_VISIBLE);
             }
 
-            if (!m_sessionStateDirty) {
-                if (status.HmdMounted) {
-                    if (m_sessionState == XR_SESSION_STATE_VISIBLE) {
-                        m_sessionState = XR_SESSION_STATE_FOCUSED;
-                        m_sessionStateDirty = true;
-                    }
-                } else {
-                    if (m_sessionState == XR_SESSION_STATE_FOCUSED) {
-                        m_sessionState = XR_SESSION_STATE_VISIBLE;
-                        m_sessionStateDirty = true;
-                    }
+            if (status.HmdMounted) {
+                if (m_sessionState == XR_SESSION_STATE_VISIBLE) {
+                    setSessionState(XR_SESSION_STATE_FOCUSED);
+                }
+            } else {
+                if (m_sessionState == XR_SESSION_STATE_FOCUSED) {
+                    setSessionState(XR_SESSION_STATE_VISIBLE);
                 }
             }
 
             frameState->shouldRender = XR_TRUE;
         } else {
-            if (m_sessionState != XR_SESSION_STATE_SYNCHRONIZED && m_sessionState != XR_SESSION_STATE_STOPPING &&
-                !m_sessionExiting) {
-                m_sessionState = XR_SESSION_STATE_SYNCHRONIZED;
-                m_sessionStateDirty = true;
+            if (!m_sessionExiting) {
+                if (m_sessionState == XR_SESSION_STATE_FOCUSED) {
+                    setSessionState(XR_SESSION_STATE_VISIBLE);
+                }
+                if (m_sessionState == XR_SESSION_STATE_VISIBLE) {
+                    setSessionState(XR_SESSION_STATE_SYNCHRONIZED);
+                }
             }
 
             frameState->shouldRender = XR_FALSE;
         }
 
-        if (!wasSessionStateDirty && m_sessionStateDirty) {
-            m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
-        }
-
         // Critical section.
         {
             CpuTimer waitTimer;
             if (IsTraceEnabled()) {
                 waitTimer.start();
             }
+            const double waitStartTime = pvr_getTimeSeconds(m_pvr);
 
             std::unique_lock lock(m_frameLock);
 
@@ -128,24 +119,32 @@ namespace pimax_openxr {
                 }
             }
 
+            // Apply any change of refresh rate or frame rate division before computing the frame timing.
+            updateDisplayRefreshRate();
+            updateFramePacing();
+
             // Calculate the time to the next frame.
             auto timeout = 100ms;
             double amount = 0.0;
             if (m_lastFrameWaitedTime) {
                 const double now = pvr_getTimeSeconds(m_pvr);
-                const double nextFrameTime = m_lastFrameWaitedTime.value() + m_frameDuration;
+                const double nextFrameTime =
+                    m_framePacer.getNextWakeTime(m_lastFrameWaitedTime.value(), m_frameDuration);
 
                 // Give 1ms grace period to compensate for timer precision.
                 amount = std::max(0.0, nextFrameTime - now - 0.001f);
                 timeout = std::chrono::milliseconds((uint64_t)(amount * 1e3));
             }
 
-            // Wait for xrEndFrame() completion or for the next frame time.
+            // Wait for xrEndFrame() completion or for the next frame time. When the compositor divides the frame rate,
+            // completing the frame early must not let the application start another frame that would be discarded.
             {
                 TraceLocalActivity(waitFrame2);
                 TraceLoggingWriteStart(waitFrame2, "WaitFrame2", TLArg(amount, "Amount"));
-                const bool timedOut =
-                    !m_frameCondVar.wait_for(lock, timeout, [&] { return !m_useFrameTimingOverride && !m_frameBegun; });
+                const bool timedOut = !m_frameCondVar.wait_for(lock, timeout, [&] {
+                    return !m_useFrameTimingOverride && m_framePacer.getDivisor() == 1 && !m_frameBegun &&
+                           !m_submitter.isPending();
+                });
                 TraceLoggingWriteStop(waitFrame2, "WaitFrame2", TLArg(timedOut, "TimedOut"));
             }
 
@@ -154,7 +153,8 @@ namespace pimax_openxr {
             }
 
             const double now = pvr_getTimeSeconds(m_pvr);
-            double predictedDisplayTime = pvr_getPredictedDisplayTime(m_pvrSession, 0);
+            const double predictedDisplayTime =
+                m_framePacer.predictDisplayTime(pvr_getPredictedDisplayTime(m_pvrSession, 0), m_frameDuration);
             TraceLoggingWrite(g_traceProvider,
                               "WaitFrame",
                               TLArg(now, "Now"),
@@ -165,8 +165,16 @@ namespace pimax_openxr {
             // Setup the app frame for use and the next frame for this call.
             frameState->predictedDisplayTime = pvrTimeToXrTime(predictedDisplayTime);
 
-            // We always use the native frame duration, regardless of Smart Smoothing.
-            frameState->predictedDisplayPeriod = pvrTimeToXrTime(m_frameDuration);
+            // With Smart Smoothing, the period is a multiple of the native frame duration.
+            frameState->predictedDisplayPeriod = pvrTimeToXrTime(m_framePacer.getFramePeriod(m_frameDuration));
+
+            // Start the latency record for the frame.
+            frame_latency::FrameRecord latencyRecord;
+            latencyRecord.waitStart = waitStartTime;
+            latencyRecord.waitEnd = now;
+            latencyRecord.predictedDisplayTime = predictedDisplayTime;
+            latencyRecord.framePeriod = m_framePacer.getFramePeriod(m_frameDuration);
+            m_frameLatencyWaited = latencyRecord;
 
             m_frameWaited = true;
         }
@@ -215,6 +223,10 @@ namespace pimax_openxr {
                 frameDiscarded = true;
             }
 
+            // PVR expects the previous frame to be submitted before the next one begins.
+            waitForSubmission(lock);
+            checkSubmissionError();
+
             // TODO: Not sure why we need this workaround. The very first call to pvr_beginFrame() crashes inside
             // PVR unless there is a call to pvr_endFrame() first... Also unclear why the call occasionally fails
             // with error code -1 (undocumented).
@@ -236,8 +248,14 @@ namespace pimax_openxr {
             m_frameWaited = false;
             m_frameBegun = true;
 
+            // The latency record of a discarded frame is dropped.
+            m_frameLatencyBegun = std::exchange(m_frameLatencyWaited, std::nullopt);
+            if (m_frameLatencyBegun) {
+                m_frameLatencyBegun->begin = pvr_getTimeSeconds(m_pvr);
+            }
+
             // Statistics for the previous frame.
-            if (m_useFrameTimingOverride || IsTraceEnabled()) {
+            if (isAppFrameTimingNeeded()) {
                 // Our principle is to always query() a timer before we start() it. This means that we get measurements
                 // with k_numGpuTimers-1 frames latency.
                 m_currentTimerIndex = (m_currentTimerIndex + 1) % k_numGpuTimers;
@@ -253,6 +271,32 @@ namespace pimax_openxr {
 
                 m_lastGpuFrameTimeUs = gpuFrameTimeUs;
 
+                if (has_XR_EXT_performance_settings) {
+                    updatePerfSettingsNotifications(cpuFrameTimeUs, gpuFrameTimeUs);
+                }
+
+                if (m_useSmoothingGovernor) {
+                    updateSmoothingGovernor(cpuFrameTimeUs, gpuFrameTimeUs);
+                }
+
+                if (m_isPerformanceMetricsEnabled) {
+                    m_performanceMetrics.appCpuFrameTimeMs.store(cpuFrameTimeUs / 1e3f, std::memory_order_relaxed);
+                    m_performanceMetrics.appGpuFrameTimeMs.store(gpuFrameTimeUs / 1e3f, std::memory_order_relaxed);
+                }
+
+                if (m_useDynamicResolution) {
+                    m_dynamicResolutionScale = m_dynamicResolutionGovernor.update(
+                        (double)gpuFrameTimeUs, m_frameDuration * 1e6, m_lastAppliedRenderScale);
+
+                    TraceLoggingWrite(g_traceProvider,
+                                      "DynamicResolution_Update",
+                                      TLArg(gpuFrameTimeUs, "GpuFrameTimeUs"),
+                                      TLArg(m_frameDuration * 1e6, "FrameBudgetUs"),
+                                      TLArg(m_lastAppliedRenderScale, "AppliedScale"),
+                                      TLArg(m_dynamicResolutionScale.load(), "RecommendedScale"),
+                                      TLArg(m_dynamicResolutionGovernor.isEngaged(), "Engaged"));
+                }
+
                 // Start app timers.
                 m_cpuTimerApp.start();
                 m_gpuTimerApp[m_currentTimerIndex]->start();
@@ -298,6 +342,8 @@ namespace pimax_openxr {
             return XR_ERROR_LAYER_LIMIT_EXCEEDED;
         }
 
+        const double endSubmitTime = pvr_getTimeSeconds(m_pvr);
+
         // Critical section.
         {
             std::unique_lock lock1(m_swapchainsLock);
@@ -316,17 +362,26 @@ namespace pimax_openxr {
                 serializeOpenGLFrame();
             }
 
-            if (m_useFrameTimingOverride || IsTraceEnabled()) {
+            // Destroy the swapchains released by the application that the GPU is done with. The previous submission
+            // (which may reference them) completed before xrBeginFrame().
+            if (!m_submitter.isPending()) {
+                signalRetiredSwapchains();
+                releaseRetiredSwapchains();
+            }
+
+            if (isAppFrameTimingNeeded()) {
                 m_cpuTimerApp.stop();
                 m_gpuTimerApp[m_currentTimerIndex]->stop();
             }
 
+            const bool measurePrecomposition = m_isPerformanceMetricsEnabled || IsTraceEnabled();
             const auto lastPrecompositionTime = m_gpuTimerPrecomposition[m_currentTimerIndex]->query();
-            if (IsTraceEnabled()) {
+            if (measurePrecomposition) {
                 m_gpuTimerPrecomposition[m_currentTimerIndex]->start();
             }
 
             std::set<std::pair<pvrTextureSwapChain, uint32_t>> committedSwapchainImages;
+            bool isRenderScaleMeasured = false;
 
             // Construct the list of layers.
             std::vector<pvrLayer_Union> layersAllocator(frameEndInfo->layerCount);
@@ -369,6 +424,13 @@ namespace pimax_openxr {
                     // Start without depth. We might change the type to pvrLayerType_EyeFovDepth further below.
                     layer.Header.Type = pvrLayerType_EyeFov;
 
+                    const uint32_t viewCount = getViewCount(m_primaryViewConfigurationType);
+                    if (proj->viewCount != viewCount) {
+                        return XR_ERROR_VALIDATION_FAILURE;
+                    }
+
+                    bool isDepthDropped = false;
+
                     for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
                         TraceLoggingWrite(g_traceProvider,
                                           "xrEndFrame_View",
@@ -386,19 +448,73 @@ namespace pimax_openxr {
 
                         Swapchain& xrSwapchain = *(Swapchain*)proj->views[eye].subImage.swapchain;
 
-                        // Fill out color buffer information.
-                        prepareAndCommitSwapchainImage(
-                            xrSwapchain, proj->views[eye].subImage.imageArrayIndex, committedSwapchainImages);
-                        layer.EyeFov.ColorTexture[eye] =
-                            xrSwapchain.pvrSwapchain[proj->views[eye].subImage.imageArrayIndex];
-
                         if (!isValidSwapchainRect(xrSwapchain.pvrDesc, proj->views[eye].subImage.imageRect)) {
                             return XR_ERROR_SWAPCHAIN_RECT_INVALID;
                         }
-                        layer.EyeFov.Viewport[eye].x = proj->views[eye].subImage.imageRect.offset.x;
-                        layer.EyeFov.Viewport[eye].y = proj->views[eye].subImage.imageRect.offset.y;
-                        layer.EyeFov.Viewport[eye].width = proj->views[eye].subImage.imageRect.extent.width;
-                        layer.EyeFov.Viewport[eye].height = proj->views[eye].subImage.imageRect.extent.height;
+
+                        // With quad views, merge the focus view into the peripheral view, and submit the result in
+                        // place of the peripheral view.
+                        const RuntimeSwapchain* composedSwapchain = nullptr;
+                        if (viewCount > xr::StereoView::Count) {
+                            const XrCompositionLayerProjectionView& focusView =
+                                proj->views[eye + xr::StereoView::Count];
+
+                            TraceLoggingWrite(g_traceProvider,
+                                              "xrEndFrame_View",
+                                              TLArg("Focus", "Type"),
+                                              TLArg(eye, "Index"),
+                                              TLXArg(focusView.subImage.swapchain, "Swapchain"),
+                                              TLArg(focusView.subImage.imageArrayIndex, "ImageArrayIndex"),
+                                              TLArg(xr::ToString(focusView.subImage.imageRect).c_str(), "ImageRect"),
+                                              TLArg(xr::ToString(focusView.pose).c_str(), "Pose"),
+                                              TLArg(xr::ToString(focusView.fov).c_str(), "Fov"));
+
+                            if (!m_swapchains.count(focusView.subImage.swapchain)) {
+                                return XR_ERROR_HANDLE_INVALID;
+                            }
+
+                            Swapchain& xrFocusSwapchain = *(Swapchain*)focusView.subImage.swapchain;
+
+                            if (!isValidSwapchainRect(xrFocusSwapchain.pvrDesc, focusView.subImage.imageRect)) {
+                                return XR_ERROR_SWAPCHAIN_RECT_INVALID;
+                            }
+                            if (focusView.subImage.imageArrayIndex >= xrFocusSwapchain.xrDesc.arraySize) {
+                                return XR_ERROR_VALIDATION_FAILURE;
+                            }
+
+                            composedSwapchain =
+                                composeQuadViews(eye, proj->views[eye], focusView, committedSwapchainImages);
+                            if (!composedSwapchain) {
+                                // Only the peripheral view will be visible, but we must still release the focus view.
+                                prepareAndCommitSwapchainImage(
+                                    xrFocusSwapchain, focusView.subImage.imageArrayIndex, committedSwapchainImages);
+                            }
+                        }
+
+                        // Optionally upscale the view to the native resolution.
+                        bool isUpscaled = false;
+                        if (!composedSwapchain && m_useUpscaling && viewCount == xr::StereoView::Count) {
+                            composedSwapchain = upscaleView(eye, proj->views[eye], committedSwapchainImages);
+                            isUpscaled = composedSwapchain != nullptr;
+                        }
+
+                        // Fill out color buffer information.
+                        if (composedSwapchain) {
+                            layer.EyeFov.ColorTexture[eye] = composedSwapchain->pvrSwapchain;
+                            layer.EyeFov.Viewport[eye].x = composedSwapchain->imageRect.offset.x;
+                            layer.EyeFov.Viewport[eye].y = composedSwapchain->imageRect.offset.y;
+                            layer.EyeFov.Viewport[eye].width = composedSwapchain->imageRect.extent.width;
+                            layer.EyeFov.Viewport[eye].height = composedSwapchain->imageRect.extent.height;
+                        } else {
+                            prepareAndCommitSwapchainImage(
+                                xrSwapchain, proj->views[eye].subImage.imageArrayIndex, committedSwapchainImages);
+                            layer.EyeFov.ColorTexture[eye] =
+                                xrSwapchain.pvrSwapchain[proj->views[eye].subImage.imageArrayIndex];
+                            layer.EyeFov.Viewport[eye].x = proj->views[eye].subImage.imageRect.offset.x;
+                            layer.EyeFov.Viewport[eye].y = proj->views[eye].subImage.imageRect.offset.y;
+                            layer.EyeFov.Viewport[eye].width = proj->views[eye].subImage.imageRect.extent.width;
+                            layer.EyeFov.Viewport[eye].height = proj->views[eye].subImage.imageRect.extent.height;
+                        }
 
                         // Fill out pose and FOV information.
                         XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
@@ -456,6 +572,17 @@ namespace pimax_openxr {
                                         return XR_ERROR_SWAPCHAIN_RECT_INVALID;
                                     }
 
+                                    // The depth buffer must map 1:1 to the color buffer, so it follows the upscaling.
+                                    if (isUpscaled) {
+                                        const RuntimeSwapchain* upscaledDepth =
+                                            upscaleDepth(eye, *depth, *composedSwapchain);
+                                        if (upscaledDepth) {
+                                            layer.EyeFovDepth.DepthTexture[eye] = upscaledDepth->pvrSwapchain;
+                                        } else {
+                                            isDepthDropped = true;
+                                        }
+                                    }
+
                                     // Fill out projection information.
                                     layer.EyeFovDepth.DepthProjectionDesc.Projection22 =
                                         depth->farZ / (depth->nearZ - depth->farZ);
@@ -469,6 +596,29 @@ namespace pimax_openxr {
                             }
                         }
                     }
+
+                    // PVR takes depth for both eyes or none, so depth that could not follow the upscaled color buffer
+                    // is dropped for the whole layer.
+                    if (isDepthDropped && layer.Header.Type == pvrLayerType_EyeFovDepth) {
+                        layer.Header.Type = pvrLayerType_EyeFov;
+                    }
+
+                    // The governor needs to know the scale that the application actually rendered at, which is
+                    // conveyed by the submitted image rects of the first projection layer (the main scene). The
+                    // governor works on the rendered area, so the scale is the square root of the area ratio.
+                    if (m_useDynamicResolution && !isRenderScaleMeasured) {
+                        double appliedArea = 0;
+                        double recommendedArea = 0;
+                        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+                            const XrExtent2Di& extent = proj->views[eye].subImage.imageRect.extent;
+                            appliedArea += (double)extent.width * extent.height;
+                            recommendedArea += (double)m_recommendedViewSize[eye].w * m_recommendedViewSize[eye].h;
+                        }
+                        if (recommendedArea > 0) {
+                            m_lastAppliedRenderScale = (float)std::sqrt(appliedArea / recommendedArea);
+                        }
+                        isRenderScaleMeasured = true;
+                    }
                 } else if (frameEndInfo->layers[i]->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
                     const XrCompositionLayerQuad* quad =
                         reinterpret_cast<const XrCompositionLayerQuad*>(frameEndInfo->layers[i]);
@@ -539,7 +689,7 @@ namespace pimax_openxr {
                 layers.push_back(&layer.Header);
             }
 
-            if (IsTraceEnabled()) {
+            if (measurePrecomposition) {
                 m_gpuTimerPrecomposition[m_currentTimerIndex]->stop();
             }
 
@@ -550,26 +700,34 @@ namespace pimax_openxr {
                 m_frameTimes.pop_front();
             }
 
+            if (m_isPerformanceMetricsEnabled) {
+                updatePerformanceMetrics(now, lastPrecompositionTime);
+            }
+
             // Submit the layers to PVR.
             if (!layers.empty()) {
                 if (m_useFrameTimingOverride) {
                     float renderMs = 0.f;
                     if (!m_gpuFrameTimeOverrideUs) {
-                        const auto latestGpuFrameTimeUs =
-                            std::max(0ll, (int64_t)m_lastGpuFrameTimeUs + m_gpuFrameTimeOverrideOffsetUs);
-
-                        // Simple median filter to smooth out the values.
-                        m_gpuFrameTimeFilter.push_back(latestGpuFrameTimeUs);
-                        while (m_gpuFrameTimeFilter.size() > m_gpuFrameTimeFilterLength) {
-                            m_gpuFrameTimeFilter.pop_front();
-                        }
-                        auto sortedFrameTimes = m_gpuFrameTimeFilter;
-                        std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+                        // Predict the GPU time of the next frame from the recent ones.
+                        m_gpuFrameTimeEstimator.setWindowLength(m_gpuFrameTimeFilterLength);
+                        const double predictedGpuFrameTimeUs =
+                            m_gpuFrameTimeEstimator.update((double)m_lastGpuFrameTimeUs);
+                        renderMs =
+                            (float)std::max(0.0, predictedGpuFrameTimeUs + m_gpuFrameTimeOverrideOffsetUs) / 1e3f;
 
-                        const auto filteredGpuFrameTimeUs = sortedFrameTimes[sortedFrameTimes.size() / 2];
-                        renderMs = filteredGpuFrameTimeUs / 1e3f;
+                        TraceLoggingWrite(g_traceProvider,
+                                          "GpuFrameTime_Estimate",
+                                          TLArg(m_lastGpuFrameTimeUs, "LastGpuFrameTimeUs"),
+                                          TLArg(m_gpuFrameTimeEstimator.getMedian(), "MedianUs"),
+                                          TLArg(m_gpuFrameTimeEstimator.getTrend(), "TrendUs"),
+                                          TLArg(predictedGpuFrameTimeUs, "PredictedUs"));
+
+                        // Let the application influence the Smart Smoothing policy.
+                        renderMs = (float)perf_settings::adjustClientRenderTime(
+                            renderMs, m_frameDuration * 1e3, m_perfSettingsGpuLevel);
                     } else {
-                        m_gpuFrameTimeFilter.clear();
+                        m_gpuFrameTimeEstimator.reset();
 
                         renderMs =
                             std::max(0ll, (int64_t)m_gpuFrameTimeOverrideUs + m_gpuFrameTimeOverrideOffsetUs) / 1e3f;
@@ -583,28 +741,45 @@ namespace pimax_openxr {
                     pvr_setFloatConfig(m_pvrSession, "openvr_client_render_ms", renderMs);
                 }
 
-                // TODO: This timer does not seem to work. Perhaps because PVR is doing composition out-of-proc?
-                const auto lastCompositionTime = m_gpuTimerPvrComposition[m_currentTimerIndex]->query();
-                if (IsTraceEnabled()) {
-                    m_gpuTimerPvrComposition[m_currentTimerIndex]->start();
-                }
+                if (m_submitter.isRunning()) {
+                    TraceLoggingWrite(g_traceProvider,
+                                      "QueueSubmission",
+                                      TLArg(layers.size(), "NumLayers"),
+                                      TLArg(m_frameTimes.size(), "MeasuredFps"),
+                                      TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"));
+
+                    // The latency record is completed by the submission thread.
+                    if (m_frameLatencyBegun) {
+                        m_frameLatencyBegun->endSubmit = endSubmitTime;
+                        m_submitter.getSlot().latencyRecord = m_frameLatencyBegun;
+                        m_frameLatencyBegun.reset();
+                    }
 
-                TraceLocalActivity(endFrame);
-                TraceLoggingWriteStart(endFrame,
-                                       "PVR_EndFrame",
-                                       TLArg(layers.size(), "NumLayers"),
-                                       TLArg(m_frameTimes.size(), "MeasuredFps"),
-                                       TLArg(pvr_getFloatConfig(m_pvrSession, "client_fps", 0), "ClientFps"),
-                                       TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"),
-                                       TLArg(lastCompositionTime, "LastCompositionTimeUs"));
-                CHECK_PVRCMD(pvr_endFrame(m_pvrSession, 0, layers.data(), (unsigned int)layers.size()));
-                TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
-
-                if (IsTraceEnabled()) {
-                    m_gpuTimerPvrComposition[m_currentTimerIndex]->stop();
-                }
+                    queueSubmission(lock2, layers);
+                } else {
+                    // TODO: This timer does not seem to work. Perhaps because PVR is doing composition out-of-proc?
+                    const auto lastCompositionTime = m_gpuTimerPvrComposition[m_currentTimerIndex]->query();
+                    if (IsTraceEnabled()) {
+                        m_gpuTimerPvrComposition[m_currentTimerIndex]->start();
+                    }
 
-                m_canBeginFrame = true;
+                    TraceLocalActivity(endFrame);
+                    TraceLoggingWriteStart(endFrame,
+                                           "PVR_EndFrame",
+                                           TLArg(layers.size(), "NumLayers"),
+                                           TLArg(m_frameTimes.size(), "MeasuredFps"),
+                                           TLArg(pvr_getFloatConfig(m_pvrSession, "client_fps", 0), "ClientFps"),
+                                           TLArg(lastPrecompositionTime, "LastPrecompositionTimeUs"),
+                                           TLArg(lastCompositionTime, "LastCompositionTimeUs"));
+                    CHECK_PVRCMD(pvr_endFrame(m_pvrSession, 0, layers.data(), (unsigned int)layers.size()));
+                    TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
+
+                    if (IsTraceEnabled()) {
+                        m_gpuTimerPvrComposition[m_currentTimerIndex]->stop();
+                    }
+
+                    m_canBeginFrame = true;
+                }
             }
 
             // When using RenderDoc, signal a frame through the dummy swapchain.
@@ -616,6 +791,23 @@ namespace pimax_openxr {
             m_frameBegun = false;
 
             m_sessionTotalFrameCount++;
+            evictResolveScratch();
+
+            // The first frame completes the startup timeline.
+            if (m_sessionTotalFrameCount == 1 && startupTimeline.record("first_frame", m_sessionCreatedTime)) {
+                const auto timeline = startupTimeline.format();
+                Log("Startup: %s\n", timeline.c_str());
+                TraceLoggingWrite(g_traceProvider, "StartupTimeline", TLArg(timeline.c_str(), "Timeline"));
+            }
+            releaseUnusedSliceSwapchains();
+
+            // Complete the latency record for the frame.
+            if (m_frameLatencyBegun) {
+                m_frameLatencyBegun->endSubmit = endSubmitTime;
+                m_frameLatencyBegun->compositorReturn = pvr_getTimeSeconds(m_pvr);
+                recordFrameLatency(m_frameLatencyBegun.value());
+                m_frameLatencyBegun.reset();
+            }
 
             // Signal xrWaitFrame().
             TraceLoggingWrite(g_traceProvider, "EndFrame_Signal");
@@ -625,4 +817,173 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // Whether any feature needs the CPU and GPU time of the application's frames.
+    bool OpenXrRuntime::isAppFrameTimingNeeded() const {
+        return m_useFrameTimingOverride || m_useDynamicResolution || m_useSmoothingGovernor ||
+               has_XR_EXT_performance_settings || m_isPerformanceMetricsEnabled || IsTraceEnabled();
+    }
+
+    // Follow the frame rate division applied by the compositor. Must be called with m_frameLock held.
+    void OpenXrRuntime::updateFramePacing() {
+        if (!m_useSmoothingAwarePacing && !m_isPerformanceMetricsEnabled) {
+            m_compositorRateDivisor = 1;
+            m_framePacer.reset();
+            return;
+        }
+
+        const bool isNewSample = m_compositorRateSampler.sample(pvr_getTimeSeconds(m_pvr), [&] {
+            return frame_pacing::getRateDivisor(!!pvr_getIntConfig(m_pvrSession, "asw_active", 0),
+                                                pvr_getIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", 1));
+        });
+        m_compositorRateDivisor = m_compositorRateSampler.getDivisor();
+
+        if (!m_useSmoothingAwarePacing) {
+            m_framePacer.reset();
+            return;
+        }
+
+        // The pacer counts the observations of a new divisor, so it only sees each sample once.
+        if (isNewSample && m_framePacer.update(m_compositorRateDivisor)) {
+            Log("Frame pacing is now 1/%u of the refresh rate\n", m_framePacer.getDivisor());
+            TraceLoggingWrite(g_traceProvider,
+                              "FramePacing_Divisor",
+                              TLArg(m_compositorRateDivisor, "CompositorDivisor"),
+                              TLArg(m_framePacer.getDivisor(), "Divisor"));
+        }
+    }
+
+    // Engage or release compulsive smoothing based on the application's frame times. Must be called with m_frameLock
+    // held.
+    void OpenXrRuntime::updateSmoothingGovernor(uint64_t cpuFrameTimeUs, uint64_t gpuFrameTimeUs) {
+        // The application misses its budget whenever either its CPU or GPU work does.
+        const uint64_t frameTimeUs = std::max(cpuFrameTimeUs, gpuFrameTimeUs);
+        const auto newDivisor =
+            m_smoothingGovernor.update((double)frameTimeUs, m_frameDuration * 1e6, pvr_getTimeSeconds(m_pvr));
+
+        TraceLoggingWrite(g_traceProvider,
+                          "SmoothingGovernor_Update",
+                          TLArg(frameTimeUs, "FrameTimeUs"),
+                          TLArg(m_frameDuration * 1e6, "FrameBudgetUs"),
+                          TLArg(m_smoothingGovernor.getMissScore(), "MissScore"),
+                          TLArg(m_smoothingGovernor.getFitFrames(), "FitFrames"),
+                          TLArg(m_smoothingGovernor.getDivisor(), "Divisor"));
+
+        if (newDivisor) {
+            Log("Smoothing governor %s (frame time: %.1fms)\n",
+                newDivisor.value() > 1 ? "engaged" : "released",
+                frameTimeUs / 1e3f);
+            TraceLoggingWrite(g_traceProvider,
+                              "SmoothingGovernor_Decision",
+                              TLArg(newDivisor.value(), "Divisor"),
+                              TLArg(frameTimeUs, "FrameTimeUs"),
+                              TLArg(m_frameDuration * 1e6, "FrameBudgetUs"));
+
+            applySmoothingDivisor(newDivisor.value());
+        }
+    }
+
+    void OpenXrRuntime::applySmoothingDivisor(uint32_t divisor) {
+        if (divisor > 1) {
+            if (!m_smoothingGovernorSavedConfig) {
+                m_smoothingGovernorSavedConfig =
+                    std::make_pair(pvr_getIntConfig(m_pvrSession, "dbg_asw_enable", 0),
+                                   pvr_getIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", 1));
+
+                // Persist the user's configuration, so it can be restored at the next startup should we not get a
+                // chance to do it ourselves.
+                RegSetDword(HKEY_CURRENT_USER,
+                            RegPrefix,
+                            "saved_dbg_asw_enable",
+                            (DWORD)m_smoothingGovernorSavedConfig.value().first);
+                RegSetDword(HKEY_CURRENT_USER,
+                            RegPrefix,
+                            "saved_dbg_force_framerate_divide_by",
+                            (DWORD)m_smoothingGovernorSavedConfig.value().second);
+            }
+            pvr_setIntConfig(m_pvrSession, "dbg_asw_enable", 1);
+            pvr_setIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", (int)divisor);
+        } else if (m_smoothingGovernorSavedConfig) {
+            pvr_setIntConfig(m_pvrSession, "dbg_asw_enable", m_smoothingGovernorSavedConfig.value().first);
+            pvr_setIntConfig(
+                m_pvrSession, "dbg_force_framerate_divide_by", m_smoothingGovernorSavedConfig.value().second);
+            m_smoothingGovernorSavedConfig.reset();
+            RegDeleteDword(HKEY_CURRENT_USER, RegPrefix, "saved_dbg_asw_enable");
+            RegDeleteDword(HKEY_CURRENT_USER, RegPrefix, "saved_dbg_force_framerate_divide_by");
+        }
+    }
+
+    void OpenXrRuntime::restoreSmoothingConfig() {
+        const auto aswEnable = RegGetDword(HKEY_CURRENT_USER, RegPrefix, "saved_dbg_asw_enable");
+        const auto divideBy = RegGetDword(HKEY_CURRENT_USER, RegPrefix, "saved_dbg_force_framerate_divide_by");
+        if (!aswEnable && !divideBy) {
+            return;
+        }
+
+        // A previous process exited while the smoothing governor was engaged.
+        Log("Restoring smoothing configuration from previous session\n");
+        TraceLoggingWrite(g_traceProvider,
+                          "SmoothingGovernor_Restore",
+                          TLArg(aswEnable.value_or(0), "AswEnable"),
+                          TLArg(divideBy.value_or(1), "DivideBy"));
+        if (aswEnable) {
+            pvr_setIntConfig(m_pvrSession, "dbg_asw_enable", aswEnable.value());
+        }
+        if (divideBy) {
+            pvr_setIntConfig(m_pvrSession, "dbg_force_framerate_divide_by", divideBy.value());
+        }
+        RegDeleteDword(HKEY_CURRENT_USER, RegPrefix, "saved_dbg_asw_enable");
+        RegDeleteDword(HKEY_CURRENT_USER, RegPrefix, "saved_dbg_force_framerate_divide_by");
+    }
+
+    // Must be called with m_frameLock held.
+    void OpenXrRuntime::recordFrameLatency(const frame_latency::FrameRecord& record) {
+        m_frameLatencyTracker.record(record);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "FrameLatency",
+                          TLArg(record.getWaitDuration() * 1e3, "WaitDurationMs"),
+                          TLArg(record.getAppFrameTime() * 1e3, "AppFrameTimeMs"),
+                          TLArg(record.getSubmitDuration() * 1e3, "SubmitDurationMs"),
+                          TLArg(record.getLateness() * 1e3, "LatenessMs"),
+                          TLArg(record.getMotionToPhoton() * 1e3, "MotionToPhotonMs"),
+                          TLArg(frame_latency::Tracker::isLate(record), "Late"));
+
+        if (m_frameLatencySummaryPeriod > 0.0) {
+            const auto summary =
+                m_frameLatencyTracker.getSummaryIfDue(record.compositorReturn, m_frameLatencySummaryPeriod);
+            if (summary) {
+                logFrameLatencySummary(summary.value());
+            }
+        }
+    }
+
+    void OpenXrRuntime::logFrameLatencySummary(const frame_latency::Summary& summary) const {
+        const auto format = [](const frame_latency::Percentiles& percentiles) {
+            return fmt::format(
+                "{:.1f}/{:.1f}/{:.1f}ms", percentiles.p50 * 1e3, percentiles.p90 * 1e3, percentiles.p99 * 1e3);
+        };
+
+        Log("Frame latency over %.0fs: %u frames, %u late, %u stutters\n",
+            summary.duration,
+            summary.frameCount,
+            summary.lateFrameCount,
+            summary.stutterCount);
+        Log("  (p50/p90/p99) wait: %s, app: %s, submit: %s, lateness: %s, motion-to-photon: %s\n",
+            format(summary.waitDuration).c_str(),
+            format(summary.appFrameTime).c_str(),
+            format(summary.submitDuration).c_str(),
+            format(summary.lateness).c_str(),
+            format(summary.motionToPhoton).c_str());
+
+        TraceLoggingWrite(g_traceProvider,
+                          "FrameLatency_Summary",
+                          TLArg(summary.duration, "Duration"),
+                          TLArg(summary.frameCount, "FrameCount"),
+                          TLArg(summary.lateFrameCount, "LateFrameCount"),
+                          TLArg(summary.stutterCount, "StutterCount"),
+                          TLArg(summary.waitDuration.p99 * 1e3, "WaitDurationP99Ms"),
+                          TLArg(summary.lateness.p99 * 1e3, "LatenessP99Ms"),
+                          TLArg(summary.motionToPhoton.p50 * 1e3, "MotionToPhotonP50Ms"));
+    }
+
 } // namespace pimax_openxr
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Per-frame latency accounting: how the frame loop actually unfolded versus the predicted display time.
+
+namespace pimax_openxr::frame_latency {
+
+    // The timestamps (in seconds) of one frame, from xrWaitFrame() to the return of pvr_endFrame().
+    struct FrameRecord {
+        double waitStart{0.0};
+        double waitEnd{0.0};
+        double begin{0.0};
+        double endSubmit{0.0};
+        double compositorReturn{0.0};
+        double predictedDisplayTime{0.0};
+
+        // The expected period between two frames of the application.
+        double framePeriod{0.0};
+
+        double getWaitDuration() const {
+            return waitEnd - waitStart;
+        }
+
+        double getAppFrameTime() const {
+            return endSubmit - begin;
+        }
+
+        double getSubmitDuration() const {
+            return compositorReturn - endSubmit;
+        }
+
+        // How long after the predicted display time the frame was handed off. Negative when the frame was on time.
+        double getLateness() const {
+            return compositorReturn - predictedDisplayTime;
+        }
+
+        // The latency from the pose prediction (made at the end of xrWaitFrame()) to the display.
+        double getMotionToPhoton() const {
+            return predictedDisplayTime - waitEnd;
+        }
+    };
+
+    struct Percentiles {
+        double p50{0.0};
+        double p90{0.0};
+        double p99{0.0};
+    };
+
+    struct Summary {
+        double duration{0.0};
+        uint32_t frameCount{0};
+
+        // Frames handed off after their predicted display time.
+        uint32_t lateFrameCount{0};
+
+        // Frames that came more than 1.5 periods after the previous one.
+        uint32_t stutterCount{0};
+
+        Percentiles waitDuration;
+        Percentiles appFrameTime;
+        Percentiles submitDuration;
+        Percentiles lateness;
+        Percentiles motionToPhoton;
+    };
+
+    class Tracker {
+      public:
+        static constexpr size_t Capacity = 4096;
+
+        Tracker() {
+            m_records.resize(Capacity);
+            m_scratch.reserve(Capacity);
+        }
+
+        void reset() {
+            m_count = 0;
+            m_lateFrameCount = m_stutterCount = 0;
+            m_lastEndSubmit.reset();
+            m_periodStart.reset();
+        }
+
+        void record(const FrameRecord& record) {
+            if (!m_periodStart) {
+                m_periodStart = record.waitStart;
+            }
+
+            if (isLate(record)) {
+                m_lateFrameCount++;
+            }
+            if (m_lastEndSubmit && record.framePeriod > 0.0 &&
+                record.endSubmit - m_lastEndSubmit.value() > 1.5 * record.framePeriod) {
+                m_stutterCount++;
+            }
+            m_lastEndSubmit = record.endSubmit;
+
+            // Once full, the oldest records of the period are overwritten and the percentiles only cover the most
+            // recent Capacity frames.
+            m_records[m_count % Capacity] = record;
+            m_count++;
+        }
+
+        static bool isLate(const FrameRecord& record) {
+            return record.getLateness() > 0.0;
+        }
+
+        // Produce the summary of the frames since the last summary, once per period.
+        std::optional<Summary> getSummaryIfDue(double now, double period) {
+            if (!m_periodStart || now - m_periodStart.value() < period || !m_count) {
+                return {};
+            }
+
+            Summary summary;
+            summary.duration = now - m_periodStart.value();
+            summary.frameCount = (uint32_t)m_count;
+            summary.lateFrameCount = m_lateFrameCount;
+            summary.stutterCount = m_stutterCount;
+
+            const size_t count = std::min(m_count, Capacity);
+            const auto percentiles = [&](double (FrameRecord::*metric)() const) {
+                m_scratch.clear();
+                for (size_t i = 0; i < count; i++) {
+                    m_scratch.push_back((m_records[i].*metric)());
+                }
+                return Percentiles{getPercentile(0.5), getPercentile(0.9), getPercentile(0.99)};
+            };
+            summary.waitDuration = percentiles(&FrameRecord::getWaitDuration);
+            summary.appFrameTime = percentiles(&FrameRecord::getAppFrameTime);
+            summary.submitDuration = percentiles(&FrameRecord::getSubmitDuration);
+            summary.lateness = percentiles(&FrameRecord::getLateness);
+            summary.motionToPhoton = percentiles(&FrameRecord::getMotionToPhoton);
+
+            // Start a new period. The stutter detection carries over.
+            m_count = 0;
+            m_lateFrameCount = m_stutterCount = 0;
+            m_periodStart = now;
+
+            return summary;
+        }
+
+      private:
+        double getPercentile(double fraction) {
+            const auto nth = m_scratch.begin() + (size_t)(fraction * (m_scratch.size() - 1) + 0.5);
+            std::nth_element(m_scratch.begin(), nth, m_scratch.end());
+            return *nth;
+        }
+
+        std::vector<FrameRecord> m_records;
+        std::vector<double> m_scratch;
+        size_t m_count{0};
+        uint32_t m_lateFrameCount{0};
+        uint32_t m_stutterCount{0};
+        std::optional<double> m_lastEndSubmit;
+        std::optional<double> m_periodStart;
+    };
+
+} // namespace pimax_openxr::frame_latency
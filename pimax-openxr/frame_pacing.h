@@ -0,0 +1,152 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The pacing policy of xrWaitFrame() when pi_server runs the application at a fraction of the display refresh rate
+// (Smart Smoothing or compulsive smoothing).
+
+namespace pimax_openxr::frame_pacing {
+
+    // The largest frame rate division that we follow.
+    constexpr uint32_t MaxRateDivisor = 4;
+
+    // Returns the fraction of the refresh rate at which the compositor is consuming application frames.
+    static inline uint32_t getRateDivisor(bool isSmartSmoothingActive, int forcedDivideBy) {
+        if (forcedDivideBy > 1) {
+            return std::min((uint32_t)forcedDivideBy, MaxRateDivisor);
+        }
+        return isSmartSmoothingActive ? 2 : 1;
+    }
+
+    // The divisor comes from pi_server's configuration, which is too costly to query on every frame while holding the
+    // frame lock. It is sampled at most once per period, and the last sample is used in between.
+    class DivisorSampler {
+      public:
+        explicit DivisorSampler(double period = 0.1) : m_period(period) {
+        }
+
+        void reset() {
+            m_divisor = 1;
+            m_lastSampleTime.reset();
+        }
+
+        // Returns true when query() was called for a new sample.
+        template <typename Query>
+        bool sample(double now, Query&& query) {
+            if (m_lastSampleTime && now - m_lastSampleTime.value() < m_period) {
+                return false;
+            }
+            m_divisor = query();
+            m_lastSampleTime = now;
+            return true;
+        }
+
+        uint32_t getDivisor() const {
+            return m_divisor;
+        }
+
+      private:
+        const double m_period;
+
+        uint32_t m_divisor{1};
+        std::optional<double> m_lastSampleTime;
+    };
+
+    class Pacer {
+      public:
+        // engageFrames is the number of consecutive observations of a higher divisor before following it. Lowering
+        // the divisor is immediate, so that the application is never held back once the compositor wants more frames.
+        explicit Pacer(uint32_t engageFrames = 3) : m_engageFrames(engageFrames) {
+        }
+
+        void reset() {
+            m_divisor = 1;
+            m_candidateDivisor = 1;
+            m_candidateFrames = 0;
+            m_lastPredictedDisplayTime.reset();
+        }
+
+        // Update the pacer with the divisor observed from the compositor. Returns true when the pacing changed.
+        bool update(uint32_t observedDivisor) {
+            observedDivisor = std::clamp(observedDivisor, 1u, MaxRateDivisor);
+
+            if (observedDivisor <= m_divisor) {
+                m_candidateFrames = 0;
+                if (observedDivisor < m_divisor) {
+                    m_divisor = observedDivisor;
+                    return true;
+                }
+                return false;
+            }
+
+            if (observedDivisor != m_candidateDivisor) {
+                m_candidateDivisor = observedDivisor;
+                m_candidateFrames = 0;
+            }
+            if (++m_candidateFrames < m_engageFrames) {
+                return false;
+            }
+
+            m_divisor = m_candidateDivisor;
+            m_candidateFrames = 0;
+            return true;
+        }
+
+        uint32_t getDivisor() const {
+            return m_divisor;
+        }
+
+        // The period between two frames of the application.
+        double getFramePeriod(double frameDuration) const {
+            return frameDuration * m_divisor;
+        }
+
+        // The time at which xrWaitFrame() should return for the next frame.
+        double getNextWakeTime(double lastWaitedTime, double frameDuration) const {
+            return lastWaitedTime + getFramePeriod(frameDuration);
+        }
+
+        // The compositor predicts the next vsync, however with a divided rate the frame will be displayed for the
+        // latest of the vsyncs covered by the application's frame period. The prediction is kept strictly increasing
+        // across transitions, as required by the OpenXR specification.
+        double predictDisplayTime(double compositorPrediction, double frameDuration) {
+            double predictedDisplayTime = compositorPrediction + (m_divisor - 1) * frameDuration;
+            if (m_lastPredictedDisplayTime && predictedDisplayTime <= m_lastPredictedDisplayTime.value()) {
+                predictedDisplayTime = m_lastPredictedDisplayTime.value() + frameDuration;
+            }
+            m_lastPredictedDisplayTime = predictedDisplayTime;
+            return predictedDisplayTime;
+        }
+
+      private:
+        const uint32_t m_engageFrames;
+
+        uint32_t m_divisor{1};
+        uint32_t m_candidateDivisor{1};
+        uint32_t m_candidateFrames{0};
+        std::optional<double> m_lastPredictedDisplayTime;
+    };
+
+} // namespace pimax_openxr::frame_pacing
@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the optional submission thread, which calls pvr_endFrame() on behalf of xrEndFrame(). pvr_endFrame() is a
+// call to the compositor that may block, and this lets the application's render thread proceed in the meantime.
+// Building the layers, the copies and the swapchain commits still happen in xrEndFrame(), since they must be ordered
+// with the application's use of the swapchains.
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+
+    void OpenXrRuntime::startSubmissionThread() {
+        TraceLoggingWrite(g_traceProvider, "SubmissionThread_Start");
+
+        const auto submit = [&](Submission& submission) {
+            TraceLocalActivity(endFrame);
+            TraceLoggingWriteStart(
+                endFrame, "PVR_EndFrame", TLArg(submission.layerCount, "NumLayers"), TLArg(true, "Async"));
+            try {
+                CHECK_PVRCMD(pvr_endFrame(m_pvrSession, 0, submission.headers.data(), submission.layerCount));
+            } catch (std::exception&) {
+                TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
+                throw;
+            }
+            TraceLoggingWriteStop(endFrame, "PVR_EndFrame");
+            submission.compositorReturnTime = pvr_getTimeSeconds(m_pvr);
+        };
+
+        const auto complete = [&](Submission& submission, const std::optional<std::string>& error) {
+            if (!error) {
+                m_canBeginFrame = true;
+            } else {
+                ErrorLog("Frame submission failed: %s\n", error.value().c_str());
+            }
+
+            if (submission.latencyRecord) {
+                submission.latencyRecord->compositorReturn = submission.compositorReturnTime;
+                recordFrameLatency(submission.latencyRecord.value());
+                submission.latencyRecord.reset();
+            }
+
+            // Signal xrWaitFrame() and xrBeginFrame().
+            TraceLoggingWrite(g_traceProvider, "Submission_Signal");
+        };
+
+        m_submitter.start(m_frameLock, m_frameCondVar, submit, complete);
+    }
+
+    void OpenXrRuntime::stopSubmissionThread() {
+        if (!m_submitter.isRunning()) {
+            return;
+        }
+
+        m_submitter.stop();
+        TraceLoggingWrite(g_traceProvider, "SubmissionThread_Stop");
+    }
+
+    // Hand off the layers to the submission thread. Must be called with m_frameLock held.
+    void OpenXrRuntime::queueSubmission(std::unique_lock<std::mutex>& lock,
+                                        const std::vector<pvrLayerHeader*>& layers) {
+        // xrBeginFrame() already waited for the previous submission, so this is not expected to block.
+        waitForSubmission(lock);
+
+        // PVR holds on to the pointers until pvr_endFrame() returns, so we copy the layers into storage that outlives
+        // this call.
+        Submission& submission = m_submitter.getSlot();
+        submission.layerCount = (uint32_t)layers.size();
+        for (uint32_t i = 0; i < submission.layerCount; i++) {
+            submission.layers[i] = *reinterpret_cast<const pvrLayer_Union*>(layers[i]);
+            submission.headers[i] = &submission.layers[i].Header;
+        }
+
+        m_submitter.queue(lock);
+    }
+
+    // Wait for the submission thread to complete the pending submission, if any. Must be called with m_frameLock held.
+    void OpenXrRuntime::waitForSubmission(std::unique_lock<std::mutex>& lock) {
+        if (!m_submitter.isPending()) {
+            return;
+        }
+
+        TraceLocalActivity(waitSubmission);
+        TraceLoggingWriteStart(waitSubmission, "WaitSubmission");
+        m_submitter.wait(lock);
+        TraceLoggingWriteStop(waitSubmission, "WaitSubmission");
+    }
+
+    // Report the failure of a previous submission to the application. Must be called with m_frameLock held.
+    void OpenXrRuntime::checkSubmissionError() {
+        m_submitter.rethrowError();
+    }
+
+} // namespace pimax_openxr
@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The handoff of the frames from xrEndFrame() to a thread calling the compositor on behalf of the application.
+
+namespace pimax_openxr::frame_submission {
+
+    // The slot holding the frame is protected by the frame lock of the owner, except while a submission is pending,
+    // where it is owned by the thread.
+    template <typename Slot>
+    class Submitter {
+      public:
+        Submitter() = default;
+        Submitter(const Submitter&) = delete;
+        Submitter& operator=(const Submitter&) = delete;
+
+        ~Submitter() {
+            stop();
+        }
+
+        // submit() is called without the lock held, and may throw. complete() is called with the lock held once
+        // submit() returned, with the error if any. The completion condition variable is notified afterwards.
+        template <typename Submit, typename Complete>
+        void start(std::mutex& lock, std::condition_variable& completion, Submit&& submit, Complete&& complete) {
+            m_lock = &lock;
+            m_completion = &completion;
+            m_exit = false;
+            m_isPending = false;
+            m_error.reset();
+            m_thread = std::thread(
+                [this, submit = std::forward<Submit>(submit), complete = std::forward<Complete>(complete)]() mutable {
+                    threadMain(submit, complete);
+                });
+        }
+
+        // Any pending submission is completed before the thread exits. Must be called without the lock held.
+        void stop() {
+            if (!m_thread.joinable()) {
+                return;
+            }
+
+            {
+                std::unique_lock lock(*m_lock);
+                m_exit = true;
+            }
+            m_wakeUp.notify_one();
+            m_thread.join();
+        }
+
+        bool isRunning() const {
+            return m_thread.joinable();
+        }
+
+        // Must be called with the lock held.
+        bool isPending() const {
+            return m_isPending;
+        }
+
+        // The slot to fill for the next submission. Must be called with the lock held and no submission pending.
+        Slot& getSlot() {
+            return m_slot;
+        }
+
+        // Hand off the slot to the thread. Must be called with the lock held.
+        void queue(std::unique_lock<std::mutex>& lock) {
+            wait(lock);
+            m_isPending = true;
+            m_wakeUp.notify_one();
+        }
+
+        // Wait for the thread to complete the pending submission, if any. Must be called with the lock held.
+        void wait(std::unique_lock<std::mutex>& lock) {
+            m_completion->wait(lock, [&] { return !m_isPending; });
+        }
+
+        // Report the failure of a previous submission, once. Must be called with the lock held.
+        void rethrowError() {
+            if (m_error) {
+                const std::string error = m_error.value();
+                m_error.reset();
+                throw std::runtime_error(error);
+            }
+        }
+
+      private:
+        template <typename Submit, typename Complete>
+        void threadMain(Submit& submit, Complete& complete) {
+            std::unique_lock lock(*m_lock);
+            while (true) {
+                m_wakeUp.wait(lock, [&] { return m_isPending || m_exit; });
+                if (!m_isPending) {
+                    break;
+                }
+
+                lock.unlock();
+                std::optional<std::string> error;
+                try {
+                    submit(m_slot);
+                } catch (std::exception& exc) {
+                    error = exc.what();
+                }
+                lock.lock();
+
+                if (error) {
+                    m_error = error;
+                }
+                complete(m_slot, error);
+
+                m_isPending = false;
+                m_completion->notify_all();
+            }
+        }
+
+        std::mutex* m_lock{nullptr};
+        std::condition_variable* m_completion{nullptr};
+        std::condition_variable m_wakeUp;
+        std::thread m_thread;
+        bool m_exit{false};
+        bool m_isPending{false};
+        std::optional<std::string> m_error;
+        Slot m_slot{};
+    };
+
+} // namespace pimax_openxr::frame_submission
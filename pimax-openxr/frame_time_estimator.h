@@ -0,0 +1,205 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The estimator of the application's GPU frame time that is hinted to pi_server for its pacing.
+
+namespace pimax_openxr::frame_time_estimator {
+
+    constexpr size_t MaxWindowLength = 63;
+
+    // A median over a sliding window. The samples are kept both in arrival order (to know which one leaves the window)
+    // and in sorted order (to read the median), so an update moves at most MaxWindowLength values and never
+    // allocates.
+    class RollingMedian {
+      public:
+        explicit RollingMedian(size_t windowLength = 5) {
+            setWindowLength(windowLength);
+        }
+
+        void setWindowLength(size_t windowLength) {
+            m_windowLength = std::clamp(windowLength, (size_t)1, MaxWindowLength);
+            reset();
+        }
+
+        size_t getWindowLength() const {
+            return m_windowLength;
+        }
+
+        void reset() {
+            m_head = 0;
+            m_count = 0;
+        }
+
+        void push(double sample) {
+            if (m_count == m_windowLength) {
+                // Evict the oldest sample from the sorted samples.
+                const auto sortedEnd = m_sorted.begin() + m_count;
+                const auto it = std::lower_bound(m_sorted.begin(), sortedEnd, m_samples[m_head]);
+                std::copy(it + 1, sortedEnd, it);
+                m_count--;
+            }
+
+            m_samples[m_head] = sample;
+            m_head = (m_head + 1) % m_windowLength;
+
+            const auto sortedEnd = m_sorted.begin() + m_count;
+            const auto it = std::upper_bound(m_sorted.begin(), sortedEnd, sample);
+            std::copy_backward(it, sortedEnd, sortedEnd + 1);
+            *it = sample;
+            m_count++;
+        }
+
+        bool empty() const {
+            return m_count == 0;
+        }
+
+        // For an even number of samples, this is the upper median.
+        double get() const {
+            return m_count ? m_sorted[m_count / 2] : 0.0;
+        }
+
+      private:
+        size_t m_windowLength{1};
+        std::array<double, MaxWindowLength> m_samples{};
+        std::array<double, MaxWindowLength> m_sorted{};
+        size_t m_head{0};
+        size_t m_count{0};
+    };
+
+    struct EstimatorSettings {
+        // Smoothing factors of the level and the trend (Holt's linear method).
+        double levelSmoothing{0.5};
+        double trendSmoothing{0.2};
+
+        // Samples are clamped within this fraction of the median before updating the level, so that a spike can only
+        // move the estimate by a bounded amount.
+        double outlierBound{0.25};
+
+        // The number of consecutive samples outside of the bound, on the same side, that are treated as a change of
+        // load rather than outliers.
+        uint32_t stepFrames{3};
+    };
+
+    // Predicts the GPU time of the next frame. The rolling median rejects the outliers, while a level and trend
+    // smoothed exponentially follow the gradual changes of load. A sustained step is detected within stepFrames frames
+    // instead of half of the median window.
+    class Estimator {
+      public:
+        Estimator() = default;
+        explicit Estimator(const EstimatorSettings& settings) : m_settings(settings) {
+            m_settings.stepFrames = std::clamp(m_settings.stepFrames, 1u, (uint32_t)MaxStepFrames);
+        }
+
+        void setWindowLength(size_t windowLength) {
+            windowLength = std::clamp(windowLength, (size_t)1, MaxWindowLength);
+            if (windowLength != m_median.getWindowLength()) {
+                m_median.setWindowLength(windowLength);
+                reset();
+            }
+        }
+
+        void reset() {
+            m_median.reset();
+            m_level.reset();
+            m_trend = 0.0;
+            m_outlierRun = 0;
+            m_recentCount = 0;
+        }
+
+        // Returns the prediction for the next frame.
+        double update(double sample) {
+            // Classify the sample against the median of the previous ones.
+            if (!m_median.empty()) {
+                const double median = m_median.get();
+                const int side = sample > median * (1.0 + m_settings.outlierBound)   ? 1
+                                 : sample < median * (1.0 - m_settings.outlierBound) ? -1
+                                                                                     : 0;
+                if (side == 0 || (side > 0) != (m_outlierRun > 0)) {
+                    m_outlierRun = side;
+                } else {
+                    m_outlierRun += side;
+                }
+            }
+
+            m_median.push(sample);
+            m_recent[m_recentCount % m_settings.stepFrames] = sample;
+            m_recentCount++;
+
+            if ((uint32_t)std::abs(m_outlierRun) >= m_settings.stepFrames) {
+                // The load changed: restart from the most recent samples only.
+                m_median.reset();
+                for (uint32_t i = 0; i < m_settings.stepFrames; i++) {
+                    m_median.push(m_recent[(m_recentCount + i) % m_settings.stepFrames]);
+                }
+                m_level = m_median.get();
+                m_trend = 0.0;
+                m_outlierRun = 0;
+
+                return getPrediction();
+            }
+
+            const double median = m_median.get();
+            const double clampedSample =
+                std::clamp(sample, median * (1.0 - m_settings.outlierBound), median * (1.0 + m_settings.outlierBound));
+
+            if (!m_level) {
+                m_level = clampedSample;
+            } else {
+                const double lastLevel = m_level.value();
+                const double level = m_settings.levelSmoothing * clampedSample +
+                                     (1.0 - m_settings.levelSmoothing) * (lastLevel + m_trend);
+                m_trend = m_settings.trendSmoothing * (level - lastLevel) + (1.0 - m_settings.trendSmoothing) * m_trend;
+                m_level = level;
+            }
+
+            return getPrediction();
+        }
+
+        double getPrediction() const {
+            return m_level ? std::max(0.0, m_level.value() + m_trend) : 0.0;
+        }
+
+        double getMedian() const {
+            return m_median.get();
+        }
+
+        double getTrend() const {
+            return m_trend;
+        }
+
+      private:
+        static constexpr size_t MaxStepFrames = 8;
+
+        EstimatorSettings m_settings;
+        RollingMedian m_median;
+        std::optional<double> m_level;
+        double m_trend{0.0};
+        int m_outlierRun{0};
+        std::array<double, MaxStepFrames> m_recent{};
+        uint64_t m_recentCount{0};
+    };
+
+} // namespace pimax_openxr::frame_time_estimator
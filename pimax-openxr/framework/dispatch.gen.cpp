@@ -1130,6 +1130,27 @@ namespace RUNTIME_NAMESPACE {
 		return result;
 	}
 
+	XrResult XRAPI_CALL xrPerfSettingsSetPerformanceLevelEXT(XrSession session, XrPerfSettingsDomainEXT domain, XrPerfSettingsLevelEXT level) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrPerfSettingsSetPerformanceLevelEXT");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrPerfSettingsSetPerformanceLevelEXT(session, domain, level);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrPerfSettingsSetPerformanceLevelEXT_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrPerfSettingsSetPerformanceLevelEXT: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrPerfSettingsSetPerformanceLevelEXT", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrPerfSettingsSetPerformanceLevelEXT failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 	XrResult XRAPI_CALL xrGetOpenGLGraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsOpenGLKHR* graphicsRequirements) {
 		TraceLocalActivity(local);
 		TraceLoggingWriteStart(local, "xrGetOpenGLGraphicsRequirementsKHR");
@@ -1487,6 +1508,90 @@ namespace RUNTIME_NAMESPACE {
 		return result;
 	}
 
+	XrResult XRAPI_CALL xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance, uint32_t counterPathCapacityInput, uint32_t* counterPathCountOutput, XrPath* counterPaths) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrEnumeratePerformanceMetricsCounterPathsMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrEnumeratePerformanceMetricsCounterPathsMETA(instance, counterPathCapacityInput, counterPathCountOutput, counterPaths);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrEnumeratePerformanceMetricsCounterPathsMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrEnumeratePerformanceMetricsCounterPathsMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrEnumeratePerformanceMetricsCounterPathsMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrEnumeratePerformanceMetricsCounterPathsMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrSetPerformanceMetricsStateMETA(XrSession session, const XrPerformanceMetricsStateMETA* state) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrSetPerformanceMetricsStateMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrSetPerformanceMetricsStateMETA(session, state);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrSetPerformanceMetricsStateMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrSetPerformanceMetricsStateMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrSetPerformanceMetricsStateMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrSetPerformanceMetricsStateMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrGetPerformanceMetricsStateMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrGetPerformanceMetricsStateMETA(session, state);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrGetPerformanceMetricsStateMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrGetPerformanceMetricsStateMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrGetPerformanceMetricsStateMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrGetPerformanceMetricsStateMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
+	XrResult XRAPI_CALL xrQueryPerformanceMetricsCounterMETA(XrSession session, XrPath counterPath, XrPerformanceMetricsCounterMETA* counter) {
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrQueryPerformanceMetricsCounterMETA");
+
+		XrResult result;
+		try {
+			result = RUNTIME_NAMESPACE::GetInstance()->xrQueryPerformanceMetricsCounterMETA(session, counterPath, counter);
+		} catch (std::exception& exc) {
+			TraceLoggingWriteTagged(local, "xrQueryPerformanceMetricsCounterMETA_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrQueryPerformanceMetricsCounterMETA: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrQueryPerformanceMetricsCounterMETA", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrQueryPerformanceMetricsCounterMETA failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 
 	// Auto-generated dispatcher handler.
 	XrResult OpenXrApi::xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
@@ -1654,6 +1759,9 @@ namespace RUNTIME_NAMESPACE {
 		else if (apiName == "xrStopHapticFeedback") {
 			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrStopHapticFeedback);
 		}
+		else if (has_XR_EXT_performance_settings && apiName == "xrPerfSettingsSetPerformanceLevelEXT") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrPerfSettingsSetPerformanceLevelEXT);
+		}
 		else if (has_XR_KHR_opengl_enable && apiName == "xrGetOpenGLGraphicsRequirementsKHR") {
 			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrGetOpenGLGraphicsRequirementsKHR);
 		}
@@ -1705,6 +1813,18 @@ namespace RUNTIME_NAMESPACE {
 		else if (has_XR_FB_display_refresh_rate && apiName == "xrRequestDisplayRefreshRateFB") {
 			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrRequestDisplayRefreshRateFB);
 		}
+		else if (has_XR_META_performance_metrics && apiName == "xrEnumeratePerformanceMetricsCounterPathsMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrEnumeratePerformanceMetricsCounterPathsMETA);
+		}
+		else if (has_XR_META_performance_metrics && apiName == "xrSetPerformanceMetricsStateMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrSetPerformanceMetricsStateMETA);
+		}
+		else if (has_XR_META_performance_metrics && apiName == "xrGetPerformanceMetricsStateMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrGetPerformanceMetricsStateMETA);
+		}
+		else if (has_XR_META_performance_metrics && apiName == "xrQueryPerformanceMetricsCounterMETA") {
+			*function = reinterpret_cast<PFN_xrVoidFunction>(RUNTIME_NAMESPACE::xrQueryPerformanceMetricsCounterMETA);
+		}
 		else {
 			return XR_ERROR_FUNCTION_UNSUPPORTED;
 		}
@@ -1743,6 +1863,21 @@ namespace RUNTIME_NAMESPACE {
 		else if (extensionName == "XR_FB_display_refresh_rate") {
 			has_XR_FB_display_refresh_rate = true;
 		}
+		else if (extensionName == "XR_EXT_eye_gaze_interaction") {
+			has_XR_EXT_eye_gaze_interaction = true;
+		}
+		else if (extensionName == "XR_VARJO_quad_views") {
+			has_XR_VARJO_quad_views = true;
+		}
+		else if (extensionName == "XR_VARJO_foveated_rendering") {
+			has_XR_VARJO_foveated_rendering = true;
+		}
+		else if (extensionName == "XR_EXT_performance_settings") {
+			has_XR_EXT_performance_settings = true;
+		}
+		else if (extensionName == "XR_META_performance_metrics") {
+			has_XR_META_performance_metrics = true;
+		}
 
 	}
 
@@ -39,7 +39,9 @@ from xrconventions import OpenXRConventions
 # Things we can configure.
 EXCLUDED_API = ['xrGetInstanceProcAddr', 'xrEnumerateApiLayerProperties']
 EXTENSIONS = ['XR_KHR_D3D11_enable', 'XR_KHR_D3D12_enable', 'XR_KHR_vulkan_enable', 'XR_KHR_vulkan_enable2', 'XR_KHR_opengl_enable',
-              'XR_KHR_composition_layer_depth', 'XR_KHR_visibility_mask', 'XR_KHR_win32_convert_performance_counter_time', "XR_FB_display_refresh_rate"]
+              'XR_KHR_composition_layer_depth', 'XR_KHR_visibility_mask', 'XR_KHR_win32_convert_performance_counter_time', "XR_FB_display_refresh_rate",
+              'XR_EXT_eye_gaze_interaction', 'XR_VARJO_quad_views', 'XR_VARJO_foveated_rendering', 'XR_EXT_performance_settings',
+              'XR_META_performance_metrics']
 
 class DispatchGenOutputGenerator(AutomaticSourceOutputGenerator):
     '''Common generator utilities and formatting.'''
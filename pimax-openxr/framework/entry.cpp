@@ -35,6 +35,9 @@ namespace RUNTIME_NAMESPACE {
     // The path to store logs & others.
     std::filesystem::path localAppData;
 
+    // The duration of each phase of the startup.
+    startup_timeline::Timeline startupTimeline;
+
     namespace log {
         // The file logger.
         std::ofstream logStream;
@@ -49,6 +52,8 @@ extern "C" {
 // Entry point for the loader.
 XrResult __declspec(dllexport) XRAPI_CALL xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo,
                                                                             XrNegotiateRuntimeRequest* runtimeRequest) {
+    const auto negotiateBegin = startup_timeline::Clock::now();
+
     localAppData = std::filesystem::path(getenv("LOCALAPPDATA")) / RuntimeName;
     CreateDirectoryA(localAppData.string().c_str(), nullptr);
 
@@ -79,6 +84,8 @@ XrResult __declspec(dllexport) XRAPI_CALL xrNegotiateLoaderRuntimeInterface(cons
     runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_API_LAYER_VERSION;
     runtimeRequest->runtimeApiVersion = XR_CURRENT_API_VERSION;
 
+    startupTimeline.record("negotiate", negotiateBegin);
+
     return XR_SUCCESS;
 }
 
@@ -0,0 +1,298 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Accounting of the GPU memory allocated by the runtime on behalf of the application (eg: extra swapchains per texture
+// array slice, intermediate textures for depth formats that PVR cannot use), and a pool of scratch resources shared
+// between swapchains.
+
+namespace pimax_openxr::gpu_memory {
+
+    enum class Category : uint32_t {
+        // The PVR swapchains requested by the application.
+        Swapchain = 0,
+
+        // The extra PVR swapchains for each slice of a texture array.
+        SliceSwapchain,
+
+        // The textures handed to the application when PVR cannot use the requested format.
+        DepthResolveImage,
+
+        // The pooled targets used when resolving depth formats.
+        ResolveScratch,
+
+        // The single-sampled copies of multisampled swapchains, for the runtime's own processing to sample.
+        CompositionResolveImage,
+
+        // The PVR swapchains receiving the output of the runtime's own processing (eg: quad views, upscaling).
+        RuntimeSwapchain,
+
+        // The PVR swapchains released by the application and kept for recycling.
+        SwapchainPool,
+
+        Count
+    };
+
+    static inline const char* ToString(Category category) {
+        switch (category) {
+        case Category::Swapchain:
+            return "Swapchain";
+        case Category::SliceSwapchain:
+            return "SliceSwapchain";
+        case Category::DepthResolveImage:
+            return "DepthResolveImage";
+        case Category::ResolveScratch:
+            return "ResolveScratch";
+        case Category::CompositionResolveImage:
+            return "CompositionResolveImage";
+        case Category::RuntimeSwapchain:
+            return "RuntimeSwapchain";
+        case Category::SwapchainPool:
+            return "SwapchainPool";
+        default:
+            return "Unknown";
+        }
+    }
+
+    // Estimate the size of a texture, including its mip chain. Block-compressed formats may have less than 8 bits per
+    // pixel.
+    static inline uint64_t estimateTextureSize(uint32_t width,
+                                               uint32_t height,
+                                               uint32_t arraySize,
+                                               uint32_t mipCount,
+                                               uint32_t sampleCount,
+                                               uint32_t bitsPerPixel) {
+        uint64_t bits = 0;
+        for (uint32_t mip = 0; mip < std::max(mipCount, 1u); mip++) {
+            bits += (uint64_t)std::max(width >> mip, 1u) * std::max(height >> mip, 1u) * bitsPerPixel;
+        }
+        return (bits + 7) / 8 * std::max(arraySize, 1u) * std::max(sampleCount, 1u);
+    }
+
+    // The allocations are recorded per owner (eg: a swapchain), so that they can all be released at once.
+    class Accounting {
+      public:
+        void add(Category category, const void* owner, uint64_t size) {
+            std::unique_lock lock(m_mutex);
+
+            m_owners[owner][(uint32_t)category] += size;
+            m_totals[(uint32_t)category] += size;
+            m_peak = std::max(m_peak, getTotalLocked());
+        }
+
+        void release(Category category, const void* owner, uint64_t size) {
+            std::unique_lock lock(m_mutex);
+
+            auto it = m_owners.find(owner);
+            if (it == m_owners.end()) {
+                return;
+            }
+
+            size = std::min(size, it->second[(uint32_t)category]);
+            it->second[(uint32_t)category] -= size;
+            m_totals[(uint32_t)category] -= size;
+            if (getOwnerTotal(it->second) == 0) {
+                m_owners.erase(it);
+            }
+        }
+
+        void releaseAll(const void* owner) {
+            std::unique_lock lock(m_mutex);
+
+            auto it = m_owners.find(owner);
+            if (it == m_owners.end()) {
+                return;
+            }
+
+            for (uint32_t i = 0; i < (uint32_t)Category::Count; i++) {
+                m_totals[i] -= it->second[i];
+            }
+            m_owners.erase(it);
+        }
+
+        uint64_t getTotal() const {
+            std::unique_lock lock(m_mutex);
+
+            return getTotalLocked();
+        }
+
+        uint64_t getTotal(Category category) const {
+            std::unique_lock lock(m_mutex);
+
+            return m_totals[(uint32_t)category];
+        }
+
+        uint64_t getTotal(const void* owner) const {
+            std::unique_lock lock(m_mutex);
+
+            const auto it = m_owners.find(owner);
+            return it != m_owners.cend() ? getOwnerTotal(it->second) : 0;
+        }
+
+        uint64_t getPeak() const {
+            std::unique_lock lock(m_mutex);
+
+            return m_peak;
+        }
+
+      private:
+        using Totals = std::array<uint64_t, (size_t)Category::Count>;
+
+        static uint64_t getOwnerTotal(const Totals& totals) {
+            uint64_t total = 0;
+            for (const auto size : totals) {
+                total += size;
+            }
+            return total;
+        }
+
+        uint64_t getTotalLocked() const {
+            return getOwnerTotal(m_totals);
+        }
+
+        mutable std::mutex m_mutex;
+        std::map<const void*, Totals> m_owners;
+        Totals m_totals{};
+        uint64_t m_peak{0};
+    };
+
+    // Scratch resources are only used transiently while recording GPU work on a single context, so one resource per
+    // size and format can be shared by all the swapchains. Resources that have not been used for a while (eg: after
+    // the swapchains using them were destroyed) are evicted.
+    template <typename Resource>
+    class ScratchPool {
+      public:
+        struct Key {
+            uint32_t width{0};
+            uint32_t height{0};
+            uint32_t format{0};
+            uint32_t mipCount{1};
+            uint32_t sampleCount{1};
+
+            bool operator<(const Key& other) const {
+                if (width != other.width) {
+                    return width < other.width;
+                }
+                if (height != other.height) {
+                    return height < other.height;
+                }
+                if (format != other.format) {
+                    return format < other.format;
+                }
+                if (mipCount != other.mipCount) {
+                    return mipCount < other.mipCount;
+                }
+                return sampleCount < other.sampleCount;
+            }
+        };
+
+        // Return the resource for the key, calling create() to make it when there is none. The create() function
+        // returns the resource and sets its size.
+        template <typename Create>
+        Resource& acquire(const Key& key, uint64_t now, Create&& create) {
+            auto it = m_entries.find(key);
+            if (it == m_entries.end()) {
+                Entry entry;
+                entry.resource = create(entry.size);
+                it = m_entries.insert_or_assign(key, std::move(entry)).first;
+                m_createdCount++;
+            }
+
+            it->second.lastUsed = now;
+            return it->second.resource;
+        }
+
+        // Evict the resources not used within maxIdle of now, and the least recently used ones until the total size is
+        // within maxSize. Resources used at now are never evicted, since they may still be referenced by the caller.
+        // The onEvict() function is called with the key and the size of each evicted resource.
+        template <typename OnEvict>
+        size_t evict(uint64_t now, uint64_t maxIdle, uint64_t maxSize, OnEvict&& onEvict) {
+            size_t evictedCount = 0;
+            for (auto it = m_entries.begin(); it != m_entries.end();) {
+                if (now - it->second.lastUsed > maxIdle) {
+                    onEvict(it->first, it->second.size);
+                    it = m_entries.erase(it);
+                    evictedCount++;
+                } else {
+                    it++;
+                }
+            }
+
+            while (getSize() > maxSize) {
+                auto oldest = m_entries.end();
+                for (auto it = m_entries.begin(); it != m_entries.end(); it++) {
+                    if (it->second.lastUsed != now &&
+                        (oldest == m_entries.end() || it->second.lastUsed < oldest->second.lastUsed)) {
+                        oldest = it;
+                    }
+                }
+                if (oldest == m_entries.end()) {
+                    break;
+                }
+                onEvict(oldest->first, oldest->second.size);
+                m_entries.erase(oldest);
+                evictedCount++;
+            }
+
+            return evictedCount;
+        }
+
+        template <typename OnEvict>
+        void clear(OnEvict&& onEvict) {
+            for (const auto& entry : m_entries) {
+                onEvict(entry.first, entry.second.size);
+            }
+            m_entries.clear();
+        }
+
+        size_t getCount() const {
+            return m_entries.size();
+        }
+
+        uint64_t getSize() const {
+            uint64_t size = 0;
+            for (const auto& entry : m_entries) {
+                size += entry.second.size;
+            }
+            return size;
+        }
+
+        // How many resources were created in total, to measure the reuse.
+        uint64_t getCreatedCount() const {
+            return m_createdCount;
+        }
+
+      private:
+        struct Entry {
+            Resource resource{};
+            uint64_t size{0};
+            uint64_t lastUsed{0};
+        };
+
+        std::map<Key, Entry> m_entries;
+        uint64_t m_createdCount{0};
+    };
+
+} // namespace pimax_openxr::gpu_memory
@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Turns a haptic vibration (amplitude, frequency and duration) into a train of pulses, since PVR only supports
+// individual pulses.
+
+namespace pimax_openxr::haptic_timeline {
+
+    struct Settings {
+        // The pulse rate when the application does not specify a frequency.
+        double defaultFrequency{100.0};
+
+        // The highest pulse rate we attempt.
+        double maxFrequency{320.0};
+    };
+
+    struct Vibration {
+        float amplitude{0.f};
+
+        // In Hz, 0 when unspecified.
+        double frequency{0.0};
+
+        // In seconds, 0 for the shortest vibration the device can do (a single pulse).
+        double duration{0.0};
+    };
+
+    // The pulses for one controller. A new vibration preempts the current one.
+    class Timeline {
+      public:
+        void start(double now, const Vibration& vibration, const Settings& settings) {
+            m_amplitude = std::clamp(vibration.amplitude, 0.f, 1.f);
+            const double frequency = vibration.frequency > 0.0
+                                         ? std::min(vibration.frequency, settings.maxFrequency)
+                                         : settings.defaultFrequency;
+            m_period = 1.0 / frequency;
+            m_nextPulseTime = now;
+            m_endTime = now + std::max(vibration.duration, 0.0);
+            m_isActive = m_amplitude > 0.f;
+        }
+
+        void stop() {
+            m_isActive = false;
+        }
+
+        bool isActive() const {
+            return m_isActive;
+        }
+
+        std::optional<double> getNextPulseTime() const {
+            if (!m_isActive) {
+                return {};
+            }
+            return m_nextPulseTime;
+        }
+
+        // Return the amplitude of the pulse that is due at `now`, if any. The pulses we were too late for are skipped
+        // rather than played back-to-back.
+        std::optional<float> poll(double now) {
+            if (!m_isActive || now < m_nextPulseTime) {
+                return {};
+            }
+
+            const double missedPeriods = std::floor((now - m_nextPulseTime) / m_period);
+            m_nextPulseTime += (missedPeriods + 1) * m_period;
+            if (m_nextPulseTime >= m_endTime) {
+                m_isActive = false;
+            }
+
+            return m_amplitude;
+        }
+
+      private:
+        float m_amplitude{0.f};
+        double m_period{0.0};
+        double m_nextPulseTime{0.0};
+        double m_endTime{0.0};
+        bool m_isActive{false};
+    };
+
+} // namespace pimax_openxr::haptic_timeline
@@ -0,0 +1,141 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the optional haptics thread, which plays the vibrations requested by the application as trains of PVR
+// pulses. xrApplyHapticFeedback() and xrStopHapticFeedback() only post a command for the thread.
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+
+    void OpenXrRuntime::startHapticsThread() {
+        m_hapticsEvent.create();
+        m_hapticsThreadExit = false;
+        m_hapticsCommand[0].reset();
+        m_hapticsCommand[1].reset();
+        m_hapticsThread = std::thread([&] { hapticsThreadMain(); });
+    }
+
+    void OpenXrRuntime::stopHapticsThread() {
+        if (!m_hapticsThread.joinable()) {
+            return;
+        }
+
+        {
+            std::unique_lock lock(m_hapticsLock);
+            m_hapticsThreadExit = true;
+        }
+        m_hapticsEvent.SetEvent();
+        m_hapticsThread.join();
+    }
+
+    // Post a vibration (or a stop, when there is no vibration) for the thread. The latest command preempts any
+    // command the thread did not pick up yet.
+    void OpenXrRuntime::queueHaptics(int side, const std::optional<haptic_timeline::Vibration>& vibration) {
+        {
+            std::unique_lock lock(m_hapticsLock);
+            m_hapticsCommand[side] = HapticsCommand{pvr_getTimeSeconds(m_pvr), vibration};
+        }
+        m_hapticsEvent.SetEvent();
+    }
+
+    void OpenXrRuntime::hapticsThreadMain() {
+        TraceLoggingWrite(g_traceProvider, "HapticsThread_Start");
+
+        // The default timer resolution is too coarse for the pulse rates we want.
+        wil::unique_handle timer(CreateWaitableTimerExW(
+            nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, SYNCHRONIZE | TIMER_MODIFY_STATE));
+        if (!timer) {
+            timer.reset(CreateWaitableTimerW(nullptr, FALSE, nullptr));
+        }
+
+        haptic_timeline::Timeline timelines[2];
+        while (true) {
+            {
+                std::unique_lock lock(m_hapticsLock);
+                if (m_hapticsThreadExit) {
+                    break;
+                }
+
+                for (int side = 0; side < 2; side++) {
+                    if (!m_hapticsCommand[side]) {
+                        continue;
+                    }
+
+                    const auto& command = m_hapticsCommand[side].value();
+                    if (command.vibration) {
+                        timelines[side].start(command.time, command.vibration.value(), m_hapticsSettings);
+                    } else {
+                        timelines[side].stop();
+                    }
+                    m_hapticsCommand[side].reset();
+                }
+            }
+
+            const double now = pvr_getTimeSeconds(m_pvr);
+            std::optional<double> nextPulseTime;
+            for (int side = 0; side < 2; side++) {
+                const auto amplitude = timelines[side].poll(now);
+                if (amplitude) {
+                    TraceLoggingWrite(g_traceProvider,
+                                      "PVR_HapticPulse",
+                                      TLArg(side == 0 ? "Left" : "Right", "Side"),
+                                      TLArg(amplitude.value(), "Amplitude"));
+                    const auto result = pvr_triggerHapticPulse(m_pvrSession,
+                                                               side == 0 ? pvrTrackedDevice_LeftController
+                                                                         : pvrTrackedDevice_RightController,
+                                                               amplitude.value());
+                    if (result != pvr_success) {
+                        TraceLoggingWrite(g_traceProvider, "PVR_HapticPulse_Error", TLArg((int)result, "Error"));
+                    }
+                }
+
+                const auto next = timelines[side].getNextPulseTime();
+                if (next) {
+                    nextPulseTime = std::min(nextPulseTime.value_or(next.value()), next.value());
+                }
+            }
+
+            // Sleep until the next pulse or the next command.
+            if (nextPulseTime && timer) {
+                LARGE_INTEGER dueTime;
+                dueTime.QuadPart = -std::max((int64_t)((nextPulseTime.value() - now) * 1e7), 1ll);
+                if (SetWaitableTimer(timer.get(), &dueTime, 0, nullptr, nullptr, FALSE)) {
+                    const HANDLE handles[] = {m_hapticsEvent.get(), timer.get()};
+                    WaitForMultipleObjects(ARRAYSIZE(handles), handles, FALSE, INFINITE);
+                    continue;
+                }
+            }
+            m_hapticsEvent.wait(nextPulseTime ? 1 : INFINITE);
+        }
+
+        TraceLoggingWrite(g_traceProvider, "HapticsThread_Stop");
+    }
+
+} // namespace pimax_openxr
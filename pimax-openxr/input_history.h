@@ -0,0 +1,189 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Timestamped input history, filled by the input sampler thread and drained by xrSyncActions().
+
+namespace pimax_openxr::input_history {
+
+    // A single-producer, single-consumer ring of samples. The producer never blocks: when the consumer falls behind by
+    // more than the capacity, the oldest samples are overwritten and reported as lost.
+    // Each slot is a seqlock. The sample is stored as atomic words, so that a consumer reading a slot while the
+    // producer overwrites it gets a torn copy (discarded thanks to the tag) rather than a data race.
+    template <typename T, size_t Capacity>
+    class SampleRing {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+        static_assert(std::is_trivially_copyable_v<T>, "Samples must be trivially copyable");
+
+      public:
+        // Producer side.
+        void push(const T& sample) {
+            const uint64_t sequence = m_writeSequence.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[sequence % Capacity];
+
+            // An odd tag marks the slot as being written. Release stores keep each word from becoming visible before
+            // the odd tag.
+            slot.tag.store(sequence * 2 + 1, std::memory_order_relaxed);
+            std::array<uint64_t, WordCount> words{};
+            memcpy(words.data(), &sample, sizeof(T));
+            for (size_t i = 0; i < WordCount; i++) {
+                slot.words[i].store(words[i], std::memory_order_release);
+            }
+            slot.tag.store(sequence * 2 + 2, std::memory_order_release);
+
+            m_writeSequence.store(sequence + 1, std::memory_order_release);
+        }
+
+        // Consumer side. Visit the samples pushed since `sequence`, oldest first, and return the sequence to resume
+        // from on the next call.
+        template <typename Visitor>
+        uint64_t read(uint64_t sequence, Visitor&& visitor, uint64_t& lostCount) const {
+            const uint64_t end = m_writeSequence.load(std::memory_order_acquire);
+            if (end - sequence > Capacity) {
+                lostCount += end - Capacity - sequence;
+                sequence = end - Capacity;
+            }
+
+            for (; sequence < end; sequence++) {
+                T value;
+                if (!get(sequence, value)) {
+                    lostCount++;
+                    continue;
+                }
+
+                visitor(value);
+            }
+
+            return end;
+        }
+
+        // Consumer side. Read the sample at `sequence`, if it was written and not overwritten yet. This does not modify
+        // the ring, so several consumers may call it concurrently.
+        bool get(uint64_t sequence, T& value) const {
+            const Slot& slot = m_slots[sequence % Capacity];
+            const uint64_t tag = sequence * 2 + 2;
+            if (slot.tag.load(std::memory_order_acquire) != tag) {
+                return false;
+            }
+
+            // Acquire loads keep the tag check below from happening before the copy.
+            std::array<uint64_t, WordCount> words;
+            for (size_t i = 0; i < WordCount; i++) {
+                words[i] = slot.words[i].load(std::memory_order_acquire);
+            }
+
+            // The producer may have lapped us during the copy.
+            if (slot.tag.load(std::memory_order_relaxed) != tag) {
+                return false;
+            }
+
+            memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+            return true;
+        }
+
+        uint64_t getWriteSequence() const {
+            return m_writeSequence.load(std::memory_order_acquire);
+        }
+
+      private:
+        static constexpr size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        struct Slot {
+            std::atomic<uint64_t> tag{0};
+            std::array<std::atomic<uint64_t>, WordCount> words{};
+        };
+
+        std::array<Slot, Capacity> m_slots;
+        std::atomic<uint64_t> m_writeSequence{0};
+    };
+
+    // Tracks the edges of up to 32 digital inputs (a button bitmask) between two syncs.
+    class BitChannel {
+      public:
+        static constexpr uint32_t BitCount = 32;
+
+        void reset(uint32_t value = 0, double time = 0.0) {
+            m_current = m_latched = value;
+            m_rising = 0;
+            m_riseTime.fill(time);
+            m_fallTime.fill(time);
+            m_changeTime.fill(time);
+        }
+
+        void observe(double time, uint32_t value) {
+            const uint32_t changed = value ^ m_current;
+            for (uint32_t i = 0; i < BitCount; i++) {
+                const uint32_t bit = 1u << i;
+                if (changed & bit) {
+                    (value & bit ? m_riseTime : m_fallTime)[i] = time;
+                }
+            }
+
+            m_rising |= changed & value;
+            m_current = value;
+        }
+
+        // Close the sync interval and return the state to report for it. An input that was pressed since the previous
+        // sync is reported as pressed, even if it was released in the meantime, so that short presses are never lost.
+        uint32_t latch() {
+            const uint32_t latched = m_current | m_rising;
+            const uint32_t changed = latched ^ m_latched;
+            for (uint32_t i = 0; i < BitCount; i++) {
+                const uint32_t bit = 1u << i;
+                if (changed & bit) {
+                    // A press reported late is released no earlier than it was reported pressed.
+                    m_changeTime[i] = std::max(latched & bit ? m_riseTime[i] : m_fallTime[i], m_changeTime[i]);
+                }
+            }
+
+            m_latched = latched;
+            m_rising = 0;
+            return m_latched;
+        }
+
+        uint32_t getLatched() const {
+            return m_latched;
+        }
+
+        // The time when the latched state of the (lowest) input in `mask` last changed.
+        double getChangeTime(uint32_t mask) const {
+            for (uint32_t i = 0; i < BitCount; i++) {
+                if (mask & (1u << i)) {
+                    return m_changeTime[i];
+                }
+            }
+            return 0.0;
+        }
+
+      private:
+        uint32_t m_current{0};
+        uint32_t m_latched{0};
+        uint32_t m_rising{0};
+        std::array<double, BitCount> m_riseTime{};
+        std::array<double, BitCount> m_fallTime{};
+        std::array<double, BitCount> m_changeTime{};
+    };
+
+} // namespace pimax_openxr::input_history
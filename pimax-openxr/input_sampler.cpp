@@ -0,0 +1,188 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the optional input sampler thread, which polls the controllers at a higher rate than the application
+// calls xrSyncActions(). This lets us report short presses that happen between two syncs, and the time at which the
+// inputs actually changed. The thread also records the history of the tracked devices poses, so that queries in the
+// recent past do not need to go to PVR.
+
+namespace {
+
+    // Whether any analog input of the controller changed between two samples.
+    bool hasAnalogInputChanged(const pvrInputState& previous, const pvrInputState& current, int side) {
+        return previous.Trigger[side] != current.Trigger[side] || previous.Grip[side] != current.Grip[side] ||
+               previous.GripForce[side] != current.GripForce[side] ||
+               previous.JoyStick[side].x != current.JoyStick[side].x ||
+               previous.JoyStick[side].y != current.JoyStick[side].y ||
+               previous.TouchPad[side].x != current.TouchPad[side].x ||
+               previous.TouchPad[side].y != current.TouchPad[side].y ||
+               previous.TouchPadForce[side] != current.TouchPadForce[side] ||
+               previous.fingerIndex[side] != current.fingerIndex[side] ||
+               previous.fingerMiddle[side] != current.fingerMiddle[side] ||
+               previous.fingerRing[side] != current.fingerRing[side] ||
+               previous.fingerPinky[side] != current.fingerPinky[side];
+    }
+
+    pimax_openxr::pose_history::Sample pvrPoseStateToSample(const pvrPoseStatef& state, double time) {
+        pimax_openxr::pose_history::Sample sample;
+        sample.time = time;
+        sample.orientation = {state.ThePose.Orientation.x,
+                              state.ThePose.Orientation.y,
+                              state.ThePose.Orientation.z,
+                              state.ThePose.Orientation.w};
+        sample.position = {state.ThePose.Position.x, state.ThePose.Position.y, state.ThePose.Position.z};
+        sample.linearVelocity = {state.LinearVelocity.x, state.LinearVelocity.y, state.LinearVelocity.z};
+        sample.angularVelocity = {state.AngularVelocity.x, state.AngularVelocity.y, state.AngularVelocity.z};
+        sample.statusFlags = state.StatusFlags;
+        return sample;
+    }
+
+} // namespace
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+
+    void OpenXrRuntime::startInputSampler() {
+        // Start from the state at the beginning of the session.
+        CHECK_PVRCMD(pvr_getInputState(m_pvrSession, &m_cachedInputState));
+        for (int side = 0; side < 2; side++) {
+            m_inputButtons[side].reset(m_cachedInputState.HandButtons[side], m_cachedInputState.TimeInSeconds);
+            m_inputTouches[side].reset(m_cachedInputState.HandTouches[side], m_cachedInputState.TimeInSeconds);
+            m_inputAnalogChangeTime[side] = m_cachedInputState.TimeInSeconds;
+        }
+        m_inputHistoryReadSequence = m_inputHistory.getWriteSequence();
+
+        m_inputSamplerExit = false;
+        m_inputSamplerThread = std::thread([&] { inputSamplerThreadMain(); });
+    }
+
+    void OpenXrRuntime::stopInputSampler() {
+        if (!m_inputSamplerThread.joinable()) {
+            return;
+        }
+
+        m_inputSamplerExit = true;
+        m_inputSamplerThread.join();
+    }
+
+    // Drain the samples collected since the previous sync into m_cachedInputState.
+    void OpenXrRuntime::latchInputHistory() {
+        pvrInputState previous = m_cachedInputState;
+        uint32_t sampleCount = 0;
+        uint64_t lostSampleCount = 0;
+        m_inputHistoryReadSequence = m_inputHistory.read(
+            m_inputHistoryReadSequence,
+            [&](const pvrInputState& sample) {
+                for (int side = 0; side < 2; side++) {
+                    m_inputButtons[side].observe(sample.TimeInSeconds, sample.HandButtons[side]);
+                    m_inputTouches[side].observe(sample.TimeInSeconds, sample.HandTouches[side]);
+                    if (hasAnalogInputChanged(previous, sample, side)) {
+                        m_inputAnalogChangeTime[side] = sample.TimeInSeconds;
+                    }
+                }
+                previous = sample;
+                sampleCount++;
+            },
+            lostSampleCount);
+
+        // The analog values are the most recent ones, while the buttons include the presses since the previous sync.
+        m_cachedInputState = previous;
+        for (int side = 0; side < 2; side++) {
+            m_cachedInputState.HandButtons[side] = m_inputButtons[side].latch();
+            m_cachedInputState.HandTouches[side] = m_inputTouches[side].latch();
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "InputHistory_Latch",
+                          TLArg(sampleCount, "SampleCount"),
+                          TLArg(lostSampleCount, "LostSampleCount"));
+    }
+
+    // The time (in PVR time) when the input behind an action source last changed.
+    double OpenXrRuntime::getInputChangeTime(const ActionSource& source, int side) const {
+        if (!m_inputSamplerThread.joinable()) {
+            // Without the sampler, we only know the state at the time of the sync.
+            return m_cachedInputState.TimeInSeconds;
+        }
+
+        if (source.buttonMap == m_cachedInputState.HandButtons) {
+            return m_inputButtons[side].getChangeTime(source.buttonType);
+        } else if (source.buttonMap == m_cachedInputState.HandTouches) {
+            return m_inputTouches[side].getChangeTime(source.buttonType);
+        }
+        return m_inputAnalogChangeTime[side];
+    }
+
+    void OpenXrRuntime::inputSamplerThreadMain() {
+        TraceLoggingWrite(g_traceProvider, "InputSampler_Start", TLArg(m_inputSamplingRate, "SamplingRate"));
+
+        // The default timer resolution is too coarse for the rates we want.
+        wil::unique_handle timer(CreateWaitableTimerExW(
+            nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, SYNCHRONIZE | TIMER_MODIFY_STATE));
+        if (!timer) {
+            timer.reset(CreateWaitableTimerW(nullptr, FALSE, nullptr));
+        }
+        LARGE_INTEGER period;
+        period.QuadPart = -(10'000'000ll / m_inputSamplingRate);
+
+        const auto samplePose = [&](auto device, double now, PoseHistory& history) {
+            pvrPoseStatef state{};
+            if (pvr_getTrackedDevicePoseState(m_pvrSession, device, now, &state) == pvr_success) {
+                history.push(pvrPoseStateToSample(state, now));
+            }
+        };
+
+        while (!m_inputSamplerExit) {
+            pvrInputState sample{};
+            const auto result = pvr_getInputState(m_pvrSession, &sample);
+            if (result == pvr_success) {
+                m_inputHistory.push(sample);
+            } else {
+                TraceLoggingWrite(g_traceProvider, "InputSampler_Error", TLArg((int)result, "Error"));
+            }
+
+            if (m_usePoseHistory) {
+                const double now = pvr_getTimeSeconds(m_pvr);
+                samplePose(pvrTrackedDevice_HMD, now, m_hmdPoseHistory);
+                samplePose(pvrTrackedDevice_LeftController, now, m_controllerPoseHistory[0]);
+                samplePose(pvrTrackedDevice_RightController, now, m_controllerPoseHistory[1]);
+            }
+
+            if (timer && SetWaitableTimer(timer.get(), &period, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(timer.get(), INFINITE);
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(1'000'000 / m_inputSamplingRate));
+            }
+        }
+
+        TraceLoggingWrite(g_traceProvider, "InputSampler_Stop");
+    }
+
+} // namespace pimax_openxr
@@ -104,7 +104,9 @@ namespace pimax_openxr {
     using namespace pimax_openxr::utils;
     using namespace pimax_openxr::log;
 
-    // COMPLIANCE: We do not handle multithreading properly. All functions must be thread-safe.
+    // COMPLIANCE: We do not handle multithreading properly. All functions must be thread-safe. Only the action state
+    // queries (validated and served from the action snapshot) and the event queue are safe to call concurrently with
+    // the other functions today.
 
     OpenXrRuntime::OpenXrRuntime() {
         if (getSetting("enable_telemetry").value_or(1)) {
@@ -117,9 +119,14 @@ namespace pimax_openxr {
         m_telemetry.logVersion(runtimeVersion);
 
         m_useFrameTimingOverride = getSetting("use_frame_timing_override").value_or(1);
+
+        const auto pvrInitBegin = startup_timeline::Clock::now();
+
         if (m_useFrameTimingOverride) {
             // Detour hack: during initialization of the PVR client, we pretend to be "vrserver" (the SteamVR core
-            // process) in order to remove PVR frame timing constraints.
+            // process) in order to remove PVR frame timing constraints. The hook patches GetModuleFileNameA() for the
+            // whole process, so this must not overlap with the application's threads: it is done synchronously here,
+            // before the application gets the instance.
             DetourDllAttach(
                 "kernel32.dll", "GetModuleFileNameA", hooked_GetModuleFileNameA, g_original_GetModuleFileNameA);
         }
@@ -131,32 +138,13 @@ namespace pimax_openxr {
                 "kernel32.dll", "GetModuleFileNameA", hooked_GetModuleFileNameA, g_original_GetModuleFileNameA);
         }
 
-        std::string_view versionString(pvr_getVersionString(m_pvr));
-        Log("PVR: %s\n", versionString.data());
-        TraceLoggingWrite(g_traceProvider, "PVR_SDK", TLArg(versionString.data(), "VersionString"));
-
-        // Create the PVR session. Failing here is not considered fatal. We will try to initialize again during
-        // xrGetSystem(). This is to allow the application to create the instance and query its properties even if
-        // pi_server is not available.
-        if (pvr_createSession(m_pvr, &m_pvrSession) == pvr_success) {
-            if (pvr_getEyeHiddenAreaMesh(m_pvrSession, pvrEye_Left, nullptr, 0) == 0) {
-                Log("Hidden area mesh is not enabled\n");
-            }
-        }
+        // Bring up the rest of PVR in the background while the application creates its instance and initializes
+        // itself. Only the calls needing PVR wait for it, see waitForPvr().
+        m_pvrReady.start([this, pvrInitBegin]() { initializePvr(pvrInitBegin); });
 
+        // The timestamp conversion is calibrated on first use, see calibrateTimeConversion().
         QueryPerformanceFrequency(&m_qpcFrequency);
 
-        // Calibrate the timestamp conversion.
-        m_pvrTimeFromQpcTimeOffset = INFINITY;
-        for (int i = 0; i < 100; i++) {
-            LARGE_INTEGER now;
-            QueryPerformanceCounter(&now);
-            const double qpcTime = (double)now.QuadPart / m_qpcFrequency.QuadPart;
-            m_pvrTimeFromQpcTimeOffset = std::min(m_pvrTimeFromQpcTimeOffset, pvr_getTimeSeconds(m_pvr) - qpcTime);
-        }
-        TraceLoggingWrite(
-            g_traceProvider, "ConvertTime", TLArg(m_pvrTimeFromQpcTimeOffset, "PvrTimeFromQpcTimeOffset"));
-
         // Watch for changes in the registry.
         try {
             m_registryWatcher =
@@ -173,14 +161,60 @@ namespace pimax_openxr {
     }
 
     OpenXrRuntime::~OpenXrRuntime() {
+        try {
+            waitForPvr();
+        } catch (std::exception&) {
+            // The failure was already reported to the application.
+        }
+
         if (m_sessionCreated) {
             xrDestroySession((XrSession)1);
         }
 
+        // The resources kept for a next session that will not come.
+        if (m_keptD3D11Device) {
+            releaseD3D11DeviceResources();
+        }
+
         if (m_pvrSession) {
             pvr_destroySession(m_pvrSession);
         }
-        pvr_shutdown(m_pvr);
+        if (m_pvr) {
+            pvr_shutdown(m_pvr);
+        }
+    }
+
+    // Runs on a background thread, started by the constructor once pvr_initialise() succeeded.
+    void OpenXrRuntime::initializePvr(startup_timeline::Clock::time_point pvrInitBegin) {
+        std::string_view versionString(pvr_getVersionString(m_pvr));
+        Log("PVR: %s\n", versionString.data());
+        TraceLoggingWrite(g_traceProvider, "PVR_SDK", TLArg(versionString.data(), "VersionString"));
+
+        // Create the PVR session. Failing here is not considered fatal. We will try to initialize again during
+        // xrGetSystem(). This is to allow the application to create the instance and query its properties even if
+        // pi_server is not available.
+        if (pvr_createSession(m_pvr, &m_pvrSession) == pvr_success) {
+            if (pvr_getEyeHiddenAreaMesh(m_pvrSession, pvrEye_Left, nullptr, 0) == 0) {
+                Log("Hidden area mesh is not enabled\n");
+            }
+        }
+
+        startupTimeline.record("pvr_init", pvrInitBegin);
+    }
+
+    // Wait for the background initialization of PVR. A failure to initialize PVR is rethrown here.
+    void OpenXrRuntime::waitForPvr() {
+        if (m_pvrReady.isReady()) {
+            m_pvrReady.wait();
+            return;
+        }
+
+        TraceLocalActivity(waitPvr);
+        TraceLoggingWriteStart(waitPvr, "WaitForPvr");
+        const auto waitBegin = startup_timeline::Clock::now();
+        m_pvrReady.wait();
+        startupTimeline.record("pvr_wait", waitBegin);
+        TraceLoggingWriteStop(waitPvr, "WaitForPvr");
     }
 
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetInstanceProcAddr
@@ -240,6 +274,8 @@ namespace pimax_openxr {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
+        const auto startupBegin = startup_timeline::Clock::now();
+
         TraceLoggingWrite(g_traceProvider,
                           "xrCreateInstance",
                           TLArg(xr::ToString(createInfo->applicationInfo.apiVersion).c_str(), "ApiVersion"),
@@ -280,6 +316,11 @@ namespace pimax_openxr {
             }
 
             registerInstanceExtension(std::string(extensionName));
+
+            // Our vendor extensions are not known to the dispatch code generator.
+            if (extensionName == XR_PIMAX_DYNAMIC_RESOLUTION_EXTENSION_NAME) {
+                m_isDynamicResolutionRequested = true;
+            }
         }
 
         m_instanceCreated = true;
@@ -287,6 +328,8 @@ namespace pimax_openxr {
 
         TraceLoggingWrite(g_traceProvider, "xrCreateInstance", TLXArg(*instance, "Instance"));
 
+        startupTimeline.record("instance", startupBegin);
+
         return XR_SUCCESS;
     }
 
@@ -339,51 +382,88 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        // Generate session events.
-        if (m_sessionStateDirty) {
-            XrEventDataSessionStateChanged* const buffer = reinterpret_cast<XrEventDataSessionStateChanged*>(eventData);
-            buffer->type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
+        // Report the events we had to drop before any other event.
+        const uint32_t lostEventCount = m_eventQueue.takeLostCount();
+        if (lostEventCount) {
+            XrEventDataEventsLost* const buffer = reinterpret_cast<XrEventDataEventsLost*>(eventData);
+            buffer->type = XR_TYPE_EVENT_DATA_EVENTS_LOST;
             buffer->next = nullptr;
-            buffer->session = (XrSession)1;
-            buffer->state = m_sessionState;
-            buffer->time = pvrTimeToXrTime(m_sessionStateEventTime);
+            buffer->lostEventCount = lostEventCount;
 
             TraceLoggingWrite(g_traceProvider,
                               "xrPollEvent",
-                              TLArg("SessionStateChanged", "Type"),
-                              TLXArg(buffer->session, "Session"),
-                              TLArg(xr::ToCString(buffer->state), "State"),
-                              TLArg(buffer->time, "Time"));
-
-            m_sessionStateDirty = false;
-
-            if (m_sessionState == XR_SESSION_STATE_IDLE) {
-                m_sessionState = !m_sessionExiting ? XR_SESSION_STATE_READY : XR_SESSION_STATE_EXITING;
-                m_sessionStateDirty = true;
-                m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
-            }
+                              TLArg("EventsLost", "Type"),
+                              TLArg(buffer->lostEventCount, "LostEventCount"));
 
             return XR_SUCCESS;
         }
 
-        if (m_currentInteractionProfileDirty) {
-            XrEventDataInteractionProfileChanged* const buffer =
-                reinterpret_cast<XrEventDataInteractionProfileChanged*>(eventData);
-            buffer->type = XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED;
-            buffer->next = nullptr;
-            buffer->session = (XrSession)1;
+        Event event;
+        if (!m_eventQueue.pop(event)) {
+            return XR_EVENT_UNAVAILABLE;
+        }
+
+        static_assert(sizeof(Event) <= sizeof(XrEventDataBuffer));
+        memcpy(eventData, &event, sizeof(event));
+
+        switch (event.header.type) {
+        case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED:
+            TraceLoggingWrite(g_traceProvider,
+                              "xrPollEvent",
+                              TLArg("SessionStateChanged", "Type"),
+                              TLXArg(event.sessionStateChanged.session, "Session"),
+                              TLArg(xr::ToCString(event.sessionStateChanged.state), "State"),
+                              TLArg(event.sessionStateChanged.time, "Time"));
+            break;
 
+        case XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED:
             TraceLoggingWrite(g_traceProvider,
                               "xrPollEvent",
                               TLArg("InteractionProfileChanged", "Type"),
-                              TLXArg(buffer->session, "Session"));
+                              TLXArg(event.interactionProfileChanged.session, "Session"));
+            break;
 
-            m_currentInteractionProfileDirty = false;
+        case XR_TYPE_EVENT_DATA_REFERENCE_SPACE_CHANGE_PENDING:
+            TraceLoggingWrite(g_traceProvider,
+                              "xrPollEvent",
+                              TLArg("ReferenceSpaceChangePending", "Type"),
+                              TLXArg(event.referenceSpaceChangePending.session, "Session"),
+                              TLArg(xr::ToCString(event.referenceSpaceChangePending.referenceSpaceType),
+                                    "ReferenceSpaceType"),
+                              TLArg(event.referenceSpaceChangePending.changeTime, "ChangeTime"));
+            break;
+
+        case XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB:
+            TraceLoggingWrite(g_traceProvider,
+                              "xrPollEvent",
+                              TLArg("DisplayRefreshRateChanged", "Type"),
+                              TLArg(event.displayRefreshRateChanged.fromDisplayRefreshRate, "FromDisplayRefreshRate"),
+                              TLArg(event.displayRefreshRateChanged.toDisplayRefreshRate, "ToDisplayRefreshRate"));
+            break;
 
-            return XR_SUCCESS;
+        case XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT:
+            TraceLoggingWrite(g_traceProvider,
+                              "xrPollEvent",
+                              TLArg("PerfSettings", "Type"),
+                              TLArg((int)event.perfSettings.domain, "Domain"),
+                              TLArg((int)event.perfSettings.subDomain, "SubDomain"),
+                              TLArg((int)event.perfSettings.fromLevel, "FromLevel"),
+                              TLArg((int)event.perfSettings.toLevel, "ToLevel"));
+            break;
+
+        default:
+            break;
         }
 
-        return XR_EVENT_UNAVAILABLE;
+        return XR_SUCCESS;
+    }
+
+    // Post an event for xrPollEvent(). This can be called from any thread. Session state changes use the reserved part
+    // of the queue, so other events cannot crowd them out.
+    void OpenXrRuntime::queueEvent(const Event& event) {
+        if (!m_eventQueue.push(event, event.header.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED)) {
+            TraceLoggingWrite(g_traceProvider, "EventQueue_Full", TLArg(xr::ToCString(event.header.type), "Type"));
+        }
     }
 
     // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrResultToString
@@ -422,6 +502,7 @@ namespace pimax_openxr {
 
         switch ((int)value) {
             XR_LIST_ENUM_XrStructureType(EMIT_STRUCTURE_TYPE_STRING);
+            EMIT_STRUCTURE_TYPE_STRING(XR_TYPE_VIEW_RENDER_SCALE_PIMAX, 0);
 
         default:
             sprintf_s(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_UNKNOWN_STRUCTURE_TYPE_%d", (int)value);
@@ -456,9 +537,30 @@ namespace pimax_openxr {
         m_extensionsTable.push_back( // Hidden area mesh.
             {XR_KHR_VISIBILITY_MASK_EXTENSION_NAME, XR_KHR_visibility_mask_SPEC_VERSION});
 
-        m_extensionsTable.push_back( // Mock display refresh rate.
+        m_extensionsTable.push_back( // Display refresh rate.
             {XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME, XR_FB_display_refresh_rate_SPEC_VERSION});
 
+        m_extensionsTable.push_back( // Eye tracking.
+            {XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME, XR_EXT_eye_gaze_interaction_SPEC_VERSION});
+
+        m_extensionsTable.push_back( // Quad views.
+            {XR_VARJO_QUAD_VIEWS_EXTENSION_NAME, XR_VARJO_quad_views_SPEC_VERSION});
+        m_extensionsTable.push_back( // Foveated rendering.
+            {XR_VARJO_FOVEATED_RENDERING_EXTENSION_NAME, XR_VARJO_foveated_rendering_SPEC_VERSION});
+
+        m_extensionsTable.push_back( // Performance settings.
+            {XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME, XR_EXT_performance_settings_SPEC_VERSION});
+
+        m_extensionsTable.push_back( // Performance metrics.
+            {XR_META_PERFORMANCE_METRICS_EXTENSION_NAME, XR_META_performance_metrics_SPEC_VERSION});
+
+        // Our dynamic resolution extension is not registered with Khronos, and its structure type could collide with
+        // a future registered extension. Only advertise it to the users who opt in.
+        if (getSetting("enable_pimax_dynamic_resolution").value_or(0)) {
+            m_extensionsTable.push_back( // Dynamic resolution.
+                {XR_PIMAX_DYNAMIC_RESOLUTION_EXTENSION_NAME, XR_PIMAX_dynamic_resolution_SPEC_VERSION});
+        }
+
         // FIXME: Add new extensions here.
     }
 
@@ -125,23 +125,7 @@ namespace pimax_openxr {
         }
 
         // Create the interop device that PVR will be using.
-        ComPtr<ID3D11Device> device;
-        ComPtr<ID3D11DeviceContext> deviceContext;
-        D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
-        UINT flags = 0;
-#ifdef _DEBUG
-        flags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-        CHECK_HRCMD(D3D11CreateDevice(dxgiAdapter.Get(),
-                                      D3D_DRIVER_TYPE_UNKNOWN,
-                                      0,
-                                      flags,
-                                      &featureLevel,
-                                      1,
-                                      D3D11_SDK_VERSION,
-                                      device.ReleaseAndGetAddressOf(),
-                                      nullptr,
-                                      deviceContext.ReleaseAndGetAddressOf()));
+        const ComPtr<ID3D11Device> device = createInteropD3D11Device(dxgiAdapter.Get());
 
         ComPtr<ID3D11Device5> device5;
         CHECK_HRCMD(device->QueryInterface(m_d3d11Device.ReleaseAndGetAddressOf()));
@@ -328,6 +312,19 @@ namespace pimax_openxr {
         glFinish();
     }
 
+    // Make the D3D11 context wait for the commands submitted so far on the OpenGL context, without blocking the CPU.
+    void OpenXrRuntime::serializeOpenGLWork() {
+        GlContextSwitch context(m_glContext);
+
+        m_fenceValue++;
+        TraceLoggingWrite(g_traceProvider, "SerializeWork", TLArg("OpenGL", "Api"), TLArg(m_fenceValue, "FenceValue"));
+        m_glDispatch.glSemaphoreParameterui64vEXT(m_glSemaphore, GL_D3D12_FENCE_VALUE_EXT, &m_fenceValue);
+        m_glDispatch.glSignalSemaphoreEXT(m_glSemaphore, 0, nullptr, 0, nullptr, nullptr);
+        glFlush();
+
+        CHECK_HRCMD(m_d3d11DeviceContext->Wait(m_d3d11Fence.Get(), m_fenceValue));
+    }
+
     // Serialize commands from the OpenGL context to the D3D11 context used by PVR.
     void OpenXrRuntime::serializeOpenGLFrame() {
         GlContextSwitch context(m_glContext);
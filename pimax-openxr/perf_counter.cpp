@@ -51,6 +51,8 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
+        calibrateTimeConversion();
+
         double pvrTime = (double)performanceCounter->QuadPart / m_qpcFrequency.QuadPart;
         pvrTime += m_pvrTimeFromQpcTimeOffset;
 
@@ -78,6 +80,8 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
+        calibrateTimeConversion();
+
         double pvrTime = xrTimeToPvrTime(time);
         pvrTime -= m_pvrTimeFromQpcTimeOffset;
 
@@ -90,4 +94,22 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // Measure the offset between the PVR and QPC clocks. Only the applications using the conversion pay for it.
+    void OpenXrRuntime::calibrateTimeConversion() {
+        std::call_once(m_timeConversionCalibrated, [&]() {
+            waitForPvr();
+
+            m_pvrTimeFromQpcTimeOffset = INFINITY;
+            for (int i = 0; i < 100; i++) {
+                LARGE_INTEGER now;
+                QueryPerformanceCounter(&now);
+                const double qpcTime = (double)now.QuadPart / m_qpcFrequency.QuadPart;
+                m_pvrTimeFromQpcTimeOffset =
+                    std::min(m_pvrTimeFromQpcTimeOffset, pvr_getTimeSeconds(m_pvr) - qpcTime);
+            }
+            TraceLoggingWrite(
+                g_traceProvider, "ConvertTime", TLArg(m_pvrTimeFromQpcTimeOffset, "PvrTimeFromQpcTimeOffset"));
+        });
+    }
+
 } // namespace pimax_openxr
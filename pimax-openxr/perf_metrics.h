@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The counters behind the XR_META_performance_metrics extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_META_performance_metrics
+
+namespace pimax_openxr::perf_metrics {
+
+    // The statistics block is written by the frame loop and read by xrQueryPerformanceMetricsCounterMETA() from any
+    // thread. Each value is an independent atomic, so that a reader never needs to take the frame lock. A reader may
+    // observe values from two consecutive frames, which is acceptable for these counters.
+    struct Stats {
+        std::atomic<float> appCpuFrameTimeMs{0.f};
+        std::atomic<float> appGpuFrameTimeMs{0.f};
+        std::atomic<float> precompositionTimeMs{0.f};
+        std::atomic<float> compositorFps{0.f};
+        std::atomic<float> pacingErrorMs{0.f};
+        std::atomic<uint32_t> droppedFrameCount{0};
+
+        void reset() {
+            appCpuFrameTimeMs = appGpuFrameTimeMs = precompositionTimeMs = compositorFps = pacingErrorMs = 0.f;
+            droppedFrameCount = 0;
+        }
+    };
+
+    struct CounterDefinition {
+        const char* path;
+        XrPerformanceMetricsCounterUnitMETA unit;
+
+        // Exactly one of the two is set.
+        std::atomic<float> Stats::*floatValue;
+        std::atomic<uint32_t> Stats::*uintValue;
+    };
+
+    // The counters in the /perfmetrics_meta namespace follow the semantics of the specification. The other ones are
+    // specific to this runtime.
+    inline const CounterDefinition Counters[] = {
+        {"/perfmetrics_meta/app/cpu_frametime",
+         XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+         &Stats::appCpuFrameTimeMs,
+         nullptr},
+        {"/perfmetrics_meta/app/gpu_frametime",
+         XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+         &Stats::appGpuFrameTimeMs,
+         nullptr},
+        {"/perfmetrics_meta/compositor/dropped_frame_count",
+         XR_PERFORMANCE_METRICS_COUNTER_UNIT_GENERIC_META,
+         nullptr,
+         &Stats::droppedFrameCount},
+        {"/perfmetrics_pimax/runtime/precomposition_gpu_frametime",
+         XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+         &Stats::precompositionTimeMs,
+         nullptr},
+        {"/perfmetrics_pimax/compositor/fps",
+         XR_PERFORMANCE_METRICS_COUNTER_UNIT_HERTZ_META,
+         &Stats::compositorFps,
+         nullptr},
+        {"/perfmetrics_pimax/app/pacing_error",
+         XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+         &Stats::pacingErrorMs,
+         nullptr},
+    };
+
+    static inline const CounterDefinition* findCounter(std::string_view path) {
+        for (const auto& definition : Counters) {
+            if (path == definition.path) {
+                return &definition;
+            }
+        }
+        return nullptr;
+    }
+
+    static inline void readCounter(const Stats& stats,
+                                   const CounterDefinition& definition,
+                                   XrPerformanceMetricsCounterMETA& counter) {
+        counter.counterUnit = definition.unit;
+        counter.counterFlags = XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META;
+        counter.uintValue = 0;
+        counter.floatValue = 0.f;
+        if (definition.floatValue) {
+            counter.counterFlags |= XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META;
+            counter.floatValue = (stats.*definition.floatValue).load(std::memory_order_relaxed);
+        } else {
+            counter.counterFlags |= XR_PERFORMANCE_METRICS_COUNTER_UINT_VALUE_VALID_BIT_META;
+            counter.uintValue = (stats.*definition.uintValue).load(std::memory_order_relaxed);
+        }
+    }
+
+    // Measures the frame pacing from the times at which the application submits its frames.
+    class PacingTracker {
+      public:
+        void reset() {
+            m_lastSubmitTime.reset();
+            m_droppedFrameTimes.clear();
+        }
+
+        // Record a frame submission. frameInterval is the expected time between two frames, accounting for any
+        // frame rate division such as Smart Smoothing.
+        void update(Stats& stats, double now, double frameInterval) {
+            if (m_lastSubmitTime && frameInterval > 0.0) {
+                const double interval = now - m_lastSubmitTime.value();
+
+                // Long pauses (eg: the application stopped rendering while not focused) are not pacing issues.
+                if (interval < 1.0) {
+                    stats.pacingErrorMs.store((float)(std::abs(interval - frameInterval) * 1e3),
+                                              std::memory_order_relaxed);
+
+                    // Every display slot that went by without a new frame was a dropped frame. We allow half a frame
+                    // of jitter, since the submission time is only an approximation of the display slot.
+                    const auto missedSlots = (int)std::floor(interval / frameInterval + 0.5) - 1;
+                    for (int i = 0; i < missedSlots; i++) {
+                        m_droppedFrameTimes.push_back(now);
+                    }
+                }
+            }
+            m_lastSubmitTime = now;
+
+            // Report the dropped frames over the last second.
+            while (!m_droppedFrameTimes.empty() && now - m_droppedFrameTimes.front() >= 1.0) {
+                m_droppedFrameTimes.pop_front();
+            }
+            stats.droppedFrameCount.store((uint32_t)m_droppedFrameTimes.size(), std::memory_order_relaxed);
+        }
+
+      private:
+        std::optional<double> m_lastSubmitTime;
+        std::deque<double> m_droppedFrameTimes;
+    };
+
+} // namespace pimax_openxr::perf_metrics
@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The policies behind the XR_EXT_performance_settings extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_EXT_performance_settings
+
+namespace pimax_openxr::perf_settings {
+
+    // pi_server engages Smart Smoothing when the render time hinted via openvr_client_render_ms exceeds the frame
+    // duration. We bias the hint to make smoothing engage earlier or later based on the level requested for the GPU.
+    static inline double adjustClientRenderTime(double renderMs, double frameDurationMs, XrPerfSettingsLevelEXT level) {
+        switch (level) {
+        case XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT:
+            // Always run with smoothing.
+            return std::max(renderMs, frameDurationMs * 1.05);
+        case XR_PERF_SETTINGS_LEVEL_SUSTAINED_LOW_EXT:
+            return renderMs + frameDurationMs * 0.1;
+        case XR_PERF_SETTINGS_LEVEL_BOOST_EXT:
+            return std::max(0.0, renderMs - frameDurationMs * 0.1);
+        default:
+            return renderMs;
+        }
+    }
+
+    // Tracks the notification level for one domain, based on the measured frame time versus the frame budget.
+    class NotificationTracker {
+      public:
+        // Returns the new notification level whenever it changes.
+        std::optional<XrPerfSettingsNotificationLevelEXT> update(double frameTimeUs, double frameBudgetUs) {
+            // The timers are not ready for the first few frames.
+            if (frameTimeUs <= 0.0 || frameBudgetUs <= 0.0) {
+                return {};
+            }
+
+            const double load = frameTimeUs / frameBudgetUs;
+            m_filteredLoad = m_hasLoad ? m_filteredLoad + Smoothing * (load - m_filteredLoad) : load;
+            m_hasLoad = true;
+
+            // Require the new level to persist for a few frames before notifying the application.
+            const XrPerfSettingsNotificationLevelEXT level = classify(m_filteredLoad);
+            if (level == m_level) {
+                m_candidateFrames = 0;
+                return {};
+            }
+            if (level != m_candidateLevel) {
+                m_candidateLevel = level;
+                m_candidateFrames = 0;
+            }
+            if (++m_candidateFrames < PersistenceFrames) {
+                return {};
+            }
+
+            m_level = level;
+            m_candidateFrames = 0;
+
+            return m_level;
+        }
+
+        XrPerfSettingsNotificationLevelEXT getLevel() const {
+            return m_level;
+        }
+
+      private:
+        // Thresholds as a fraction of the frame budget. Leaving a level requires going below its threshold by a margin.
+        static constexpr double WarningThreshold = 0.85;
+        static constexpr double ImpairedThreshold = 1.0;
+        static constexpr double Hysteresis = 0.05;
+
+        static constexpr double Smoothing = 0.1;
+        static constexpr uint32_t PersistenceFrames = 5;
+
+        XrPerfSettingsNotificationLevelEXT classify(double load) const {
+            const double warningThreshold =
+                m_level != XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT ? WarningThreshold - Hysteresis : WarningThreshold;
+            const double impairedThreshold = m_level == XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT
+                                                     ? ImpairedThreshold - Hysteresis
+                                                     : ImpairedThreshold;
+
+            if (load >= impairedThreshold) {
+                return XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT;
+            } else if (load >= warningThreshold) {
+                return XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT;
+            }
+            return XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT;
+        }
+
+        XrPerfSettingsNotificationLevelEXT m_level{XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT};
+        XrPerfSettingsNotificationLevelEXT m_candidateLevel{XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT};
+        uint32_t m_candidateFrames{0};
+        double m_filteredLoad{0.0};
+        bool m_hasLoad{false};
+    };
+
+} // namespace pimax_openxr::perf_settings
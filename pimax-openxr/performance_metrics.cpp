@@ -0,0 +1,185 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the XR_META_performance_metrics extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_META_performance_metrics
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrEnumeratePerformanceMetricsCounterPathsMETA
+    XrResult OpenXrRuntime::xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance,
+                                                                          uint32_t counterPathCapacityInput,
+                                                                          uint32_t* counterPathCountOutput,
+                                                                          XrPath* counterPaths) {
+        TraceLoggingWrite(g_traceProvider,
+                          "xrEnumeratePerformanceMetricsCounterPathsMETA",
+                          TLXArg(instance, "Instance"),
+                          TLArg(counterPathCapacityInput, "CounterPathCapacityInput"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_instanceCreated || instance != (XrInstance)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        const uint32_t count = (uint32_t)std::size(perf_metrics::Counters);
+        if (counterPathCapacityInput && counterPathCapacityInput < count) {
+            return XR_ERROR_SIZE_INSUFFICIENT;
+        }
+
+        *counterPathCountOutput = count;
+        TraceLoggingWrite(g_traceProvider,
+                          "xrEnumeratePerformanceMetricsCounterPathsMETA",
+                          TLArg(*counterPathCountOutput, "CounterPathCountOutput"));
+
+        if (counterPathCapacityInput && counterPaths) {
+            for (uint32_t i = 0; i < *counterPathCountOutput; i++) {
+                CHECK_XRCMD(xrStringToPath(XR_NULL_HANDLE, perf_metrics::Counters[i].path, &counterPaths[i]));
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrEnumeratePerformanceMetricsCounterPathsMETA",
+                                  TLArg(perf_metrics::Counters[i].path, "CounterPath"));
+            }
+        }
+
+        return XR_SUCCESS;
+    }
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrSetPerformanceMetricsStateMETA
+    XrResult OpenXrRuntime::xrSetPerformanceMetricsStateMETA(XrSession session,
+                                                             const XrPerformanceMetricsStateMETA* state) {
+        if (state->type != XR_TYPE_PERFORMANCE_METRICS_STATE_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrSetPerformanceMetricsStateMETA",
+                          TLXArg(session, "Session"),
+                          TLArg(!!state->enabled, "Enabled"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        // Start from a clean slate, so that the counters never report values measured before this point.
+        if (state->enabled && !m_isPerformanceMetricsEnabled) {
+            m_performanceMetrics.reset();
+        }
+        m_isPerformanceMetricsEnabled = state->enabled;
+
+        LOG_TELEMETRY_ONCE(logFeature("PerformanceMetrics"));
+
+        return XR_SUCCESS;
+    }
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrGetPerformanceMetricsStateMETA
+    XrResult OpenXrRuntime::xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) {
+        if (state->type != XR_TYPE_PERFORMANCE_METRICS_STATE_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider, "xrGetPerformanceMetricsStateMETA", TLXArg(session, "Session"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        state->enabled = m_isPerformanceMetricsEnabled ? XR_TRUE : XR_FALSE;
+
+        TraceLoggingWrite(g_traceProvider, "xrGetPerformanceMetricsStateMETA", TLArg(!!state->enabled, "Enabled"));
+
+        return XR_SUCCESS;
+    }
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrQueryPerformanceMetricsCounterMETA
+    XrResult OpenXrRuntime::xrQueryPerformanceMetricsCounterMETA(XrSession session,
+                                                                 XrPath counterPath,
+                                                                 XrPerformanceMetricsCounterMETA* counter) {
+        if (counter->type != XR_TYPE_PERFORMANCE_METRICS_COUNTER_META) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrQueryPerformanceMetricsCounterMETA",
+                          TLXArg(session, "Session"),
+                          TLArg(getXrPath(counterPath).c_str(), "CounterPath"));
+
+        if (!has_XR_META_performance_metrics) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        if (!m_isPerformanceMetricsEnabled) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        const auto definition = perf_metrics::findCounter(getXrPath(counterPath));
+        if (!definition) {
+            return XR_ERROR_PATH_UNSUPPORTED;
+        }
+
+        // This does not take the frame lock: the statistics block is only made of atomics.
+        perf_metrics::readCounter(m_performanceMetrics, *definition, *counter);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "xrQueryPerformanceMetricsCounterMETA",
+                          TLArg(counter->counterFlags, "CounterFlags"),
+                          TLArg((int)counter->counterUnit, "CounterUnit"),
+                          TLArg(counter->uintValue, "UintValue"),
+                          TLArg(counter->floatValue, "FloatValue"));
+
+        return XR_SUCCESS;
+    }
+
+    // Publish the statistics of the frame being submitted. Must be called with m_frameLock held.
+    void OpenXrRuntime::updatePerformanceMetrics(double now, uint64_t precompositionTimeUs) {
+        m_performanceMetrics.precompositionTimeMs.store(precompositionTimeUs / 1e3f, std::memory_order_relaxed);
+        m_performanceMetrics.compositorFps.store(pvr_getFloatConfig(m_pvrSession, "client_fps", 0),
+                                                 std::memory_order_relaxed);
+
+        // With Smart Smoothing, the application is expected to deliver only a fraction of the frames.
+        const double frameInterval = m_frameDuration * m_compositorRateDivisor;
+        m_performanceMetricsPacing.update(m_performanceMetrics, now, frameInterval);
+    }
+
+} // namespace pimax_openxr
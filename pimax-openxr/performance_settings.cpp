@@ -0,0 +1,113 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the XR_EXT_performance_settings extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_EXT_performance_settings
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+
+    // https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#xrPerfSettingsSetPerformanceLevelEXT
+    XrResult OpenXrRuntime::xrPerfSettingsSetPerformanceLevelEXT(XrSession session,
+                                                                 XrPerfSettingsDomainEXT domain,
+                                                                 XrPerfSettingsLevelEXT level) {
+        TraceLoggingWrite(g_traceProvider,
+                          "xrPerfSettingsSetPerformanceLevelEXT",
+                          TLXArg(session, "Session"),
+                          TLArg((int)domain, "Domain"),
+                          TLArg((int)level, "Level"));
+
+        if (!has_XR_EXT_performance_settings) {
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+
+        if (!m_sessionCreated || session != (XrSession)1) {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        if (level != XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT && level != XR_PERF_SETTINGS_LEVEL_SUSTAINED_LOW_EXT &&
+            level != XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT && level != XR_PERF_SETTINGS_LEVEL_BOOST_EXT) {
+            return XR_ERROR_VALIDATION_FAILURE;
+        }
+
+        // Critical section.
+        {
+            std::unique_lock lock(m_frameLock);
+
+            // PVR does not let us control the CPU clocks, so the CPU level is only recorded. The GPU level drives the
+            // Smart Smoothing policy through the frame time hint, see perf_settings::adjustClientRenderTime().
+            if (domain == XR_PERF_SETTINGS_DOMAIN_CPU_EXT) {
+                m_perfSettingsCpuLevel = level;
+            } else if (domain == XR_PERF_SETTINGS_DOMAIN_GPU_EXT) {
+                m_perfSettingsGpuLevel = level;
+            } else {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+        }
+
+        LOG_TELEMETRY_ONCE(logFeature("PerformanceSettings"));
+
+        return XR_SUCCESS;
+    }
+
+    // Update the notification levels from the latest measurements. Must be called with m_frameLock held.
+    void OpenXrRuntime::updatePerfSettingsNotifications(uint64_t cpuFrameTimeUs, uint64_t gpuFrameTimeUs) {
+        const double frameBudgetUs = m_frameDuration * 1e6;
+
+        const auto notify = [&](XrPerfSettingsDomainEXT domain,
+                                XrPerfSettingsNotificationLevelEXT fromLevel,
+                                XrPerfSettingsNotificationLevelEXT toLevel) {
+            TraceLoggingWrite(g_traceProvider,
+                              "PerfSettings_Notification",
+                              TLArg(domain == XR_PERF_SETTINGS_DOMAIN_CPU_EXT ? "CPU" : "GPU", "Domain"),
+                              TLArg((int)fromLevel, "FromLevel"),
+                              TLArg((int)toLevel, "ToLevel"));
+
+            Event event{};
+            event.perfSettings = {XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT};
+            event.perfSettings.domain = domain;
+            event.perfSettings.subDomain = XR_PERF_SETTINGS_SUB_DOMAIN_RENDERING_EXT;
+            event.perfSettings.fromLevel = fromLevel;
+            event.perfSettings.toLevel = toLevel;
+            queueEvent(event);
+        };
+
+        const auto cpuLevel = m_perfSettingsCpuNotification.getLevel();
+        if (const auto newLevel = m_perfSettingsCpuNotification.update((double)cpuFrameTimeUs, frameBudgetUs)) {
+            notify(XR_PERF_SETTINGS_DOMAIN_CPU_EXT, cpuLevel, newLevel.value());
+        }
+
+        const auto gpuLevel = m_perfSettingsGpuNotification.getLevel();
+        if (const auto newLevel = m_perfSettingsGpuNotification.update((double)gpuFrameTimeUs, frameBudgetUs)) {
+            notify(XR_PERF_SETTINGS_DOMAIN_GPU_EXT, gpuLevel, newLevel.value());
+        }
+    }
+
+} // namespace pimax_openxr
@@ -0,0 +1,42 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Vendor extensions implemented by this runtime. These extensions are not registered with Khronos, and their
+// structure type values are picked from a range that is not allocated to any registered extension yet. They are only
+// advertised when enabled in the registry (enable_pimax_dynamic_resolution).
+
+#define XR_PIMAX_dynamic_resolution 1
+#define XR_PIMAX_dynamic_resolution_SPEC_VERSION 1
+#define XR_PIMAX_DYNAMIC_RESOLUTION_EXTENSION_NAME "XR_PIMAX_dynamic_resolution"
+
+static constexpr XrStructureType XR_TYPE_VIEW_RENDER_SCALE_PIMAX = (XrStructureType)1000999000;
+
+// May be chained to each XrView passed to xrLocateViews(). The runtime returns the scale to apply to both dimensions of
+// the recommended image rect for the view in order to hold the display refresh rate. The application is expected to
+// submit a correspondingly sized imageRect in its projection layer, without recreating its swapchains.
+typedef struct XrViewRenderScalePIMAX {
+    XrStructureType type;
+    void* XR_MAY_ALIAS next;
+    float recommendedRenderScale;
+} XrViewRenderScalePIMAX;
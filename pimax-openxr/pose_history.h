@@ -0,0 +1,176 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+#include "input_history.h"
+
+// History of the poses of a tracked device, filled by the input sampler thread. Queries for a time in the recent past
+// are answered by interpolating between the two neighboring samples.
+
+namespace pimax_openxr::pose_history {
+
+    struct Vector3 {
+        double x{0.0};
+        double y{0.0};
+        double z{0.0};
+    };
+
+    struct Quaternion {
+        double x{0.0};
+        double y{0.0};
+        double z{0.0};
+        double w{1.0};
+    };
+
+    struct Sample {
+        double time{0.0};
+        Quaternion orientation;
+        Vector3 position;
+        Vector3 linearVelocity;
+        Vector3 angularVelocity;
+        uint32_t statusFlags{0};
+    };
+
+    static inline Vector3 lerp(const Vector3& a, const Vector3& b, double u) {
+        return {a.x + (b.x - a.x) * u, a.y + (b.y - a.y) * u, a.z + (b.z - a.z) * u};
+    }
+
+    static inline Quaternion slerp(const Quaternion& a, Quaternion b, double u) {
+        // Take the shortest path.
+        double cosTheta = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+        if (cosTheta < 0.0) {
+            b = {-b.x, -b.y, -b.z, -b.w};
+            cosTheta = -cosTheta;
+        }
+
+        double wa = 1.0 - u;
+        double wb = u;
+        if (cosTheta < 0.9995) {
+            const double theta = std::acos(cosTheta);
+            const double sinTheta = std::sin(theta);
+            wa = std::sin((1.0 - u) * theta) / sinTheta;
+            wb = std::sin(u * theta) / sinTheta;
+        }
+
+        Quaternion result{wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z, wa * a.w + wb * b.w};
+        const double length =
+            std::sqrt(result.x * result.x + result.y * result.y + result.z * result.z + result.w * result.w);
+        return {result.x / length, result.y / length, result.z / length, result.w / length};
+    }
+
+    // Cubic Hermite interpolation of the position, using the velocities as tangents.
+    static inline Vector3
+    hermite(const Vector3& p0, const Vector3& v0, const Vector3& p1, const Vector3& v1, double dt, double u) {
+        const double u2 = u * u;
+        const double u3 = u2 * u;
+        const double h00 = 2 * u3 - 3 * u2 + 1;
+        const double h10 = (u3 - 2 * u2 + u) * dt;
+        const double h01 = -2 * u3 + 3 * u2;
+        const double h11 = (u3 - u2) * dt;
+        return {h00 * p0.x + h10 * v0.x + h01 * p1.x + h11 * v1.x,
+                h00 * p0.y + h10 * v0.y + h01 * p1.y + h11 * v1.y,
+                h00 * p0.z + h10 * v0.z + h01 * p1.z + h11 * v1.z};
+    }
+
+    static inline Sample interpolate(const Sample& a, const Sample& b, double time) {
+        const double dt = b.time - a.time;
+        const double u = dt > 0.0 ? std::clamp((time - a.time) / dt, 0.0, 1.0) : 0.0;
+
+        Sample result;
+        result.time = time;
+        result.orientation = slerp(a.orientation, b.orientation, u);
+        result.position = hermite(a.position, a.linearVelocity, b.position, b.linearVelocity, dt, u);
+        result.linearVelocity = lerp(a.linearVelocity, b.linearVelocity, u);
+        result.angularVelocity = lerp(a.angularVelocity, b.angularVelocity, u);
+
+        // Only report what was tracked on both ends.
+        result.statusFlags = a.statusFlags & b.statusFlags;
+        return result;
+    }
+
+    template <size_t Capacity>
+    class History {
+      public:
+        // Producer side. Samples must be pushed in increasing time order.
+        void push(const Sample& sample) {
+            m_samples.push(sample);
+        }
+
+        // Interpolate the pose at `time`. There is no result when `time` is not between the oldest and the most recent
+        // samples, or when the neighboring samples are more than `maxGap` seconds apart. The caller must then query
+        // the tracking system, which also handles the prediction into the future.
+        std::optional<Sample> sample(double time, double maxGap) const {
+            const uint64_t end = m_samples.getWriteSequence();
+            if (end < 2) {
+                return {};
+            }
+
+            // Leave one slot of margin, since the producer may be overwriting the oldest sample.
+            uint64_t lo = end > Capacity - 1 ? end - (Capacity - 1) : 0;
+            uint64_t hi = end - 1;
+
+            Sample newest;
+            if (!m_samples.get(hi, newest) || time > newest.time) {
+                return {};
+            }
+            if (time == newest.time) {
+                return newest;
+            }
+
+            // Find the last sample before the requested time.
+            Sample before;
+            bool found = false;
+            while (lo < hi) {
+                const uint64_t mid = lo + (hi - lo) / 2;
+                Sample sample;
+                if (!m_samples.get(mid, sample)) {
+                    // Overwritten in the meantime: it is older than what we can look at.
+                    lo = mid + 1;
+                    continue;
+                }
+
+                if (sample.time <= time) {
+                    before = sample;
+                    found = true;
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+
+            // Samples at lo - 1 and lo bracket the requested time.
+            Sample after;
+            if (!found || !m_samples.get(lo, after) || after.time < time || after.time - before.time > maxGap) {
+                return {};
+            }
+
+            return interpolate(before, after, time);
+        }
+
+      private:
+        input_history::SampleRing<Sample, Capacity> m_samples;
+    };
+
+} // namespace pimax_openxr::pose_history
@@ -0,0 +1,271 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "composition.h"
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the necessary support for the XR_VARJO_quad_views extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_VARJO_quad_views
+
+// Implements the necessary support for the XR_VARJO_foveated_rendering extension:
+// https://www.khronos.org/registry/OpenXR/specs/1.0/html/xrspec.html#XR_VARJO_foveated_rendering
+
+namespace {
+
+    // Full screen pass merging the focus view into the peripheral view. This must be kept in sync with
+    // composition::compositeInsetCpu().
+    const std::string_view QuadViewsShaderHlsl = R"_(
+cbuffer config : register(b0) {
+    float4 peripheralTransform;
+    float4 insetTransform;
+    float4 focusTransform;
+    float feather;
+    uint peripheralSlice;
+    uint focusSlice;
+};
+Texture2DArray peripheralTexture : register(t0);
+Texture2DArray focusTexture : register(t1);
+SamplerState linearClamp : register(s0);
+
+float4 main(float4 position : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET
+{
+    float4 color = peripheralTexture.SampleLevel(
+        linearClamp, float3(uv * peripheralTransform.xy + peripheralTransform.zw, (float)peripheralSlice), 0);
+
+    const float2 focusUv = uv * insetTransform.xy + insetTransform.zw;
+    const float edge = min(min(focusUv.x, 1 - focusUv.x), min(focusUv.y, 1 - focusUv.y));
+    const float weight = edge < 0 ? 0 : (feather > 0 ? smoothstep(0, feather, edge) : 1);
+    if (weight > 0) {
+        const float4 focusColor = focusTexture.SampleLevel(
+            linearClamp, float3(focusUv * focusTransform.xy + focusTransform.zw, (float)focusSlice), 0);
+        color = lerp(color, focusColor, weight);
+    }
+
+    return color;
+}
+    )_";
+
+    struct alignas(16) QuadViewsConstants {
+        pimax_openxr::composition::UvTransform peripheralTransform;
+        pimax_openxr::composition::UvTransform insetTransform;
+        pimax_openxr::composition::UvTransform focusTransform;
+        float feather;
+        uint32_t peripheralSlice;
+        uint32_t focusSlice;
+    };
+
+} // namespace
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+    using namespace xr::math;
+
+    bool OpenXrRuntime::isViewConfigurationSupported(XrViewConfigurationType viewConfigurationType) const {
+        return viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO ||
+               (has_XR_VARJO_quad_views && viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+    }
+
+    uint32_t OpenXrRuntime::getViewCount(XrViewConfigurationType viewConfigurationType) const {
+        return viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO ? 4 : xr::StereoView::Count;
+    }
+
+    // Place the focus view (views 2 and 3 of the quad views configuration) within the given peripheral view. With
+    // foveated rendering, the focus view is smaller and follows the eye gaze.
+    XrFovf OpenXrRuntime::getQuadViewsFocusFov(uint32_t eye,
+                                               const XrFovf& peripheralFov,
+                                               bool foveated,
+                                               XrTime time) const {
+        XrVector2f center = composition::getFovCenter(peripheralFov);
+        float size = m_quadViewsFocusSize;
+
+        if (foveated && m_isEyeTrackingAvailable) {
+            size = m_quadViewsFoveatedFocusSize;
+
+            XrQuaternionf gaze;
+            XrTime sampleTime;
+            if (getEyeGaze(time, gaze, sampleTime)) {
+                // The gaze is relative to the headset, while the FOV is relative to the (possibly canted) eye.
+                XrPosef eyeInHmd = Pose::Identity();
+                if (!m_useParallelProjection) {
+                    eyeInHmd.orientation = pvrPoseToXrPose(m_cachedEyeInfo[eye].HmdToEyePose).orientation;
+                }
+                const XrPosef gazeInEye =
+                    Pose::Multiply(Pose::MakePose(gaze, XrVector3f{0, 0, 0}), Pose::Invert(eyeInHmd));
+                const XrVector3f direction = Pose::Multiply(Pose::Translation({0, 0, -1}), gazeInEye).position;
+                if (direction.z < 0) {
+                    center = {direction.x / -direction.z, direction.y / -direction.z};
+                }
+            }
+        }
+
+        return composition::computeFocusFov(peripheralFov, size, center);
+    }
+
+    // Lazily create the resources for the composition of the quad views. Most apps never use this path.
+    void OpenXrRuntime::initializeQuadViewsResources() {
+        if (m_quadViewsPixelShader) {
+            return;
+        }
+
+        initializeCompositionResources();
+
+        const auto shaderBytes = compileShader(QuadViewsShaderHlsl, "main", "ps_5_0");
+        CHECK_HRCMD(m_d3d11Device->CreatePixelShader(shaderBytes->GetBufferPointer(),
+                                                     shaderBytes->GetBufferSize(),
+                                                     nullptr,
+                                                     m_quadViewsPixelShader.ReleaseAndGetAddressOf()));
+        setDebugName(m_quadViewsPixelShader.Get(), "QuadViews PS");
+
+        D3D11_BUFFER_DESC bufferDesc{};
+        bufferDesc.ByteWidth = sizeof(QuadViewsConstants);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        CHECK_HRCMD(
+            m_d3d11Device->CreateBuffer(&bufferDesc, nullptr, m_quadViewsConstants.ReleaseAndGetAddressOf()));
+        setDebugName(m_quadViewsConstants.Get(), "QuadViews Constants");
+
+        TraceLoggingWrite(g_traceProvider, "QuadViews_Initialize");
+    }
+
+    void OpenXrRuntime::releaseQuadViewsResources() {
+        m_quadViewsConstants.Reset();
+        m_quadViewsPixelShader.Reset();
+    }
+
+    void OpenXrRuntime::cleanupQuadViews() {
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            destroyRuntimeSwapchain(m_quadViewsSwapchain[eye]);
+        }
+    }
+
+    // Merge the focus view into the peripheral view, and return the swapchain to submit in place of the peripheral
+    // view. The returned swapchain has the dimensions of the peripheral swapchain, and the composition is written to
+    // the peripheral view's image rect. This way, changes of the image rect (eg: dynamic resolution) do not need a new
+    // swapchain.
+    const OpenXrRuntime::RuntimeSwapchain*
+    OpenXrRuntime::composeQuadViews(uint32_t eye,
+                                    const XrCompositionLayerProjectionView& peripheralView,
+                                    const XrCompositionLayerProjectionView& focusView,
+                                    std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed) {
+        Swapchain& peripheralSwapchain = *(Swapchain*)peripheralView.subImage.swapchain;
+        Swapchain& focusSwapchain = *(Swapchain*)focusView.subImage.swapchain;
+
+        const DXGI_FORMAT peripheralFormat = pvrToDxgiTextureFormat(peripheralSwapchain.pvrDesc.Format);
+        const DXGI_FORMAT focusFormat = pvrToDxgiTextureFormat(focusSwapchain.pvrDesc.Format);
+        if (peripheralFormat == DXGI_FORMAT_UNKNOWN || focusFormat == DXGI_FORMAT_UNKNOWN) {
+            LOG_TELEMETRY_ONCE(logUnimplemented("QuadViewsFormatNotSupported"));
+            return nullptr;
+        }
+
+        initializeQuadViewsResources();
+
+        // (Re)create the swapchain receiving the composited view if needed.
+        RuntimeSwapchain& output = m_quadViewsSwapchain[eye];
+        ensureRuntimeSwapchain(output,
+                               peripheralSwapchain.pvrDesc.Format,
+                               peripheralSwapchain.xrDesc.width,
+                               peripheralSwapchain.xrDesc.height,
+                               fmt::format("QuadViews[{}]", eye));
+        output.imageRect = peripheralView.subImage.imageRect;
+
+        // Multisampled swapchains are resolved before sampling.
+        ID3D11ShaderResourceView* resourceViews[] = {
+            getCompositionResourceView(peripheralSwapchain, peripheralView.subImage.imageArrayIndex),
+            getCompositionResourceView(focusSwapchain, focusView.subImage.imageArrayIndex)};
+
+        int outputIndex = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, output.pvrSwapchain, &outputIndex));
+
+        // COMPLIANCE: We assume that the focus view uses the same pose as the peripheral view, which is what
+        // xrLocateViews() returns. Only the FOV of the focus view is used for placement.
+        QuadViewsConstants constants{};
+        constants.peripheralTransform =
+            composition::computeSubImageTransform(peripheralView.subImage.imageRect,
+                                                  peripheralSwapchain.xrDesc.width,
+                                                  peripheralSwapchain.xrDesc.height);
+        constants.insetTransform = composition::computeInsetTransform(peripheralView.fov, focusView.fov);
+        constants.focusTransform = composition::computeSubImageTransform(
+            focusView.subImage.imageRect, focusSwapchain.xrDesc.width, focusSwapchain.xrDesc.height);
+        constants.feather = m_quadViewsFeather;
+        constants.peripheralSlice = peripheralView.subImage.imageArrayIndex;
+        constants.focusSlice = focusView.subImage.imageArrayIndex;
+
+        TraceLoggingWrite(g_traceProvider,
+                          "QuadViews_Compose",
+                          TLArg(eye, "Eye"),
+                          TLArg(xr::ToString(peripheralView.fov).c_str(), "PeripheralFov"),
+                          TLArg(xr::ToString(focusView.fov).c_str(), "FocusFov"),
+                          TLArg(outputIndex, "OutputIndex"));
+
+        ComPtr<ID3DDeviceContextState> appContextState;
+        m_d3d11DeviceContext->SwapDeviceContextState(m_compositionContextState.Get(),
+                                                     appContextState.ReleaseAndGetAddressOf());
+
+        m_d3d11DeviceContext->UpdateSubresource(m_quadViewsConstants.Get(), 0, nullptr, &constants, 0, 0);
+
+        m_d3d11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_d3d11DeviceContext->IASetInputLayout(nullptr);
+        m_d3d11DeviceContext->VSSetShader(m_fullScreenVertexShader.Get(), nullptr, 0);
+        m_d3d11DeviceContext->PSSetShader(m_quadViewsPixelShader.Get(), nullptr, 0);
+        m_d3d11DeviceContext->PSSetConstantBuffers(0, 1, m_quadViewsConstants.GetAddressOf());
+        m_d3d11DeviceContext->PSSetShaderResources(0, ARRAYSIZE(resourceViews), resourceViews);
+        m_d3d11DeviceContext->PSSetSamplers(0, 1, m_linearClampSampler.GetAddressOf());
+        m_d3d11DeviceContext->OMSetRenderTargets(1, output.renderTargetView[outputIndex].GetAddressOf(), nullptr);
+
+        D3D11_VIEWPORT viewport{};
+        viewport.TopLeftX = (float)output.imageRect.offset.x;
+        viewport.TopLeftY = (float)output.imageRect.offset.y;
+        viewport.Width = (float)output.imageRect.extent.width;
+        viewport.Height = (float)output.imageRect.extent.height;
+        viewport.MaxDepth = 1.f;
+        m_d3d11DeviceContext->RSSetViewports(1, &viewport);
+
+        m_d3d11DeviceContext->Draw(3, 0);
+
+        // Unbind all resources to avoid D3D validation errors.
+        ID3D11ShaderResourceView* nullSRV[] = {nullptr, nullptr};
+        m_d3d11DeviceContext->PSSetShaderResources(0, ARRAYSIZE(nullSRV), nullSRV);
+        m_d3d11DeviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+
+        m_d3d11DeviceContext->SwapDeviceContextState(appContextState.Get(), nullptr);
+
+        // The application's swapchains must still be committed in order to advance to the next image.
+        for (Swapchain* xrSwapchain : {&peripheralSwapchain, &focusSwapchain}) {
+            const auto key = std::make_pair(xrSwapchain->pvrSwapchain[0], 0u);
+            if (!committed.count(key)) {
+                CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, xrSwapchain->pvrSwapchain[0]));
+                committed.insert(key);
+            }
+        }
+
+        CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, output.pvrSwapchain));
+
+        return &output;
+    }
+
+} // namespace pimax_openxr
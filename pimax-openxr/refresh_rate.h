@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// The logic for switching the refresh rate of the display. A mode switch is not instantaneous: the request is sent to
+// the display, and we must wait for the display to report the new rate before the frame timing can be updated.
+
+namespace pimax_openxr::refresh_rate {
+
+    // The display refresh rates are reported with some imprecision, eg: 89.99 Hz.
+    static inline bool isSameRate(float a, float b) {
+        return std::abs(a - b) < 0.5f;
+    }
+
+    // The display backend. This lets the switching logic run against a simulated display.
+    struct IDisplay {
+        virtual ~IDisplay() = default;
+
+        virtual std::vector<float> getSupportedRates() = 0;
+        virtual float getCurrentRate() = 0;
+        virtual bool requestRate(float rate) = 0;
+    };
+
+    enum class SwitchStatus {
+        Idle,
+        Pending,
+        Completed,
+        TimedOut,
+    };
+
+    class ModeSwitcher {
+      public:
+        explicit ModeSwitcher(double timeout = 5.0) : m_timeout(timeout) {
+        }
+
+        // Start switching to a new rate. The rate must be one of the supported rates. Returns false if the display
+        // rejected the request.
+        bool request(IDisplay& display, float rate, double now) {
+            if (m_pendingRate && isSameRate(m_pendingRate.value(), rate)) {
+                return true;
+            }
+            if (!m_pendingRate && isSameRate(display.getCurrentRate(), rate)) {
+                return true;
+            }
+
+            if (!display.requestRate(rate)) {
+                return false;
+            }
+
+            // A newer request supersedes any pending one.
+            m_pendingRate = rate;
+            m_requestTime = now;
+
+            return true;
+        }
+
+        // Poll the display for completion of the pending switch.
+        SwitchStatus update(IDisplay& display, double now) {
+            if (!m_pendingRate) {
+                return SwitchStatus::Idle;
+            }
+
+            if (isSameRate(display.getCurrentRate(), m_pendingRate.value())) {
+                m_pendingRate.reset();
+                return SwitchStatus::Completed;
+            }
+
+            if (now - m_requestTime > m_timeout) {
+                m_pendingRate.reset();
+                return SwitchStatus::TimedOut;
+            }
+
+            return SwitchStatus::Pending;
+        }
+
+        std::optional<float> getPendingRate() const {
+            return m_pendingRate;
+        }
+
+      private:
+        const double m_timeout;
+        std::optional<float> m_pendingRate;
+        double m_requestTime{0.0};
+    };
+
+} // namespace pimax_openxr::refresh_rate
@@ -24,7 +24,31 @@
 
 #include "framework/dispatch.gen.h"
 
+#include "action_snapshot.h"
 #include "appinsights.h"
+#include "async_init.h"
+#include "deferred_release.h"
+#include "device_cache.h"
+#include "dynamic_resolution.h"
+#include "event_queue.h"
+#include "eye_gaze.h"
+#include "frame_latency.h"
+#include "frame_pacing.h"
+#include "frame_submission.h"
+#include "frame_time_estimator.h"
+#include "gpu_memory.h"
+#include "haptic_timeline.h"
+#include "input_history.h"
+#include "pose_history.h"
+#include "perf_metrics.h"
+#include "perf_settings.h"
+#include "pimax_extensions.h"
+#include "refresh_rate.h"
+#include "shader_cache.h"
+#include "slice_swapchains.h"
+#include "smoothing_governor.h"
+#include "startup_timeline.h"
+#include "swapchain_pool.h"
 #include "utils.h"
 
 namespace pimax_openxr {
@@ -237,6 +261,19 @@ namespace pimax_openxr {
                                                   float* displayRefreshRates) override;
         XrResult xrGetDisplayRefreshRateFB(XrSession session, float* displayRefreshRate) override;
         XrResult xrRequestDisplayRefreshRateFB(XrSession session, float displayRefreshRate) override;
+        XrResult xrPerfSettingsSetPerformanceLevelEXT(XrSession session,
+                                                      XrPerfSettingsDomainEXT domain,
+                                                      XrPerfSettingsLevelEXT level) override;
+        XrResult xrEnumeratePerformanceMetricsCounterPathsMETA(XrInstance instance,
+                                                               uint32_t counterPathCapacityInput,
+                                                               uint32_t* counterPathCountOutput,
+                                                               XrPath* counterPaths) override;
+        XrResult xrSetPerformanceMetricsStateMETA(XrSession session,
+                                                  const XrPerformanceMetricsStateMETA* state) override;
+        XrResult xrGetPerformanceMetricsStateMETA(XrSession session, XrPerformanceMetricsStateMETA* state) override;
+        XrResult xrQueryPerformanceMetricsCounterMETA(XrSession session,
+                                                      XrPath counterPath,
+                                                      XrPerformanceMetricsCounterMETA* counter) override;
 
       private:
         enum class ForcedInteractionProfile {
@@ -257,6 +294,9 @@ namespace pimax_openxr {
             // The cached textures used for copy between swapchains.
             std::vector<std::vector<ID3D11Texture2D*>> slices;
 
+            // Which slices have a PVR swapchain and were ever committed.
+            slice_swapchains::Tracker sliceTracker;
+
             // The last acquired/released swapchain image index.
             int currentAcquiredIndex{0};
             int pvrLastReleasedIndex{0};
@@ -267,10 +307,14 @@ namespace pimax_openxr {
             std::vector<ComPtr<ID3D11Texture2D>> images;
             uint32_t nextIndex{0};
 
-            // Resources needed to run the resolve shader.
+            // Resources needed to run the resolve shader. The target of the shader comes from m_resolveScratchPool.
             std::vector<std::vector<ComPtr<ID3D11ShaderResourceView>>> imagesResourceView;
-            ComPtr<ID3D11Texture2D> resolved;
-            ComPtr<ID3D11UnorderedAccessView> resolvedAccessView;
+
+            // Resources needed to sample the swapchain during composition (eg: quad views). Multisampled swapchains
+            // are first resolved into compositionResolved.
+            std::vector<ComPtr<ID3D11ShaderResourceView>> compositionResourceView;
+            ComPtr<ID3D11Texture2D> compositionResolved;
+            ComPtr<ID3D11ShaderResourceView> compositionResolvedResourceView;
 
             // Resources needed for interop.
             std::vector<ComPtr<ID3D12Resource>> d3d12Images;
@@ -285,12 +329,44 @@ namespace pimax_openxr {
             pvrTextureSwapChainDesc pvrDesc;
         };
 
+        // The target of the resolve shader, shared by all the swapchains with the same dimensions.
+        struct ResolveScratch {
+            ComPtr<ID3D11Texture2D> texture;
+            ComPtr<ID3D11UnorderedAccessView> accessView;
+        };
+
+        // A swapchain owned by the runtime, receiving the output of the runtime's own processing (eg: composition).
+        struct RuntimeSwapchain {
+            pvrTextureSwapChain pvrSwapchain{nullptr};
+            pvrTextureSwapChainDesc pvrDesc{};
+            std::vector<ComPtr<ID3D11RenderTargetView>> renderTargetView;
+            std::vector<ComPtr<ID3D11DepthStencilView>> depthStencilView;
+
+            // The region written by the last processing, to submit as the viewport.
+            XrRect2Di imageRect{};
+        };
+
+        // The binding of an action space, resolved from the action sources. It is immutable once published.
+        struct ActionSpaceBinding {
+            // The value of m_actionSpaceBindingsVersion that the binding was resolved for.
+            uint64_t version{0};
+            int side{-1};
+            bool isEyeGaze{false};
+
+            // The grip/aim offset for the controller, pre-composed with poseInSpace.
+            XrPosef pose{xr::math::Pose::Identity()};
+        };
+
         struct Space {
             // Information recorded at creation.
             XrReferenceSpaceType referenceType;
             XrAction action{XR_NULL_HANDLE};
             XrPath subActionPath{XR_NULL_PATH};
             XrPosef poseInSpace;
+
+            // Replaced by resolveActionSpace() whenever m_actionSpaceBindingsVersion changes. xrLocateSpace() may be
+            // called concurrently for the same space, so the binding is swapped as a whole.
+            mutable action_snapshot::Publisher<ActionSpaceBinding> binding;
         };
 
         struct ActionSource {
@@ -305,38 +381,119 @@ namespace pimax_openxr {
             std::string realPath;
         };
 
-        struct Action {
-            XrActionType type;
+        // The events we post for xrPollEvent().
+        union Event {
+            XrEventDataBaseHeader header;
+            XrEventDataSessionStateChanged sessionStateChanged;
+            XrEventDataInteractionProfileChanged interactionProfileChanged;
+            XrEventDataReferenceSpaceChangePending referenceSpaceChangePending;
+            XrEventDataDisplayRefreshRateChangedFB displayRefreshRateChanged;
+            XrEventDataPerfSettingsEXT perfSettings;
+        };
 
-            XrActionSet actionSet{XR_NULL_HANDLE};
+        struct HapticsCommand {
+            double time;
 
-            float lastFloatValue{0.f};
-            XrTime lastFloatValueChangedTime{0};
+            // No vibration means to stop.
+            std::optional<haptic_timeline::Vibration> vibration;
+        };
+
+        using ActionSnapshot = action_snapshot::Snapshot<XrAction>;
+
+        using SwapchainPool =
+            swapchain_pool::RecyclingPool<pvrTextureSwapChainDesc, pvrTextureSwapChain, utils::SwapchainDescEqual>;
+
+        // About 1 second of history at the default sampling rate.
+        using PoseHistory = pose_history::History<512>;
 
-            XrVector2f lastVector2fValue{0.f, 0.f};
-            XrTime lastVector2fValueChangedTime{0};
+        struct Action {
+            XrActionType type;
 
-            bool lastBoolValue{false};
-            XrTime lastBoolValueChangedTime{0};
+            XrActionSet actionSet{XR_NULL_HANDLE};
 
             std::map<std::string, ActionSource> actionSources;
         };
 
         // instance.cpp
+        void initializePvr(startup_timeline::Clock::time_point pvrInitBegin);
+        void waitForPvr();
         void initializeExtensionsTable();
         std::optional<int> getSetting(const std::string& value) const;
+        void queueEvent(const Event& event);
 
         // system.cpp
         void fillDisplayDeviceInfo();
 
+        // perf_counter.cpp
+        void calibrateTimeConversion();
+
+        // display_refresh_rate.cpp
+        void initializeDisplayRefreshRate();
+        void updateDisplayRefreshRate();
+        void restoreDisplayRefreshRate();
+
+        // performance_settings.cpp
+        void updatePerfSettingsNotifications(uint64_t cpuFrameTimeUs, uint64_t gpuFrameTimeUs);
+
+        // performance_metrics.cpp
+        void updatePerformanceMetrics(double now, uint64_t precompositionTimeUs);
+
         // session.cpp
         void refreshSettings();
+        void setSessionState(XrSessionState state);
+        void queueInteractionProfileChanged();
+
+        // frame.cpp
+        bool isAppFrameTimingNeeded() const;
+        void updateFramePacing();
+        void updateSmoothingGovernor(uint64_t cpuFrameTimeUs, uint64_t gpuFrameTimeUs);
+        void applySmoothingDivisor(uint32_t divisor);
+        void restoreSmoothingConfig();
+        void recordFrameLatency(const frame_latency::FrameRecord& record);
+        void logFrameLatencySummary(const frame_latency::Summary& summary) const;
+
+        // frame_submission.cpp
+        void startSubmissionThread();
+        void stopSubmissionThread();
+        void queueSubmission(std::unique_lock<std::mutex>& lock, const std::vector<pvrLayerHeader*>& layers);
+        void waitForSubmission(std::unique_lock<std::mutex>& lock);
+        void checkSubmissionError();
+
+        // swapchain.cpp
+        pvrTextureSwapChain createPvrSwapchain(const pvrTextureSwapChainDesc& desc);
+        void retirePvrSwapchain(const pvrTextureSwapChainDesc& desc, pvrTextureSwapChain pvrSwapchain);
+        void clearSwapchainPool();
+        UINT64 signalRetirementFence();
+        void retireSwapchain(Swapchain& xrSwapchain);
+        void signalRetiredSwapchains();
+        void releaseRetiredSwapchains(bool wait = false);
+        void destroySwapchainResources(Swapchain& xrSwapchain);
+        uint64_t getSwapchainMemorySize(const pvrTextureSwapChainDesc& desc, pvrTextureSwapChain pvrSwapchain) const;
+        void trackSwapchainMemory(gpu_memory::Category category,
+                                  const void* owner,
+                                  const pvrTextureSwapChainDesc& desc,
+                                  pvrTextureSwapChain pvrSwapchain);
+        void reportGpuMemory() const;
 
         // action.cpp
         void rebindControllerActions(int side);
         std::string getXrPath(XrPath path) const;
         int getActionSide(const std::string& fullPath) const;
         XrVector2f handleJoystickDeadzone(pvrVector2f raw) const;
+        void initializeActionSnapshot();
+        void updateActionSnapshot(bool isSync);
+        action_snapshot::State
+        computeActionState(const Action& xrAction, const std::string& subActionPath, double& changeTime) const;
+        XrResult getActionState(const XrActionStateGetInfo& getInfo,
+                                XrActionType type,
+                                action_snapshot::State& state) const;
+
+        // input_sampler.cpp
+        void startInputSampler();
+        void stopInputSampler();
+        void latchInputHistory();
+        double getInputChangeTime(const ActionSource& source, int side) const;
+        void inputSamplerThreadMain();
 
         // mappings.cpp
         void initializeRemappingTables();
@@ -363,21 +520,79 @@ namespace pimax_openxr {
 
         // space.cpp
         XrSpaceLocationFlags
-        locateSpaceToOrigin(const Space& xrSpace, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
+        locateSpaceToOrigin(const Space& xrSpace,
+                            XrTime time,
+                            XrPosef& pose,
+                            XrSpaceVelocity* velocity,
+                            XrTime* eyeGazeSampleTime = nullptr) const;
         XrSpaceLocationFlags getHmdPose(XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
         XrSpaceLocationFlags getControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const;
+        bool getPoseFromHistory(const PoseHistory& history, XrTime time, pvrPoseStatef& state) const;
+        std::unique_ptr<const ActionSpaceBinding> resolveActionSpace(const Space& xrSpace, uint64_t version) const;
+
+        // haptics.cpp
+        void startHapticsThread();
+        void stopHapticsThread();
+        void queueHaptics(int side, const std::optional<haptic_timeline::Vibration>& vibration);
+        void hapticsThreadMain();
+
+        // eye_tracking.cpp
+        void rebindEyeGazeActions();
+        bool isEyeGazePath(const std::string& fullPath) const;
+        XrSpaceLocationFlags getEyeGaze(XrTime time, XrQuaternionf& orientation, XrTime& sampleTime) const;
+
+        // quad_views.cpp
+        bool isViewConfigurationSupported(XrViewConfigurationType viewConfigurationType) const;
+        uint32_t getViewCount(XrViewConfigurationType viewConfigurationType) const;
+        XrFovf getQuadViewsFocusFov(uint32_t eye, const XrFovf& peripheralFov, bool foveated, XrTime time) const;
+        void initializeQuadViewsResources();
+        void releaseQuadViewsResources();
+        void cleanupQuadViews();
+        const RuntimeSwapchain* composeQuadViews(uint32_t eye,
+                                                 const XrCompositionLayerProjectionView& peripheralView,
+                                                 const XrCompositionLayerProjectionView& focusView,
+                                                 std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed);
+
+        // upscaling.cpp
+        void initializeUpscalingResources();
+        void releaseUpscalingResources();
+        void cleanupUpscaling();
+        const RuntimeSwapchain* upscaleView(uint32_t eye,
+                                            const XrCompositionLayerProjectionView& view,
+                                            std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed);
+        const RuntimeSwapchain* upscaleDepth(uint32_t eye,
+                                             const XrCompositionLayerDepthInfoKHR& depth,
+                                             const RuntimeSwapchain& upscaledColor);
 
         // d3d11_native.cpp
         XrResult initializeD3D11(const XrGraphicsBindingD3D11KHR& d3dBindings, bool interop = false);
         void cleanupD3D11();
+        ComPtr<ID3D11Device> createInteropD3D11Device(IDXGIAdapter* adapter);
+        bool canReuseD3D11Device(const device_cache::Key& key);
+        void releaseD3D11DeviceResources();
         XrResult getSwapchainImagesD3D11(Swapchain& xrSwapchain,
                                          XrSwapchainImageD3D11KHR* d3d11Images,
                                          uint32_t count,
                                          bool interop = false);
         void prepareAndCommitSwapchainImage(Swapchain& xrSwapchain,
                                             uint32_t slice,
-                                            std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed) const;
+                                            std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed);
+        void createSliceSwapchain(Swapchain& xrSwapchain, uint32_t slice, bool eager);
+        void releaseUnusedSliceSwapchains();
+        void initializeResolveShaders();
+        const ResolveScratch& getResolveScratch(const Swapchain& xrSwapchain);
+        void evictResolveScratch(bool all = false);
         void flushD3D11Context();
+        ComPtr<ID3DBlob> compileShader(std::string_view hlsl, const char* entryPoint, const char* target) const;
+        void initializeCompositionResources();
+        void releaseCompositionResources();
+        void ensureRuntimeSwapchain(RuntimeSwapchain& swapchain,
+                                    pvrTextureFormat format,
+                                    uint32_t width,
+                                    uint32_t height,
+                                    std::string_view name);
+        void destroyRuntimeSwapchain(RuntimeSwapchain& swapchain);
+        ID3D11ShaderResourceView* getCompositionResourceView(Swapchain& xrSwapchain, uint32_t slice);
 
         // d3d12_interop.cpp
         XrResult initializeD3D12(const XrGraphicsBindingD3D12KHR& d3dBindings);
@@ -386,6 +601,7 @@ namespace pimax_openxr {
         XrResult getSwapchainImagesD3D12(Swapchain& xrSwapchain, XrSwapchainImageD3D12KHR* d3d12Images, uint32_t count);
         void transitionImageD3D12(Swapchain& xrSwapchain, uint32_t index, bool acquire);
         void flushD3D12CommandQueue();
+        void serializeD3D12Work();
         void serializeD3D12Frame();
 
         // vulkan_interop.cpp
@@ -396,6 +612,7 @@ namespace pimax_openxr {
         XrResult getSwapchainImagesVulkan(Swapchain& xrSwapchain, XrSwapchainImageVulkanKHR* vkImages, uint32_t count);
         void transitionImageVulkan(Swapchain& xrSwapchain, uint32_t index, bool acquire);
         void flushVulkanCommandQueue();
+        void serializeVulkanWork();
         void serializeVulkanFrame();
 
         // opengl_interop.cpp
@@ -405,6 +622,7 @@ namespace pimax_openxr {
         bool isOpenGLSession() const;
         XrResult getSwapchainImagesOpenGL(Swapchain& xrSwapchain, XrSwapchainImageOpenGLKHR* glImages, uint32_t count);
         void flushOpenGLContext();
+        void serializeOpenGLWork();
         void serializeOpenGLFrame();
 
         // visibility_mask.cpp
@@ -414,8 +632,9 @@ namespace pimax_openxr {
                                               uint32_t count) const;
 
         // Instance & PVR state.
-        pvrEnvHandle m_pvr;
+        pvrEnvHandle m_pvr{nullptr};
         pvrSessionHandle m_pvrSession{nullptr};
+        async_init::Task m_pvrReady;
         bool m_instanceCreated{false};
         bool m_systemCreated{false};
         bool m_useFrameTimingOverride{false};
@@ -424,10 +643,16 @@ namespace pimax_openxr {
         LUID m_adapterLuid{};
         float m_displayRefreshRate{0};
         double m_frameDuration{0};
+        float m_defaultDisplayRefreshRate{0};
+        bool m_isDisplayRefreshRateRequested{false};
+        std::vector<float> m_supportedDisplayRefreshRates;
+        std::unique_ptr<refresh_rate::IDisplay> m_display;
         pvrEyeRenderInfo m_cachedEyeInfo[xr::StereoView::Count];
         float m_floorHeight{0.f};
         LARGE_INTEGER m_qpcFrequency;
         double m_pvrTimeFromQpcTimeOffset{0};
+        std::once_flag m_timeConversionCalibrated;
+        startup_timeline::Clock::time_point m_sessionCreatedTime;
         XrPath m_stringIndex{0};
         std::map<XrPath, std::string> m_strings;
         uint64_t m_actionSetIndex{0};
@@ -438,17 +663,55 @@ namespace pimax_openxr {
         wil::unique_registry_watcher m_registryWatcher;
         bool m_loggedProductName{false};
         bool m_loggedResolution{false};
-
-        // Session state.
+        bool m_isEyeTrackingAvailable{false};
+        bool m_useSimulatedEyeTracker{false};
+        float m_quadViewsPeripheralDensity{0.5f};
+        float m_quadViewsFocusSize{0.5f};
+        float m_quadViewsFoveatedFocusSize{0.35f};
+        float m_quadViewsFeather{0.05f};
+        bool m_useUpscaling{false};
+        float m_upscalingScale{1.f};
+        float m_upscalingSharpness{0.f};
+        bool m_isDynamicResolutionRequested{false};
+        bool m_useDynamicResolution{false};
+        dynamic_resolution::GovernorSettings m_dynamicResolutionSettings;
+        bool m_useSmoothingGovernor{false};
+        smoothing_governor::GovernorSettings m_smoothingGovernorSettings;
+        bool m_useAsyncSubmission{false};
+        uint32_t m_inputSamplingRate{0};
+        bool m_usePoseHistory{false};
+        bool m_useHapticsThread{false};
+        haptic_timeline::Settings m_hapticsSettings;
+
+        // Session state. The device-level resources outlive the session when the next session may reuse them.
         ComPtr<ID3D11Device5> m_d3d11Device;
         ComPtr<ID3D11DeviceContext4> m_d3d11DeviceContext;
+        device_cache::Key m_d3d11DeviceKey;
+        std::optional<device_cache::Key> m_keptD3D11Device;
+        bool m_isD3D11DeviceReused{false};
         ComPtr<ID3D11ComputeShader> m_resolveShader[2];
+        gpu_memory::ScratchPool<ResolveScratch> m_resolveScratchPool;
         ComPtr<IDXGISwapChain1> m_dxgiSwapchain;
+        ComPtr<ID3D11VertexShader> m_fullScreenVertexShader;
+        ComPtr<ID3D11SamplerState> m_linearClampSampler;
+        ComPtr<ID3DDeviceContextState> m_compositionContextState;
+        ComPtr<ID3D11PixelShader> m_quadViewsPixelShader;
+        ComPtr<ID3D11Buffer> m_quadViewsConstants;
+        RuntimeSwapchain m_quadViewsSwapchain[xr::StereoView::Count];
+        ComPtr<ID3D11PixelShader> m_upscalingPixelShader;
+        ComPtr<ID3D11PixelShader> m_sharpeningPixelShader;
+        ComPtr<ID3D11PixelShader> m_upscalingDepthPixelShader;
+        ComPtr<ID3D11Buffer> m_upscalingConstants;
+        ComPtr<ID3D11Texture2D> m_upscalingIntermediate[xr::StereoView::Count];
+        ComPtr<ID3D11ShaderResourceView> m_upscalingIntermediateResourceView[xr::StereoView::Count];
+        ComPtr<ID3D11RenderTargetView> m_upscalingIntermediateRenderTargetView[xr::StereoView::Count];
+        RuntimeSwapchain m_upscalingSwapchain[xr::StereoView::Count];
+        RuntimeSwapchain m_upscalingDepthSwapchain[xr::StereoView::Count];
         bool m_sessionCreated{false};
-        XrSessionState m_sessionState{XR_SESSION_STATE_UNKNOWN};
-        bool m_sessionStateDirty{false};
+        std::atomic<XrSessionState> m_sessionState{XR_SESSION_STATE_UNKNOWN};
+        XrViewConfigurationType m_primaryViewConfigurationType{XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
         bool m_sessionExiting{false};
-        double m_sessionStateEventTime{0.0};
+        event_queue::BoundedQueue<Event, 64, 16> m_eventQueue;
         std::set<XrSwapchain> m_swapchains;
         std::set<XrSpace> m_spaces;
         XrSpace m_originSpace{XR_NULL_HANDLE};
@@ -456,6 +719,7 @@ namespace pimax_openxr {
         bool m_useParallelProjection{false};
         float m_joystickDeadzone{0.f};
         bool m_swapGripAimPoses{false};
+        std::atomic<uint64_t> m_actionSpaceBindingsVersion{1};
         bool m_canBeginFrame{false};
         std::set<XrActionSet> m_activeActionSets;
         std::set<XrActionSet> m_validActionSets;
@@ -466,16 +730,44 @@ namespace pimax_openxr {
         XrPosef m_controllerGripPose[2];
         std::string m_localizedControllerType[2];
         XrPath m_currentInteractionProfile[2]{XR_NULL_PATH, XR_NULL_PATH};
-        bool m_currentInteractionProfileDirty{false};
+        XrPath m_eyeGazeInteractionProfile{XR_NULL_PATH};
+
+        // The action states of the latest sync, which the xrGetActionState*() functions read from any thread.
+        action_snapshot::Publisher<ActionSnapshot> m_actionSnapshot;
+        XrPath m_actionFilterPaths[action_snapshot::FilterCount]{};
+        refresh_rate::ModeSwitcher m_refreshRateSwitcher;
+        double m_lastDisplayRefreshRatePollTime{0.0};
+        XrPerfSettingsLevelEXT m_perfSettingsCpuLevel{XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT};
+        XrPerfSettingsLevelEXT m_perfSettingsGpuLevel{XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT};
+        perf_settings::NotificationTracker m_perfSettingsCpuNotification;
+        perf_settings::NotificationTracker m_perfSettingsGpuNotification;
+        std::atomic<bool> m_isPerformanceMetricsEnabled{false};
+        perf_metrics::Stats m_performanceMetrics;
+        perf_metrics::PacingTracker m_performanceMetricsPacing;
         std::optional<ForcedInteractionProfile> m_forcedInteractionProfile;
         std::optional<ForcedInteractionProfile> m_lastForcedInteractionProfile;
         int64_t m_gpuFrameTimeOverrideOffsetUs{0};
         uint64_t m_gpuFrameTimeOverrideUs{0};
+        bool m_useSmoothingAwarePacing{false};
         size_t m_gpuFrameTimeFilterLength{3};
-        std::deque<uint64_t> m_gpuFrameTimeFilter;
+        frame_time_estimator::Estimator m_gpuFrameTimeEstimator;
+        double m_frameLatencySummaryPeriod{60.0};
 
         // Synchronization. Locks must be acquired in this order.
         std::mutex m_swapchainsLock;
+        gpu_memory::Accounting m_gpuMemory;
+        SwapchainPool m_swapchainPool;
+        bool m_useEagerSliceSwapchains{true};
+        bool m_useWarmSessionRestart{true};
+        bool m_useWarmSessionRestartAppDevice{false};
+        uint64_t m_unusedSlicesDeadline{0};
+
+        // The swapchains destroyed by the application, waiting for the GPU to pass their fence value.
+        std::vector<Swapchain*> m_unsignaledRetiredSwapchains;
+        deferred_release::Queue<Swapchain*> m_retiredSwapchains;
+        deferred_release::Queue<std::pair<pvrTextureSwapChainDesc, pvrTextureSwapChain>> m_retiredRuntimeSwapchains;
+        ComPtr<ID3D11Fence> m_retirementFence;
+        UINT64 m_retirementFenceValue{0};
         std::mutex m_frameLock;
 
         // Graphics API interop.
@@ -556,8 +848,52 @@ namespace pimax_openxr {
         bool m_frameBegun{false};
         std::optional<double> m_lastFrameWaitedTime;
         uint64_t m_lastGpuFrameTimeUs{0};
+        uint32_t m_compositorRateDivisor{1};
+        frame_pacing::DivisorSampler m_compositorRateSampler;
+        frame_pacing::Pacer m_framePacer;
+        smoothing_governor::Governor m_smoothingGovernor;
+
+        // The values of dbg_asw_enable and dbg_force_framerate_divide_by to restore when the governor releases.
+        std::optional<std::pair<int, int>> m_smoothingGovernorSavedConfig;
+        dynamic_resolution::Governor m_dynamicResolutionGovernor;
+        std::atomic<float> m_dynamicResolutionScale{1.f};
+        float m_lastAppliedRenderScale{0.f};
+        pvrSizei m_recommendedViewSize[xr::StereoView::Count]{};
         pvrInputState m_cachedInputState;
 
+        // Input sampler state. The history is written by the sampler thread, everything else is only accessed by
+        // xrSyncActions() and the xrGetActionState*() functions.
+        std::thread m_inputSamplerThread;
+        std::atomic<bool> m_inputSamplerExit{false};
+        input_history::SampleRing<pvrInputState, 256> m_inputHistory;
+        uint64_t m_inputHistoryReadSequence{0};
+        input_history::BitChannel m_inputButtons[2];
+        input_history::BitChannel m_inputTouches[2];
+        double m_inputAnalogChangeTime[2]{};
+        PoseHistory m_hmdPoseHistory;
+        PoseHistory m_controllerPoseHistory[2];
+
+        // Haptics thread state. The commands are protected by m_hapticsLock.
+        std::thread m_hapticsThread;
+        std::mutex m_hapticsLock;
+        wil::unique_event m_hapticsEvent;
+        bool m_hapticsThreadExit{false};
+        std::optional<HapticsCommand> m_hapticsCommand[2];
+        std::optional<frame_latency::FrameRecord> m_frameLatencyWaited;
+        std::optional<frame_latency::FrameRecord> m_frameLatencyBegun;
+        frame_latency::Tracker m_frameLatencyTracker;
+
+        // Submission thread state. The submission slot is protected by m_frameLock, except while a submission is
+        // pending, where it is owned by the submission thread.
+        struct Submission {
+            std::array<pvrLayer_Union, pvrMaxLayerCount> layers;
+            std::array<pvrLayerHeader*, pvrMaxLayerCount> headers;
+            uint32_t layerCount{0};
+            double compositorReturnTime{0.0};
+            std::optional<frame_latency::FrameRecord> latencyRecord;
+        };
+        frame_submission::Submitter<Submission> m_submitter;
+
         // Statistics.
         AppInsights m_telemetry;
         double m_sessionStartTime{0.0};
@@ -585,4 +921,7 @@ namespace pimax_openxr {
 
     extern std::filesystem::path localAppData;
 
+    // The duration of each phase of the startup, starting with the loader negotiation.
+    extern startup_timeline::Timeline startupTimeline;
+
 } // namespace pimax_openxr
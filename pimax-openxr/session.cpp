@@ -40,6 +40,8 @@ namespace pimax_openxr {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
+        const auto createBegin = startup_timeline::Clock::now();
+
         TraceLoggingWrite(g_traceProvider,
                           "xrCreateSession",
                           TLXArg(instance, "Instance"),
@@ -156,25 +158,52 @@ namespace pimax_openxr {
         m_sessionCreated = true;
 
         // FIXME: Reset the session and frame state here.
-        m_sessionState = XR_SESSION_STATE_IDLE;
-        m_sessionStateDirty = true;
-        m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
+        m_eventQueue.clear();
+        setSessionState(XR_SESSION_STATE_IDLE);
+        setSessionState(XR_SESSION_STATE_READY);
 
         m_frameWaited = m_frameBegun = false;
         m_lastFrameWaitedTime.reset();
 
         m_frameTimes.clear();
+        m_frameLatencyWaited.reset();
+        m_frameLatencyBegun.reset();
+        m_frameLatencyTracker.reset();
+
+        m_perfSettingsCpuLevel = m_perfSettingsGpuLevel = XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT;
+        m_perfSettingsCpuNotification = {};
+        m_perfSettingsGpuNotification = {};
+
+        m_isPerformanceMetricsEnabled = false;
+        m_performanceMetrics.reset();
+        m_performanceMetricsPacing.reset();
+        m_compositorRateDivisor = 1;
+        m_compositorRateSampler.reset();
+        m_framePacer.reset();
 
         m_isControllerActive[0] = m_isControllerActive[1] = false;
         rebindControllerActions(0);
         rebindControllerActions(1);
         m_activeActionSets.clear();
         m_validActionSets.clear();
+        initializeActionSnapshot();
+        m_eyeGazeInteractionProfile = XR_NULL_PATH;
 
-        m_sessionStartTime = m_sessionStateEventTime;
+        m_sessionStartTime = pvr_getTimeSeconds(m_pvr);
         m_sessionTotalFrameCount = 0;
+        m_unusedSlicesDeadline = 0;
 
         try {
+            if (m_useAsyncSubmission) {
+                startSubmissionThread();
+            }
+            if (m_inputSamplingRate) {
+                startInputSampler();
+            }
+            if (m_useHapticsThread) {
+                startHapticsThread();
+            }
+
             // Create a reference space with the origin and the HMD pose.
             {
                 XrReferenceSpaceCreateInfo spaceInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
@@ -189,6 +218,9 @@ namespace pimax_openxr {
                 CHECK_XRCMD(xrCreateReferenceSpace((XrSession)1, &spaceInfo, &m_viewSpace));
             }
         } catch (std::exception& exc) {
+            stopSubmissionThread();
+            stopInputSampler();
+            stopHapticsThread();
             m_sessionCreated = false;
             throw exc;
         }
@@ -197,6 +229,17 @@ namespace pimax_openxr {
 
         TraceLoggingWrite(g_traceProvider, "xrCreateSession", TLXArg(*session, "Session"));
 
+        m_sessionCreatedTime = startup_timeline::Clock::now();
+        startupTimeline.record("session", createBegin, m_sessionCreatedTime);
+
+        const double createTime =
+            std::chrono::duration<double, std::milli>(m_sessionCreatedTime - createBegin).count();
+        Log("Session created in %.1f ms (%s device)\n", createTime, m_isD3D11DeviceReused ? "reused" : "new");
+        TraceLoggingWrite(g_traceProvider,
+                          "SessionCreation",
+                          TLArg(createTime, "DurationMs"),
+                          TLArg(m_isD3D11DeviceReused, "ReusedDevice"));
+
         return XR_SUCCESS;
     }
 
@@ -210,10 +253,34 @@ namespace pimax_openxr {
 
         m_telemetry.logUsage(pvr_getTimeSeconds(m_pvr) - m_sessionStartTime, m_sessionTotalFrameCount);
 
-        // Destroy all swapchains.
+        // Complete any pending submission before releasing the swapchains.
+        stopSubmissionThread();
+        stopInputSampler();
+        stopHapticsThread();
+
+        // Give the user back their own smoothing configuration and refresh rate.
+        applySmoothingDivisor(1);
+        restoreDisplayRefreshRate();
+
+        // Destroy all swapchains. The recycled swapchains stay with the device, see releaseD3D11DeviceResources().
         while (m_swapchains.size()) {
             CHECK_XRCMD(xrDestroySwapchain(*m_swapchains.begin()));
         }
+        {
+            std::unique_lock lock(m_swapchainsLock);
+            std::unique_lock lock2(m_frameLock);
+
+            // The submission thread is stopped, so the D3D11 context can be used to signal the retirement fence.
+            if (isD3D12Session()) {
+                serializeD3D12Work();
+            } else if (isVulkanSession()) {
+                serializeVulkanWork();
+            } else if (isOpenGLSession()) {
+                serializeOpenGLWork();
+            }
+            signalRetiredSwapchains();
+            releaseRetiredSwapchains(true);
+        }
 
         // Destroy reference spaces.
         CHECK_XRCMD(xrDestroySpace(m_originSpace));
@@ -226,8 +293,9 @@ namespace pimax_openxr {
         cleanupVulkan();
         cleanupD3D12();
         cleanupD3D11();
+        Log("Peak GPU memory allocated by the runtime: %.1f MB\n", m_gpuMemory.getPeak() / (1024.0 * 1024.0));
         m_sessionState = XR_SESSION_STATE_UNKNOWN;
-        m_sessionStateDirty = false;
+        m_eventQueue.clear();
         m_sessionCreated = false;
         m_sessionExiting = false;
 
@@ -250,7 +318,7 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(beginInfo->primaryViewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
@@ -258,9 +326,25 @@ namespace pimax_openxr {
             return XR_ERROR_SESSION_NOT_READY;
         }
 
-        m_sessionState = XR_SESSION_STATE_SYNCHRONIZED;
-        m_sessionStateDirty = true;
-        m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
+        m_primaryViewConfigurationType = beginInfo->primaryViewConfigurationType;
+        if (m_primaryViewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+            LOG_TELEMETRY_ONCE(logFeature("QuadViews"));
+        }
+
+        // Start from the full resolution.
+        m_dynamicResolutionGovernor = dynamic_resolution::Governor(m_dynamicResolutionSettings);
+        m_dynamicResolutionScale = m_dynamicResolutionGovernor.getScale();
+        m_lastAppliedRenderScale = 0.f;
+        if (m_useDynamicResolution) {
+            LOG_TELEMETRY_ONCE(logFeature("DynamicResolution"));
+        }
+
+        m_smoothingGovernor = smoothing_governor::Governor(m_smoothingGovernorSettings);
+        if (m_useSmoothingGovernor) {
+            LOG_TELEMETRY_ONCE(logFeature("SmoothingGovernor"));
+        }
+
+        setSessionState(XR_SESSION_STATE_SYNCHRONIZED);
 
         return XR_SUCCESS;
     }
@@ -279,9 +363,12 @@ namespace pimax_openxr {
 
         m_sessionExiting = true;
 
-        m_sessionState = XR_SESSION_STATE_IDLE;
-        m_sessionStateDirty = true;
-        m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
+        // Give the user back their own smoothing configuration and refresh rate.
+        applySmoothingDivisor(1);
+        restoreDisplayRefreshRate();
+
+        setSessionState(XR_SESSION_STATE_IDLE);
+        setSessionState(XR_SESSION_STATE_EXITING);
 
         return XR_SUCCESS;
     }
@@ -299,19 +386,43 @@ namespace pimax_openxr {
             return XR_ERROR_SESSION_NOT_RUNNING;
         }
 
-        m_sessionState = XR_SESSION_STATE_STOPPING;
-        m_sessionStateDirty = true;
-        m_sessionStateEventTime = pvr_getTimeSeconds(m_pvr);
+        setSessionState(XR_SESSION_STATE_STOPPING);
 
         return XR_SUCCESS;
     }
 
+    // Transition to a new session state. Every transition is posted, so the application sees all intermediate states.
+    void OpenXrRuntime::setSessionState(XrSessionState state) {
+        if (m_sessionState.exchange(state) == state) {
+            return;
+        }
+
+        Event event{};
+        event.sessionStateChanged = {XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED};
+        event.sessionStateChanged.session = (XrSession)1;
+        event.sessionStateChanged.state = state;
+        event.sessionStateChanged.time = pvrTimeToXrTime(pvr_getTimeSeconds(m_pvr));
+        queueEvent(event);
+    }
+
+    void OpenXrRuntime::queueInteractionProfileChanged() {
+        if (!m_sessionCreated) {
+            return;
+        }
+
+        Event event{};
+        event.interactionProfileChanged = {XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED};
+        event.interactionProfileChanged.session = (XrSession)1;
+        queueEvent(event);
+    }
+
     // Read dynamic settings from the registry.
     void OpenXrRuntime::refreshSettings() {
         // Value is in unit of hundredth.
         m_joystickDeadzone = getSetting("joystick_deadzone").value_or(2) / 100.f;
 
         m_swapGripAimPoses = getSetting("swap_grip_aim_poses").value_or(0);
+        m_actionSpaceBindingsVersion++;
         const auto forcedInteractionProfile = getSetting("force_interaction_profile").value_or(0);
         if (forcedInteractionProfile == 1) {
             m_forcedInteractionProfile = ForcedInteractionProfile::OculusTouchController;
@@ -331,12 +442,20 @@ namespace pimax_openxr {
 
         m_gpuFrameTimeFilterLength = getSetting("frame_time_filter_length").value_or(5);
 
+        // Value is in seconds. 0 disables the periodic summary in the log.
+        m_frameLatencySummaryPeriod = std::max(0, getSetting("frame_latency_summary_period").value_or(60));
+
+        // Throttle xrWaitFrame() to the cadence of Smart Smoothing. Off by default, since it changes the frame timing
+        // reported to the application and its benefit was not measured on a headset yet.
+        m_useSmoothingAwarePacing = getSetting("smoothing_aware_pacing").value_or(0);
+
         TraceLoggingWrite(g_traceProvider,
                           "PXR_Config",
                           TLArg(m_joystickDeadzone, "JoystickDeadzone"),
                           TLArg(m_gpuFrameTimeOverrideOffsetUs, "GpuFrameTimeOverrideOffset"),
                           TLArg(m_gpuFrameTimeOverrideUs, "GpuFrameTimeOverride"),
-                          TLArg(m_gpuFrameTimeFilterLength, "GpuFrameTimeFilterLength"));
+                          TLArg(m_gpuFrameTimeFilterLength, "GpuFrameTimeFilterLength"),
+                          TLArg(m_useSmoothingAwarePacing, "SmoothingAwarePacing"));
     }
 
 } // namespace pimax_openxr
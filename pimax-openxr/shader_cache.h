@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// A versioned on-disk cache of compiled shaders, so that the HLSL is only compiled on the first start after installing
+// a new version.
+
+namespace pimax_openxr::shader_cache {
+
+    // Bump when the file layout changes. The runtime version and the compiler version are part of the key instead.
+    constexpr uint32_t FileVersion = 1;
+    constexpr uint32_t FileMagic = 0x48535850; // "PXSH"
+
+    // FNV-1a.
+    static inline uint64_t hash(uint64_t seed, const void* data, size_t size) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            seed ^= bytes[i];
+            seed *= 0x100000001b3ull;
+        }
+        return seed;
+    }
+
+    // The key covers everything that changes the bytecode. The strings are hashed with their length, so that moving
+    // characters from one to the other changes the key.
+    static inline uint64_t computeKey(std::string_view source,
+                                      std::string_view entryPoint,
+                                      std::string_view target,
+                                      uint32_t flags,
+                                      uint32_t compilerVersion,
+                                      std::string_view runtimeVersion) {
+        uint64_t key = 0xcbf29ce484222325ull;
+        for (const auto& str : {source, entryPoint, target, runtimeVersion}) {
+            const uint64_t length = str.size();
+            key = hash(key, &length, sizeof(length));
+            key = hash(key, str.data(), str.size());
+        }
+        key = hash(key, &flags, sizeof(flags));
+        key = hash(key, &compilerVersion, sizeof(compilerVersion));
+        return key;
+    }
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t size;
+        uint64_t checksum;
+    };
+
+    static inline std::vector<uint8_t> serialize(uint64_t key, const void* bytecode, size_t size) {
+        FileHeader header{FileMagic, FileVersion, key, size, hash(0xcbf29ce484222325ull, bytecode, size)};
+
+        std::vector<uint8_t> file(sizeof(header) + size);
+        memcpy(file.data(), &header, sizeof(header));
+        memcpy(file.data() + sizeof(header), bytecode, size);
+        return file;
+    }
+
+    // Returns the bytecode if the file is complete, intact and was produced for this key.
+    static inline std::optional<std::vector<uint8_t>> deserialize(uint64_t key, const std::vector<uint8_t>& file) {
+        FileHeader header;
+        if (file.size() < sizeof(header)) {
+            return {};
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != FileMagic || header.version != FileVersion || header.key != key ||
+            header.size != file.size() - sizeof(header)) {
+            return {};
+        }
+
+        std::vector<uint8_t> bytecode(file.begin() + sizeof(header), file.end());
+        if (hash(0xcbf29ce484222325ull, bytecode.data(), bytecode.size()) != header.checksum) {
+            return {};
+        }
+        return bytecode;
+    }
+
+    static inline std::filesystem::path getPath(const std::filesystem::path& directory, uint64_t key) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+        return directory / name;
+    }
+
+    static inline std::optional<std::vector<uint8_t>> load(const std::filesystem::path& directory, uint64_t key) {
+        std::ifstream stream(getPath(directory, key), std::ios::binary);
+        if (!stream) {
+            return {};
+        }
+        const std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        return deserialize(key, file);
+    }
+
+    // The file is written under a temporary name then renamed, so that another process never reads a partial file.
+    static inline bool store(const std::filesystem::path& directory, uint64_t key, const void* bytecode, size_t size) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+
+        const auto path = getPath(directory, key);
+        auto temporaryPath = path;
+        temporaryPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                                                 std::chrono::steady_clock::now().time_since_epoch().count());
+        {
+            const auto file = serialize(key, bytecode, size);
+            std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!stream.write(reinterpret_cast<const char*>(file.data()), file.size())) {
+                stream.close();
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    }
+
+} // namespace pimax_openxr::shader_cache
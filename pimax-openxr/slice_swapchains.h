@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// PVR swapchains cannot be texture arrays, so each slice past the first one of an application's texture array is copied
+// into a swapchain of its own. These are created either when the application enumerates the images (eager), or during
+// the first xrEndFrame() that commits the slice (lazy). The eager ones that the application never commits are released
+// after a few seconds of frames.
+
+namespace pimax_openxr::slice_swapchains {
+
+    // How many frames the application has to start committing the slices created ahead of time.
+    constexpr uint64_t MaxUnusedFrames = 300;
+
+    // The earliest of two frame deadlines, where 0 means no deadline.
+    static inline uint64_t earliestDeadline(uint64_t a, uint64_t b) {
+        return a && b ? std::min(a, b) : std::max(a, b);
+    }
+
+    class Tracker {
+      public:
+        // Slice 0 is the application's swapchain itself, which always exists.
+        void reset(uint32_t arraySize) {
+            m_created.assign(arraySize, false);
+            m_used.assign(arraySize, false);
+            if (arraySize) {
+                m_created[0] = true;
+            }
+            m_unusedDeadline = 0;
+        }
+
+        // Create the swapchains for all the slices ahead of time, calling create() with each slice index. Returns the
+        // frame count past which the slices not committed yet are released, or 0 when there are no slices.
+        template <typename Create>
+        uint64_t createAll(uint64_t frameCount, Create&& create) {
+            bool createdAny = false;
+            for (uint32_t slice = 1; slice < m_created.size(); slice++) {
+                if (!m_created[slice]) {
+                    create(slice);
+                    m_created[slice] = true;
+                    createdAny = true;
+                }
+            }
+            if (createdAny) {
+                m_unusedDeadline = frameCount + MaxUnusedFrames;
+            }
+            return createdAny ? m_unusedDeadline : 0;
+        }
+
+        // Mark a slice as committed, calling create() first if its swapchain does not exist (yet, or anymore).
+        template <typename Create>
+        void use(uint32_t slice, Create&& create) {
+            if (!m_created[slice]) {
+                create(slice);
+                m_created[slice] = true;
+            }
+            m_used[slice] = true;
+        }
+
+        // Once the deadline is passed, call release() with each slice that was created ahead of time but never
+        // committed. Returns the deadline still pending (0 once passed), for the caller to track the earliest one.
+        template <typename Release>
+        uint64_t releaseUnused(uint64_t frameCount, Release&& release) {
+            if (!m_unusedDeadline || frameCount < m_unusedDeadline) {
+                return m_unusedDeadline;
+            }
+
+            for (uint32_t slice = 1; slice < m_created.size(); slice++) {
+                if (m_created[slice] && !m_used[slice]) {
+                    release(slice);
+                    m_created[slice] = false;
+                }
+            }
+            m_unusedDeadline = 0;
+            return 0;
+        }
+
+        bool isCreated(uint32_t slice) const {
+            return m_created[slice];
+        }
+
+        bool isUsed(uint32_t slice) const {
+            return m_used[slice];
+        }
+
+        uint64_t getUnusedDeadline() const {
+            return m_unusedDeadline;
+        }
+
+      private:
+        std::vector<bool> m_created;
+        std::vector<bool> m_used;
+        uint64_t m_unusedDeadline{0};
+    };
+
+} // namespace pimax_openxr::slice_swapchains
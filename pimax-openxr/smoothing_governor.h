@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// A governor that engages compulsive smoothing when the application cannot sustain the refresh rate, and releases it
+// once the application can.
+
+namespace pimax_openxr::smoothing_governor {
+
+    struct GovernorSettings {
+        // The load (frame time over frame budget) above which a frame counts as a miss.
+        float engageLoad{1.f};
+
+        // The load below which a frame counts as fitting the full rate budget while smoothing is engaged. The gap with
+        // engageLoad is the hysteresis that keeps the governor from hovering just below the refresh rate.
+        float releaseLoad{0.8f};
+
+        // Misses accumulate one point and hits remove one point, so that smoothing engages only when more than half of
+        // the frames miss their budget for a sustained period.
+        uint32_t engageScore{60};
+
+        // The number of consecutive frames fitting the budget before releasing smoothing.
+        uint32_t releaseFrames{180};
+
+        // The minimum time between two decisions.
+        double minimumDwellTime{3.0};
+
+        // The frame rate division to use when engaged.
+        uint32_t divisor{2};
+    };
+
+    class Governor {
+      public:
+        Governor() = default;
+        explicit Governor(const GovernorSettings& settings) : m_settings(settings) {
+        }
+
+        void reset() {
+            m_isEngaged = false;
+            m_missScore = 0;
+            m_fitFrames = 0;
+            m_lastDecisionTime.reset();
+        }
+
+        // Update the governor with the latest measurement. frameBudget is the native frame duration, regardless of
+        // whether smoothing is engaged. Returns the new frame rate divisor whenever it changes.
+        std::optional<uint32_t> update(double frameTimeUs, double frameBudgetUs, double now) {
+            // The timers are not ready for the first few frames.
+            if (frameTimeUs <= 0.0 || frameBudgetUs <= 0.0) {
+                return {};
+            }
+
+            const double load = frameTimeUs / frameBudgetUs;
+            if (!m_isEngaged) {
+                if (load > m_settings.engageLoad) {
+                    m_missScore++;
+                } else if (m_missScore > 0) {
+                    m_missScore--;
+                }
+            } else {
+                m_fitFrames = load < m_settings.releaseLoad ? m_fitFrames + 1 : 0;
+            }
+
+            if (m_lastDecisionTime && now - m_lastDecisionTime.value() < m_settings.minimumDwellTime) {
+                return {};
+            }
+
+            if (!m_isEngaged && m_missScore >= m_settings.engageScore) {
+                m_isEngaged = true;
+                m_fitFrames = 0;
+                m_lastDecisionTime = now;
+                return getDivisor();
+            } else if (m_isEngaged && m_fitFrames >= m_settings.releaseFrames) {
+                m_isEngaged = false;
+                m_missScore = 0;
+                m_lastDecisionTime = now;
+                return getDivisor();
+            }
+
+            return {};
+        }
+
+        uint32_t getDivisor() const {
+            return m_isEngaged ? m_settings.divisor : 1;
+        }
+
+        bool isEngaged() const {
+            return m_isEngaged;
+        }
+
+        // The current state of the decision counters, for tracing.
+        uint32_t getMissScore() const {
+            return m_missScore;
+        }
+
+        uint32_t getFitFrames() const {
+            return m_fitFrames;
+        }
+
+        const GovernorSettings& getSettings() const {
+            return m_settings;
+        }
+
+      private:
+        GovernorSettings m_settings;
+        bool m_isEngaged{false};
+        uint32_t m_missScore{0};
+        uint32_t m_fitFrames{0};
+        std::optional<double> m_lastDecisionTime;
+    };
+
+} // namespace pimax_openxr::smoothing_governor
@@ -182,6 +182,15 @@ namespace pimax_openxr {
             velocity = reinterpret_cast<XrSpaceVelocity*>(velocity->next);
         }
 
+        XrEyeGazeSampleTimeEXT* eyeGazeSampleTime = reinterpret_cast<XrEyeGazeSampleTimeEXT*>(location->next);
+        while (eyeGazeSampleTime) {
+            if (has_XR_EXT_eye_gaze_interaction && eyeGazeSampleTime->type == XR_TYPE_EYE_GAZE_SAMPLE_TIME_EXT) {
+                eyeGazeSampleTime->time = 0;
+                break;
+            }
+            eyeGazeSampleTime = reinterpret_cast<XrEyeGazeSampleTimeEXT*>(eyeGazeSampleTime->next);
+        }
+
         Space& xrSpace = *(Space*)space;
         Space& xrBaseSpace = *(Space*)baseSpace;
 
@@ -189,8 +198,11 @@ namespace pimax_openxr {
         XrSpaceVelocity spaceToVirtualVelocity{};
         XrPosef baseSpaceToVirtual = Pose::Identity();
         XrSpaceVelocity baseSpaceToVirtualVelocity{};
-        const auto flags1 =
-            locateSpaceToOrigin(xrSpace, time, spaceToVirtual, velocity ? &spaceToVirtualVelocity : nullptr);
+        const auto flags1 = locateSpaceToOrigin(xrSpace,
+                                                time,
+                                                spaceToVirtual,
+                                                velocity ? &spaceToVirtualVelocity : nullptr,
+                                                eyeGazeSampleTime ? &eyeGazeSampleTime->time : nullptr);
         const auto flags2 = locateSpaceToOrigin(
             xrBaseSpace, time, baseSpaceToVirtual, velocity ? &baseSpaceToVirtualVelocity : nullptr);
 
@@ -264,15 +276,16 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewLocateInfo->viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        if (viewCapacityInput && viewCapacityInput < xr::StereoView::Count) {
+        const uint32_t viewCount = getViewCount(viewLocateInfo->viewConfigurationType);
+        if (viewCapacityInput && viewCapacityInput < viewCount) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
 
-        *viewCountOutput = xr::StereoView::Count;
+        *viewCountOutput = viewCount;
         TraceLoggingWrite(g_traceProvider, "xrLocateViews", TLArg(*viewCountOutput, "ViewCountOutput"));
 
         if (viewCapacityInput && views) {
@@ -295,24 +308,59 @@ namespace pimax_openxr {
                 pvrPosef eyePoses[xr::StereoView::Count]{{}, {}};
                 pvr_calcEyePoses(m_pvr, xrPoseToPvrPose(location.pose), hmdToEyePose, eyePoses);
 
+                // With quad views, the focus views may follow the eye gaze.
+                bool foveatedRenderingActive = false;
+                if (has_XR_VARJO_foveated_rendering && viewCount > xr::StereoView::Count) {
+                    const XrViewLocateFoveatedRenderingVARJO* foveatedRendering =
+                        reinterpret_cast<const XrViewLocateFoveatedRenderingVARJO*>(viewLocateInfo->next);
+                    while (foveatedRendering) {
+                        if (foveatedRendering->type == XR_TYPE_VIEW_LOCATE_FOVEATED_RENDERING_VARJO) {
+                            foveatedRenderingActive = foveatedRendering->foveatedRenderingActive;
+                            break;
+                        }
+                        foveatedRendering =
+                            reinterpret_cast<const XrViewLocateFoveatedRenderingVARJO*>(foveatedRendering->next);
+                    }
+                }
+
                 for (uint32_t i = 0; i < *viewCountOutput; i++) {
                     if (views[i].type != XR_TYPE_VIEW) {
                         return XR_ERROR_VALIDATION_FAILURE;
                     }
 
-                    views[i].pose = pvrPoseToXrPose(eyePoses[i]);
-                    views[i].fov.angleDown = -atan(m_cachedEyeInfo[i].Fov.DownTan);
-                    views[i].fov.angleUp = atan(m_cachedEyeInfo[i].Fov.UpTan);
-                    views[i].fov.angleLeft = -atan(m_cachedEyeInfo[i].Fov.LeftTan);
-                    views[i].fov.angleRight = atan(m_cachedEyeInfo[i].Fov.RightTan);
+                    // Quad views: the focus views (2 and 3) share the pose of the peripheral views (0 and 1).
+                    const uint32_t eye = i % xr::StereoView::Count;
+
+                    views[i].pose = pvrPoseToXrPose(eyePoses[eye]);
+                    views[i].fov.angleDown = -atan(m_cachedEyeInfo[eye].Fov.DownTan);
+                    views[i].fov.angleUp = atan(m_cachedEyeInfo[eye].Fov.UpTan);
+                    views[i].fov.angleLeft = -atan(m_cachedEyeInfo[eye].Fov.LeftTan);
+                    views[i].fov.angleRight = atan(m_cachedEyeInfo[eye].Fov.RightTan);
 
                     if (m_useParallelProjection) {
                         // Shift FOV by 10 degree. All Pimax headsets have a 10 degree canting.
-                        const float angle = i == 0 ? -PVR::DegreeToRad(10.f) : PVR::DegreeToRad(10.f);
+                        const float angle = eye == 0 ? -PVR::DegreeToRad(10.f) : PVR::DegreeToRad(10.f);
                         views[i].fov.angleLeft += angle;
                         views[i].fov.angleRight += angle;
                     }
 
+                    if (i >= xr::StereoView::Count) {
+                        views[i].fov = getQuadViewsFocusFov(
+                            eye, views[i].fov, foveatedRenderingActive, viewLocateInfo->displayTime);
+                    }
+
+                    if (m_isDynamicResolutionRequested) {
+                        XrViewRenderScalePIMAX* renderScale = reinterpret_cast<XrViewRenderScalePIMAX*>(views[i].next);
+                        while (renderScale) {
+                            if (renderScale->type == XR_TYPE_VIEW_RENDER_SCALE_PIMAX) {
+                                renderScale->recommendedRenderScale =
+                                    m_useDynamicResolution ? m_dynamicResolutionScale.load() : 1.f;
+                                break;
+                            }
+                            renderScale = reinterpret_cast<XrViewRenderScalePIMAX*>(renderScale->next);
+                        }
+                    }
+
                     TraceLoggingWrite(
                         g_traceProvider, "xrLocateViews", TLArg(viewState->viewStateFlags, "ViewStateFlags"));
                     TraceLoggingWrite(g_traceProvider,
@@ -349,7 +397,8 @@ namespace pimax_openxr {
     XrSpaceLocationFlags OpenXrRuntime::locateSpaceToOrigin(const Space& xrSpace,
                                                             XrTime time,
                                                             XrPosef& pose,
-                                                            XrSpaceVelocity* velocity) const {
+                                                            XrSpaceVelocity* velocity,
+                                                            XrTime* eyeGazeSampleTime) const {
         XrSpaceLocationFlags result = 0;
 
         if (velocity) {
@@ -378,35 +427,43 @@ namespace pimax_openxr {
             }
         } else if (xrSpace.action != XR_NULL_HANDLE) {
             // Action spaces for motion controllers.
-            Action& xrAction = *(Action*)xrSpace.action;
+            // Read the version before resolving, so that a concurrent rebind causes another refresh.
+            const uint64_t version = m_actionSpaceBindingsVersion;
+            auto binding = xrSpace.binding.get();
+            if (!binding || binding->version != version) {
+                xrSpace.binding.publish(resolveActionSpace(xrSpace, version));
+                binding.reload();
+            }
 
-            const std::string subActionPath = getXrPath(xrSpace.subActionPath);
-            for (const auto& source : xrAction.actionSources) {
-                if (!startsWith(source.first, subActionPath)) {
-                    continue;
-                }
+            if (binding->isEyeGaze) {
+                // The gaze originates from the headset (center eye).
+                XrPosef headPose;
+                result = getHmdPose(time, headPose, nullptr);
 
-                const std::string& fullPath = source.first;
-                TraceLoggingWrite(g_traceProvider, "xrLocateSpace", TLArg(fullPath.c_str(), "ActionSourcePath"));
-
-                const bool isGripPose = endsWith(fullPath, "/input/grip/pose");
-                const bool isAimPose = endsWith(fullPath, "/input/aim/pose");
-                const int side = getActionSide(fullPath);
-                if ((isGripPose || isAimPose) && side >= 0) {
-                    result = getControllerPose(side, time, pose, velocity);
-
-                    // Apply the pose offsets.
-                    const bool useAimPose = m_swapGripAimPoses ? isGripPose : isAimPose;
-                    if (useAimPose) {
-                        pose = Pose::Multiply(m_controllerAimPose[side], pose);
-                    } else {
-                        pose = Pose::Multiply(m_controllerGripPose[side], pose);
-                    }
+                XrQuaternionf gazeOrientation;
+                XrTime sampleTime;
+                const auto gazeFlags = getEyeGaze(time, gazeOrientation, sampleTime);
+                if (gazeFlags) {
+                    pose = Pose::Multiply(Pose::MakePose(gazeOrientation, XrVector3f{0, 0, 0}), headPose);
 
-                    // Per spec we must consistently pick one source. We pick the first one.
-                    break;
+                    // The gaze is only tracked if both the head and the eyes are tracked.
+                    if (!(gazeFlags & XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT)) {
+                        result &= ~XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+                    }
+                    if (eyeGazeSampleTime) {
+                        *eyeGazeSampleTime = sampleTime;
+                    }
+                } else {
+                    result = 0;
                 }
+            } else if (binding->side >= 0) {
+                result = getControllerPose(binding->side, time, pose, velocity);
             }
+
+            // Apply the pose offsets and the offset transform.
+            pose = Pose::Multiply(binding->pose, pose);
+
+            return result;
         }
 
         // Apply the offset transform.
@@ -415,12 +472,66 @@ namespace pimax_openxr {
         return result;
     }
 
+    // Find the source of an action space and pre-compose its pose offsets, so that locating the space does not need
+    // to walk the action sources. The binding is built aside, and only published by the caller once complete.
+    std::unique_ptr<const OpenXrRuntime::ActionSpaceBinding> OpenXrRuntime::resolveActionSpace(const Space& xrSpace,
+                                                                                             uint64_t version) const {
+        auto binding = std::make_unique<ActionSpaceBinding>();
+        binding->pose = xrSpace.poseInSpace;
+
+        const Action& xrAction = *(Action*)xrSpace.action;
+
+        const std::string subActionPath = getXrPath(xrSpace.subActionPath);
+        for (const auto& source : xrAction.actionSources) {
+            if (!startsWith(source.first, subActionPath)) {
+                continue;
+            }
+
+            const std::string& fullPath = source.first;
+
+            const bool isGripPose = endsWith(fullPath, "/input/grip/pose");
+            const bool isAimPose = endsWith(fullPath, "/input/aim/pose");
+            const bool isGazePose = endsWith(fullPath, "/input/gaze_ext/pose");
+            const int side = getActionSide(fullPath);
+            if (isGazePose && isEyeGazePath(fullPath)) {
+                binding->isEyeGaze = true;
+            } else if ((isGripPose || isAimPose) && side >= 0) {
+                binding->side = side;
+
+                const bool useAimPose = m_swapGripAimPoses ? isGripPose : isAimPose;
+                binding->pose = Pose::Multiply(
+                    xrSpace.poseInSpace, useAimPose ? m_controllerAimPose[side] : m_controllerGripPose[side]);
+            } else {
+                continue;
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "ResolveActionSpace",
+                              TLXArg(&xrSpace, "Space"),
+                              TLArg(fullPath.c_str(), "ActionSourcePath"),
+                              TLArg(version, "Version"));
+
+            // Per spec we must consistently pick one source. We pick the first one.
+            break;
+        }
+
+        // Set last, since it marks the binding as complete.
+        binding->version = version;
+
+        return binding;
+    }
+
     XrSpaceLocationFlags OpenXrRuntime::getHmdPose(XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const {
         XrSpaceLocationFlags locationFlags = 0;
         pvrPoseStatef state{};
-        CHECK_PVRCMD(pvr_getTrackedDevicePoseState(m_pvrSession, pvrTrackedDevice_HMD, xrTimeToPvrTime(time), &state));
+        const bool isFromHistory = getPoseFromHistory(m_hmdPoseHistory, time, state);
+        if (!isFromHistory) {
+            CHECK_PVRCMD(
+                pvr_getTrackedDevicePoseState(m_pvrSession, pvrTrackedDevice_HMD, xrTimeToPvrTime(time), &state));
+        }
         TraceLoggingWrite(g_traceProvider,
                           "PVR_HmdPoseState",
+                          TLArg(isFromHistory, "FromHistory"),
                           TLArg(state.StatusFlags, "StatusFlags"),
                           TLArg(xr::ToString(state.ThePose).c_str(), "Pose"),
                           TLArg(xr::ToString(state.AngularVelocity).c_str(), "AngularVelocity"),
@@ -459,14 +570,18 @@ namespace pimax_openxr {
     OpenXrRuntime::getControllerPose(int side, XrTime time, XrPosef& pose, XrSpaceVelocity* velocity) const {
         XrSpaceLocationFlags locationFlags = 0;
         pvrPoseStatef state{};
-        CHECK_PVRCMD(pvr_getTrackedDevicePoseState(m_pvrSession,
-                                                   side == 0 ? pvrTrackedDevice_LeftController
-                                                             : pvrTrackedDevice_RightController,
-                                                   xrTimeToPvrTime(time),
-                                                   &state));
+        const bool isFromHistory = getPoseFromHistory(m_controllerPoseHistory[side], time, state);
+        if (!isFromHistory) {
+            CHECK_PVRCMD(pvr_getTrackedDevicePoseState(m_pvrSession,
+                                                       side == 0 ? pvrTrackedDevice_LeftController
+                                                                 : pvrTrackedDevice_RightController,
+                                                       xrTimeToPvrTime(time),
+                                                       &state));
+        }
         TraceLoggingWrite(g_traceProvider,
                           "PVR_ControllerPoseState",
                           TLArg(side == 0 ? "Left" : "Right", "Side"),
+                          TLArg(isFromHistory, "FromHistory"),
                           TLArg(state.StatusFlags, "StatusFlags"),
                           TLArg(xr::ToString(state.ThePose).c_str(), "Pose"),
                           TLArg(xr::ToString(state.AngularVelocity).c_str(), "AngularVelocity"),
@@ -500,4 +615,36 @@ namespace pimax_openxr {
         return locationFlags;
     }
 
+    // Interpolate a pose in the recent past from the history recorded by the input sampler. Returns false when the
+    // pose must be queried from PVR instead, which includes all predictions into the future.
+    bool OpenXrRuntime::getPoseFromHistory(const PoseHistory& history, XrTime time, pvrPoseStatef& state) const {
+        if (!m_usePoseHistory || !m_inputSamplerThread.joinable()) {
+            return false;
+        }
+
+        // Do not interpolate across gaps where the sampler was stalled.
+        const auto sample = history.sample(xrTimeToPvrTime(time), 4.0 / m_inputSamplingRate);
+        if (!sample) {
+            return false;
+        }
+
+        state = {};
+        state.ThePose.Orientation.x = (float)sample->orientation.x;
+        state.ThePose.Orientation.y = (float)sample->orientation.y;
+        state.ThePose.Orientation.z = (float)sample->orientation.z;
+        state.ThePose.Orientation.w = (float)sample->orientation.w;
+        state.ThePose.Position.x = (float)sample->position.x;
+        state.ThePose.Position.y = (float)sample->position.y;
+        state.ThePose.Position.z = (float)sample->position.z;
+        state.LinearVelocity.x = (float)sample->linearVelocity.x;
+        state.LinearVelocity.y = (float)sample->linearVelocity.y;
+        state.LinearVelocity.z = (float)sample->linearVelocity.z;
+        state.AngularVelocity.x = (float)sample->angularVelocity.x;
+        state.AngularVelocity.y = (float)sample->angularVelocity.y;
+        state.AngularVelocity.z = (float)sample->angularVelocity.z;
+        state.StatusFlags = sample->statusFlags;
+
+        return true;
+    }
+
 } // namespace pimax_openxr
@@ -0,0 +1,94 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// Record the duration of each phase of the startup (eg: loader negotiation, PVR initialization, session creation), so
+// that regressions show in the log.
+
+namespace pimax_openxr::startup_timeline {
+
+    using Clock = std::chrono::steady_clock;
+
+    class Timeline {
+      public:
+        // Record a phase that started at begin and completed now. Only the first occurrence of a phase is kept, since
+        // later ones (eg: a second session) are not part of the startup. Returns whether the phase was recorded.
+        bool record(const std::string& phase, Clock::time_point begin, Clock::time_point end = Clock::now()) {
+            std::unique_lock lock(m_mutex);
+
+            for (const auto& entry : m_phases) {
+                if (entry.name == phase) {
+                    return false;
+                }
+            }
+            if (m_phases.empty() || begin < m_origin) {
+                m_origin = begin;
+            }
+            m_phases.push_back({phase, begin, end});
+            return true;
+        }
+
+        // Format the phases in the order they were recorded, with their duration and their completion time relative to
+        // the start of the first phase, eg: "pvr_init 120.3 ms (+120.5 ms)".
+        std::string format() const {
+            std::unique_lock lock(m_mutex);
+
+            std::string result;
+            for (const auto& entry : m_phases) {
+                char buf[128];
+                snprintf(buf,
+                         sizeof(buf),
+                         "%s%s %.1f ms (+%.1f ms)",
+                         result.empty() ? "" : ", ",
+                         entry.name.c_str(),
+                         toMs(entry.end - entry.begin),
+                         toMs(entry.end - m_origin));
+                result += buf;
+            }
+            return result;
+        }
+
+        size_t getCount() const {
+            std::unique_lock lock(m_mutex);
+            return m_phases.size();
+        }
+
+      private:
+        struct Phase {
+            std::string name;
+            Clock::time_point begin;
+            Clock::time_point end;
+        };
+
+        static double toMs(Clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        mutable std::mutex m_mutex;
+        std::vector<Phase> m_phases;
+        Clock::time_point m_origin{};
+    };
+
+} // namespace pimax_openxr::startup_timeline
@@ -22,6 +22,7 @@
 
 #include "pch.h"
 
+#include "composition.h"
 #include "log.h"
 #include "runtime.h"
 #include "utils.h"
@@ -37,8 +38,11 @@ namespace pimax_openxr {
                                                           uint32_t viewConfigurationTypeCapacityInput,
                                                           uint32_t* viewConfigurationTypeCountOutput,
                                                           XrViewConfigurationType* viewConfigurationTypes) {
-        // We only support Stereo 3D.
-        static const XrViewConfigurationType types[] = {XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+        // We support Stereo 3D, and quad views (stereo with a focus view per eye) when enabled.
+        std::vector<XrViewConfigurationType> types{XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+        if (has_XR_VARJO_quad_views) {
+            types.push_back(XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+        }
 
         TraceLoggingWrite(g_traceProvider,
                           "xrEnumerateViewConfigurations",
@@ -54,11 +58,11 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationTypeCapacityInput && viewConfigurationTypeCapacityInput < ARRAYSIZE(types)) {
+        if (viewConfigurationTypeCapacityInput && viewConfigurationTypeCapacityInput < types.size()) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
 
-        *viewConfigurationTypeCountOutput = ARRAYSIZE(types);
+        *viewConfigurationTypeCountOutput = (uint32_t)types.size();
         TraceLoggingWrite(g_traceProvider,
                           "xrEnumerateViewConfigurations",
                           TLArg(*viewConfigurationTypeCountOutput, "ViewConfigurationTypeCountOutput"));
@@ -98,11 +102,11 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        configurationProperties->viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        configurationProperties->viewConfigurationType = viewConfigurationType;
         configurationProperties->fovMutable = XR_TRUE;
 
         TraceLoggingWrite(g_traceProvider,
@@ -135,15 +139,16 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        if (viewCapacityInput && viewCapacityInput < xr::StereoView::Count) {
+        const uint32_t viewCount = getViewCount(viewConfigurationType);
+        if (viewCapacityInput && viewCapacityInput < viewCount) {
             return XR_ERROR_SIZE_INSUFFICIENT;
         }
 
-        *viewCountOutput = xr::StereoView::Count;
+        *viewCountOutput = viewCount;
         TraceLoggingWrite(
             g_traceProvider, "xrEnumerateViewConfigurationViews", TLArg(*viewCountOutput, "ViewCountOutput"));
 
@@ -166,11 +171,57 @@ namespace pimax_openxr {
                 // Recommend the resolution with distortion accounted for.
                 // There is a DistortedViewport in the EyeInfo struct, however the sample code uses
                 // pvr_getFovTextureSize() instead, so let's follow the example.
+                const uint32_t eye = i % xr::StereoView::Count;
+                pvrFovPort fov = m_cachedEyeInfo[eye].Fov;
+                float density = 1.f;
+                if (m_useUpscaling && viewCount == xr::StereoView::Count) {
+                    // The views are upscaled to the native resolution upon submission.
+                    density = m_upscalingScale;
+                } else if (viewCount > xr::StereoView::Count) {
+                    if (i < xr::StereoView::Count) {
+                        // Peripheral views are rendered at a lower pixel density.
+                        density = m_quadViewsPeripheralDensity;
+                    } else {
+                        // Focus views are rendered at full pixel density, but only cover a fraction of the FOV.
+                        const XrFoveatedViewConfigurationViewVARJO* foveatedView =
+                            reinterpret_cast<const XrFoveatedViewConfigurationViewVARJO*>(views[i].next);
+                        while (foveatedView) {
+                            if (foveatedView->type == XR_TYPE_FOVEATED_VIEW_CONFIGURATION_VIEW_VARJO) {
+                                break;
+                            }
+                            foveatedView =
+                                reinterpret_cast<const XrFoveatedViewConfigurationViewVARJO*>(foveatedView->next);
+                        }
+                        const bool foveated =
+                            has_XR_VARJO_foveated_rendering && foveatedView && foveatedView->foveatedRenderingActive;
+
+                        XrFovf peripheralFov;
+                        peripheralFov.angleDown = -atan(fov.DownTan);
+                        peripheralFov.angleUp = atan(fov.UpTan);
+                        peripheralFov.angleLeft = -atan(fov.LeftTan);
+                        peripheralFov.angleRight = atan(fov.RightTan);
+
+                        // The placement of the focus view does not matter here, only its size.
+                        const XrFovf focusFov = composition::computeFocusFov(
+                            peripheralFov,
+                            foveated ? m_quadViewsFoveatedFocusSize : m_quadViewsFocusSize,
+                            composition::getFovCenter(peripheralFov));
+                        fov.DownTan = -tan(focusFov.angleDown);
+                        fov.UpTan = tan(focusFov.angleUp);
+                        fov.LeftTan = -tan(focusFov.angleLeft);
+                        fov.RightTan = tan(focusFov.angleRight);
+                    }
+                }
+
                 pvrSizei viewportSize;
                 CHECK_PVRCMD(pvr_getFovTextureSize(
-                    m_pvrSession, !i ? pvrEye_Left : pvrEye_Right, m_cachedEyeInfo[i].Fov, 1.0f, &viewportSize));
+                    m_pvrSession, !eye ? pvrEye_Left : pvrEye_Right, fov, density, &viewportSize));
                 views[i].recommendedImageRectWidth = viewportSize.w;
                 views[i].recommendedImageRectHeight = viewportSize.h;
+                if (i < xr::StereoView::Count) {
+                    // Needed to estimate the render scale that the application actually uses.
+                    m_recommendedViewSize[eye] = viewportSize;
+                }
 
                 if (!m_loggedResolution) {
                     Log("Recommended resolution: %ux%u\n",
@@ -385,13 +436,12 @@ namespace pimax_openxr {
         // - PVR does not like the D32_FLOAT_S8X24 format.
         //   To mitigate this, we will create a D32_FLOAT swapchain and perform a conversion during xrEndFrame().
 
-        pvrTextureSwapChain pvrSwapchain{};
         bool needDepthResolve = false;
         if (desc.Format == PVR_FORMAT_D32_FLOAT_S8X24_UINT) {
             desc.Format = PVR_FORMAT_D32_FLOAT;
             needDepthResolve = true;
         }
-        CHECK_PVRCMD(pvr_createTextureSwapChainDX(m_pvrSession, m_d3d11Device.Get(), &desc, &pvrSwapchain));
+        const pvrTextureSwapChain pvrSwapchain = createPvrSwapchain(desc);
 
         // Create the internal struct.
         Swapchain& xrSwapchain = *new Swapchain;
@@ -401,6 +451,7 @@ namespace pimax_openxr {
         xrSwapchain.pvrDesc = desc;
         xrSwapchain.xrDesc = *createInfo;
         xrSwapchain.needDepthResolve = needDepthResolve;
+        trackSwapchainMemory(gpu_memory::Category::Swapchain, &xrSwapchain, desc, pvrSwapchain);
 
         // Lazily-filled state.
         for (int i = 1; i < desc.ArraySize; i++) {
@@ -408,6 +459,7 @@ namespace pimax_openxr {
             xrSwapchain.slices.push_back({});
             xrSwapchain.imagesResourceView.push_back({});
         }
+        xrSwapchain.sliceTracker.reset(desc.ArraySize);
 
         *swapchain = (XrSwapchain)&xrSwapchain;
 
@@ -432,57 +484,8 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        // Make sure there are no pending operations.
-        if (isD3D12Session()) {
-            flushD3D12CommandQueue();
-        } else if (isVulkanSession()) {
-            flushVulkanCommandQueue();
-        } else if (isOpenGLSession()) {
-            flushOpenGLContext();
-        } else {
-            flushD3D11Context();
-        }
-
-        Swapchain& xrSwapchain = *(Swapchain*)swapchain;
-
-        while (!xrSwapchain.pvrSwapchain.empty()) {
-            auto pvrSwapchain = xrSwapchain.pvrSwapchain.back();
-            if (pvrSwapchain) {
-                pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
-            }
-            xrSwapchain.pvrSwapchain.pop_back();
-        }
-
-        while (!xrSwapchain.vkImages.empty()) {
-            m_vkDispatch.vkDestroyImage(m_vkDevice, xrSwapchain.vkImages.back(), m_vkAllocator);
-            xrSwapchain.vkImages.pop_back();
-        }
-
-        while (!xrSwapchain.vkDeviceMemory.empty()) {
-            m_vkDispatch.vkFreeMemory(m_vkDevice, xrSwapchain.vkDeviceMemory.back(), m_vkAllocator);
-            xrSwapchain.vkDeviceMemory.pop_back();
-        }
-
-        if (xrSwapchain.vkCmdBuffer != VK_NULL_HANDLE) {
-            m_vkDispatch.vkFreeCommandBuffers(m_vkDevice, m_vkCmdPool, 1, &xrSwapchain.vkCmdBuffer);
-        }
-
-        // This will be a no-op if OpenGL is not used.
-        GlContextSwitch context(m_glContext);
-
-        while (!xrSwapchain.glImages.empty()) {
-            GLuint image = xrSwapchain.glImages.back();
-            glDeleteTextures(1, &image);
-            xrSwapchain.glImages.pop_back();
-        }
-
-        while (!xrSwapchain.glMemory.empty()) {
-            GLuint memory = xrSwapchain.glMemory.back();
-            m_glDispatch.glDeleteMemoryObjectsEXT(1, &memory);
-            xrSwapchain.glMemory.pop_back();
-        }
-
-        delete &xrSwapchain;
+        // The swapchain is destroyed once the GPU is done with it, see releaseRetiredSwapchains().
+        retireSwapchain(*(Swapchain*)swapchain);
         m_swapchains.erase(swapchain);
 
         return XR_SUCCESS;
@@ -630,4 +633,230 @@ namespace pimax_openxr {
         return XR_SUCCESS;
     }
 
+    // Signal the retirement fence after the work recorded so far on the D3D11 context, and return the value to wait
+    // for.
+    UINT64 OpenXrRuntime::signalRetirementFence() {
+        m_retirementFenceValue++;
+        CHECK_HRCMD(m_d3d11DeviceContext->Signal(m_retirementFence.Get(), m_retirementFenceValue));
+        m_d3d11DeviceContext->Flush();
+        return m_retirementFenceValue;
+    }
+
+    // Queue the destruction of a swapchain for when the GPU is done with it, without waiting. This does not touch the
+    // D3D11 context, which the submission thread may be using (pvr_endFrame()): the retirement fence is signaled by the
+    // next xrEndFrame(), see signalRetiredSwapchains().
+    void OpenXrRuntime::retireSwapchain(Swapchain& xrSwapchain) {
+        m_unsignaledRetiredSwapchains.push_back(&xrSwapchain);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "RetireSwapchain",
+                          TLPArg(&xrSwapchain, "Swapchain"),
+                          TLArg(m_unsignaledRetiredSwapchains.size(), "UnsignaledCount"));
+    }
+
+    // Signal the retirement fence for the swapchains retired since the last call. Must be called with m_swapchainsLock
+    // and m_frameLock held, no submission pending, and after the application's work was serialized with the D3D11
+    // context (which may still copy from the swapchains).
+    void OpenXrRuntime::signalRetiredSwapchains() {
+        if (m_unsignaledRetiredSwapchains.empty()) {
+            return;
+        }
+
+        const UINT64 fenceValue = signalRetirementFence();
+        for (Swapchain* xrSwapchain : m_unsignaledRetiredSwapchains) {
+            m_retiredSwapchains.push(fenceValue, xrSwapchain);
+        }
+        m_unsignaledRetiredSwapchains.clear();
+
+        TraceLoggingWrite(g_traceProvider,
+                          "SignalRetiredSwapchains",
+                          TLArg(fenceValue, "FenceValue"),
+                          TLArg(m_retiredSwapchains.size(), "PendingCount"));
+    }
+
+    // Destroy the retired swapchains that the GPU is done with, and recycle the retired runtime swapchains. Must be
+    // called with m_swapchainsLock held, and no submission pending.
+    void OpenXrRuntime::releaseRetiredSwapchains(bool wait) {
+        if (m_retiredSwapchains.empty() && m_retiredRuntimeSwapchains.empty()) {
+            return;
+        }
+
+        if (wait) {
+            TraceLocalActivity(waitRetirement);
+            TraceLoggingWriteStart(waitRetirement, "WaitRetirement", TLArg(m_retirementFenceValue, "FenceValue"));
+            wil::unique_event eventHandle;
+            eventHandle.create();
+            CHECK_HRCMD(m_retirementFence->SetEventOnCompletion(m_retirementFenceValue, eventHandle.get()));
+            eventHandle.wait();
+            TraceLoggingWriteStop(waitRetirement, "WaitRetirement");
+        }
+
+        const auto release = [&](Swapchain* xrSwapchain) {
+            TraceLoggingWrite(g_traceProvider, "ReleaseSwapchain", TLPArg(xrSwapchain, "Swapchain"));
+            destroySwapchainResources(*xrSwapchain);
+        };
+        const auto recycle = [&](const std::pair<pvrTextureSwapChainDesc, pvrTextureSwapChain>& retired) {
+            retirePvrSwapchain(retired.first, retired.second);
+        };
+        const UINT64 completedValue = m_retirementFence->GetCompletedValue();
+        const size_t count = m_retiredSwapchains.drain(completedValue, release) +
+                             m_retiredRuntimeSwapchains.drain(completedValue, recycle);
+        if (count) {
+            reportGpuMemory();
+        }
+    }
+
+    void OpenXrRuntime::destroySwapchainResources(Swapchain& xrSwapchain) {
+        m_gpuMemory.releaseAll(&xrSwapchain);
+
+        // The GPU is done with the PVR swapchains, they can be recycled.
+        while (!xrSwapchain.pvrSwapchain.empty()) {
+            auto pvrSwapchain = xrSwapchain.pvrSwapchain.back();
+            if (pvrSwapchain) {
+                auto desc = xrSwapchain.pvrDesc;
+                if (xrSwapchain.pvrSwapchain.size() > 1) {
+                    // The swapchains for the slices of a texture array.
+                    desc.ArraySize = 1;
+                }
+                retirePvrSwapchain(desc, pvrSwapchain);
+            }
+            xrSwapchain.pvrSwapchain.pop_back();
+        }
+
+        while (!xrSwapchain.vkImages.empty()) {
+            m_vkDispatch.vkDestroyImage(m_vkDevice, xrSwapchain.vkImages.back(), m_vkAllocator);
+            xrSwapchain.vkImages.pop_back();
+        }
+
+        while (!xrSwapchain.vkDeviceMemory.empty()) {
+            m_vkDispatch.vkFreeMemory(m_vkDevice, xrSwapchain.vkDeviceMemory.back(), m_vkAllocator);
+            xrSwapchain.vkDeviceMemory.pop_back();
+        }
+
+        if (xrSwapchain.vkCmdBuffer != VK_NULL_HANDLE) {
+            m_vkDispatch.vkFreeCommandBuffers(m_vkDevice, m_vkCmdPool, 1, &xrSwapchain.vkCmdBuffer);
+        }
+
+        // This will be a no-op if OpenGL is not used.
+        GlContextSwitch context(m_glContext);
+
+        while (!xrSwapchain.glImages.empty()) {
+            GLuint image = xrSwapchain.glImages.back();
+            glDeleteTextures(1, &image);
+            xrSwapchain.glImages.pop_back();
+        }
+
+        while (!xrSwapchain.glMemory.empty()) {
+            GLuint memory = xrSwapchain.glMemory.back();
+            m_glDispatch.glDeleteMemoryObjectsEXT(1, &memory);
+            xrSwapchain.glMemory.pop_back();
+        }
+
+        delete &xrSwapchain;
+    }
+
+    // Create a PVR swapchain, or reuse a swapchain with the same properties that the application released.
+    pvrTextureSwapChain OpenXrRuntime::createPvrSwapchain(const pvrTextureSwapChainDesc& desc) {
+        uint64_t size = 0;
+        const auto recycled = m_swapchainPool.take(desc, &size);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "SwapchainPool_Take",
+                          TLArg(recycled.has_value(), "Recycled"),
+                          TLArg(m_swapchainPool.getCount(), "PoolCount"),
+                          TLArg(m_swapchainPool.getHitCount(), "HitCount"),
+                          TLArg(m_swapchainPool.getMissCount(), "MissCount"));
+
+        if (recycled) {
+            m_gpuMemory.release(gpu_memory::Category::SwapchainPool, &m_swapchainPool, size);
+            return recycled.value();
+        }
+
+        pvrTextureSwapChain pvrSwapchain{};
+        CHECK_PVRCMD(pvr_createTextureSwapChainDX(m_pvrSession, m_d3d11Device.Get(), &desc, &pvrSwapchain));
+
+        return pvrSwapchain;
+    }
+
+    // Keep a PVR swapchain for a later creation, or destroy it. The GPU must be done with the swapchain.
+    void OpenXrRuntime::retirePvrSwapchain(const pvrTextureSwapChainDesc& desc, pvrTextureSwapChain pvrSwapchain) {
+        const auto destroy = [&](pvrTextureSwapChain pvrSwapchain, uint64_t size) {
+            pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
+            m_gpuMemory.release(gpu_memory::Category::SwapchainPool, &m_swapchainPool, size);
+        };
+
+        // Static images can only be committed once.
+        if (desc.StaticImage) {
+            pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
+            return;
+        }
+
+        const uint64_t size = getSwapchainMemorySize(desc, pvrSwapchain);
+        m_gpuMemory.add(gpu_memory::Category::SwapchainPool, &m_swapchainPool, size);
+        m_swapchainPool.retire(desc, pvrSwapchain, size, destroy);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "SwapchainPool_Retire",
+                          TLArg(m_swapchainPool.getCount(), "PoolCount"),
+                          TLArg(m_swapchainPool.getSize(), "PoolSize"),
+                          TLArg(m_swapchainPool.getEvictedCount(), "EvictedCount"));
+    }
+
+    void OpenXrRuntime::clearSwapchainPool() {
+        m_swapchainPool.clear([&](pvrTextureSwapChain pvrSwapchain, uint64_t size) {
+            pvr_destroyTextureSwapChain(m_pvrSession, pvrSwapchain);
+            m_gpuMemory.release(gpu_memory::Category::SwapchainPool, &m_swapchainPool, size);
+        });
+    }
+
+    uint64_t OpenXrRuntime::getSwapchainMemorySize(const pvrTextureSwapChainDesc& desc,
+                                                   pvrTextureSwapChain pvrSwapchain) const {
+        int count = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainLength(m_pvrSession, pvrSwapchain, &count));
+
+        return gpu_memory::estimateTextureSize(desc.Width,
+                                               desc.Height,
+                                               desc.ArraySize,
+                                               desc.MipLevels,
+                                               desc.SampleCount,
+                                               pvrGetBitsPerPixel(desc.Format)) *
+               count;
+    }
+
+    // Record the memory of a PVR swapchain (all its images) in the accounting.
+    void OpenXrRuntime::trackSwapchainMemory(gpu_memory::Category category,
+                                             const void* owner,
+                                             const pvrTextureSwapChainDesc& desc,
+                                             pvrTextureSwapChain pvrSwapchain) {
+        m_gpuMemory.add(category, owner, getSwapchainMemorySize(desc, pvrSwapchain));
+        reportGpuMemory();
+    }
+
+    void OpenXrRuntime::reportGpuMemory() const {
+        constexpr double MB = 1024.0 * 1024.0;
+
+        TraceLoggingWrite(
+            g_traceProvider,
+            "GpuMemory",
+            TLArg(m_gpuMemory.getTotal(), "TotalBytes"),
+            TLArg(m_gpuMemory.getTotal(gpu_memory::Category::Swapchain), "SwapchainBytes"),
+            TLArg(m_gpuMemory.getTotal(gpu_memory::Category::SliceSwapchain), "SliceSwapchainBytes"),
+            TLArg(m_gpuMemory.getTotal(gpu_memory::Category::DepthResolveImage), "DepthResolveImageBytes"),
+            TLArg(m_gpuMemory.getTotal(gpu_memory::Category::ResolveScratch), "ResolveScratchBytes"),
+            TLArg(m_gpuMemory.getTotal(gpu_memory::Category::RuntimeSwapchain), "RuntimeSwapchainBytes"),
+            TLArg(m_gpuMemory.getTotal(gpu_memory::Category::SwapchainPool), "SwapchainPoolBytes"),
+            TLArg(m_gpuMemory.getPeak(), "PeakBytes"));
+
+        std::string details;
+        for (uint32_t i = 0; i < (uint32_t)gpu_memory::Category::Count; i++) {
+            const auto category = (gpu_memory::Category)i;
+            const auto size = m_gpuMemory.getTotal(category);
+            if (size) {
+                details += fmt::format(
+                    "{}{}: {:.1f} MB", details.empty() ? "" : ", ", gpu_memory::ToString(category), size / MB);
+            }
+        }
+        Log("GPU memory allocated by the runtime: %.1f MB (%s)\n", m_gpuMemory.getTotal() / MB, details.c_str());
+    }
+
 } // namespace pimax_openxr
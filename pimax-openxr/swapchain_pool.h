@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+// A pool of retired swapchains, so that an application recreating swapchains with the same properties (eg: when
+// changing its resolution back and forth) does not pay for the creation again.
+
+namespace pimax_openxr::swapchain_pool {
+
+    template <typename Desc, typename Handle, typename DescEqual = std::equal_to<Desc>>
+    class RecyclingPool {
+      public:
+        // A size of 0 disables recycling.
+        void setMaxSize(uint64_t maxSize) {
+            m_maxSize = maxSize;
+        }
+
+        uint64_t getMaxSize() const {
+            return m_maxSize;
+        }
+
+        // Keep a swapchain that is no longer used by the GPU. The least recently retired swapchains are evicted to stay
+        // within the maximum size, which may include the one being retired. The onEvict() function is called with the
+        // handle of each evicted swapchain, for the caller to destroy it.
+        template <typename OnEvict>
+        void retire(const Desc& desc, Handle handle, uint64_t size, OnEvict&& onEvict) {
+            m_entries.push_back({desc, handle, size});
+            m_size += size;
+
+            while (m_size > m_maxSize) {
+                const Entry oldest = m_entries.front();
+                m_entries.pop_front();
+                m_size -= oldest.size;
+                m_evictedCount++;
+                onEvict(oldest.handle, oldest.size);
+            }
+        }
+
+        // Take the most recently retired swapchain with the same properties, if any.
+        std::optional<Handle> take(const Desc& desc, uint64_t* size = nullptr) {
+            for (auto it = m_entries.rbegin(); it != m_entries.rend(); it++) {
+                if (DescEqual()(it->desc, desc)) {
+                    const Handle handle = it->handle;
+                    if (size) {
+                        *size = it->size;
+                    }
+                    m_size -= it->size;
+                    m_entries.erase(std::next(it).base());
+                    m_hitCount++;
+                    return handle;
+                }
+            }
+
+            m_missCount++;
+            return {};
+        }
+
+        template <typename OnEvict>
+        void clear(OnEvict&& onEvict) {
+            while (!m_entries.empty()) {
+                const Entry oldest = m_entries.front();
+                m_entries.pop_front();
+                m_size -= oldest.size;
+                onEvict(oldest.handle, oldest.size);
+            }
+        }
+
+        size_t getCount() const {
+            return m_entries.size();
+        }
+
+        uint64_t getSize() const {
+            return m_size;
+        }
+
+        uint64_t getHitCount() const {
+            return m_hitCount;
+        }
+
+        uint64_t getMissCount() const {
+            return m_missCount;
+        }
+
+        uint64_t getEvictedCount() const {
+            return m_evictedCount;
+        }
+
+      private:
+        struct Entry {
+            Desc desc;
+            Handle handle;
+            uint64_t size;
+        };
+
+        // Ordered from the least to the most recently retired.
+        std::deque<Entry> m_entries;
+        uint64_t m_size{0};
+        uint64_t m_maxSize{0};
+
+        uint64_t m_hitCount{0};
+        uint64_t m_missCount{0};
+        uint64_t m_evictedCount{0};
+    };
+
+} // namespace pimax_openxr::swapchain_pool
@@ -37,6 +37,8 @@ namespace pimax_openxr {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
+        const auto startupBegin = startup_timeline::Clock::now();
+
         TraceLoggingWrite(g_traceProvider,
                           "xrGetSystem",
                           TLXArg(instance, "Instance"),
@@ -51,6 +53,7 @@ namespace pimax_openxr {
         }
 
         // Create the PVR session.
+        waitForPvr();
         if (!m_pvrSession) {
             CHECK_PVRCMD(pvr_createSession(m_pvr, &m_pvrSession));
         }
@@ -99,6 +102,146 @@ namespace pimax_openxr {
                           TLArg(CONFIG_KEY_EYE_HEIGHT, "Config"),
                           TLArg(m_floorHeight, "EyeHeight"));
 
+        // Check for eye tracking. The simulated eye tracker lets us exercise the feature without the hardware.
+        m_useSimulatedEyeTracker = getSetting("debug_eye_tracker").value_or(0);
+        if (m_useSimulatedEyeTracker) {
+            m_isEyeTrackingAvailable = true;
+        } else {
+            // PVR succeeds the query on headsets without an eye tracker, but it never produces a sample then.
+            pvrEyeTrackingInfo eyeTrackingInfo{};
+            m_isEyeTrackingAvailable =
+                pvr_getEyeTrackingInfo(m_pvrSession, pvr_getTimeSeconds(m_pvr), &eyeTrackingInfo) == pvr_success &&
+                eyeTrackingInfo.TimeInSeconds > 0;
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "PVR_EyeTracker",
+                          TLArg(m_isEyeTrackingAvailable, "Available"),
+                          TLArg(m_useSimulatedEyeTracker, "Simulated"));
+        if (m_isEyeTrackingAvailable) {
+            Log("Eye tracking is available%s\n", m_useSimulatedEyeTracker ? " (simulated)" : "");
+        }
+
+        // Parameters for the quad views, expressed in percent.
+        m_quadViewsPeripheralDensity =
+            std::clamp(getSetting("quad_views_peripheral_density").value_or(50), 10, 100) / 100.f;
+        m_quadViewsFocusSize = std::clamp(getSetting("quad_views_focus_size").value_or(50), 10, 100) / 100.f;
+        m_quadViewsFoveatedFocusSize =
+            std::clamp(getSetting("quad_views_foveated_focus_size").value_or(35), 10, 100) / 100.f;
+        m_quadViewsFeather = std::clamp(getSetting("quad_views_feather").value_or(5), 0, 50) / 100.f;
+
+        // Parameters for the upscaling, expressed in percent. The scale applies to each dimension.
+        m_useUpscaling = getSetting("upscaling").value_or(0);
+        m_upscalingScale = std::clamp(getSetting("upscaling_scale").value_or(75), 50, 100) / 100.f;
+        m_upscalingSharpness = std::clamp(getSetting("upscaling_sharpness").value_or(40), 0, 100) / 100.f;
+        if (m_useUpscaling) {
+            Log("Upscaling is enabled (scale: %.0f%%, sharpness: %.0f%%)\n",
+                m_upscalingScale * 100.f,
+                m_upscalingSharpness * 100.f);
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "Upscaling_Settings",
+                          TLArg(m_useUpscaling, "Enabled"),
+                          TLArg(m_upscalingScale, "Scale"),
+                          TLArg(m_upscalingSharpness, "Sharpness"));
+
+        // Parameters for the dynamic resolution, expressed in percent. The governor only runs for applications that
+        // can consume its recommendation.
+        m_useDynamicResolution = m_isDynamicResolutionRequested && getSetting("dynamic_resolution").value_or(1);
+        m_dynamicResolutionSettings.targetUtilization =
+            std::clamp(getSetting("dynamic_resolution_target").value_or(90), 50, 100) / 100.f;
+        m_dynamicResolutionSettings.minScale =
+            std::clamp(getSetting("dynamic_resolution_min_scale").value_or(50), 25, 100) / 100.f;
+        if (m_useDynamicResolution) {
+            Log("Dynamic resolution is enabled (target: %.0f%%, min scale: %.0f%%)\n",
+                m_dynamicResolutionSettings.targetUtilization * 100.f,
+                m_dynamicResolutionSettings.minScale * 100.f);
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "DynamicResolution_Settings",
+                          TLArg(m_useDynamicResolution, "Enabled"),
+                          TLArg(m_dynamicResolutionSettings.targetUtilization, "TargetUtilization"),
+                          TLArg(m_dynamicResolutionSettings.minScale, "MinScale"));
+
+        // Parameters for the smoothing governor. The release threshold is expressed in percent of the frame budget.
+        m_useSmoothingGovernor = getSetting("smoothing_governor").value_or(0);
+        m_smoothingGovernorSettings.releaseLoad =
+            std::clamp(getSetting("smoothing_governor_release").value_or(80), 50, 95) / 100.f;
+        if (m_useSmoothingGovernor) {
+            Log("Smoothing governor is enabled (release: %.0f%%)\n", m_smoothingGovernorSettings.releaseLoad * 100.f);
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "SmoothingGovernor_Settings",
+                          TLArg(m_useSmoothingGovernor, "Enabled"),
+                          TLArg(m_smoothingGovernorSettings.releaseLoad, "ReleaseLoad"));
+        if (!m_smoothingGovernorSavedConfig) {
+            restoreSmoothingConfig();
+        }
+
+        // Whether pvr_endFrame() is called from a dedicated thread instead of the application's thread.
+        m_useAsyncSubmission = getSetting("async_submission").value_or(0);
+        if (m_useAsyncSubmission) {
+            Log("Asynchronous frame submission is enabled\n");
+        }
+        TraceLoggingWrite(g_traceProvider, "AsyncSubmission_Settings", TLArg(m_useAsyncSubmission, "Enabled"));
+
+        // The rate (in Hz) at which the controllers are polled in the background. 0 polls them in xrSyncActions().
+        m_inputSamplingRate = std::clamp(getSetting("input_sampling_rate").value_or(0), 0, 1000);
+        if (m_inputSamplingRate) {
+            m_inputSamplingRate = std::max(m_inputSamplingRate, 60u);
+            Log("Input sampling rate is %u Hz\n", m_inputSamplingRate);
+        }
+
+        // Whether the input sampler also records the poses, to answer queries in the recent past.
+        m_usePoseHistory = m_inputSamplingRate && getSetting("pose_history").value_or(1);
+        TraceLoggingWrite(g_traceProvider,
+                          "InputSampler_Settings",
+                          TLArg(m_inputSamplingRate, "SamplingRate"),
+                          TLArg(m_usePoseHistory, "PoseHistory"));
+
+        // Whether vibrations are played as trains of pulses honoring their frequency and duration.
+        m_useHapticsThread = getSetting("haptics_scheduler").value_or(0);
+        if (m_useHapticsThread) {
+            Log("Haptics scheduler is enabled\n");
+        }
+        TraceLoggingWrite(g_traceProvider, "Haptics_Settings", TLArg(m_useHapticsThread, "Enabled"));
+
+        // The budget (in MB) for keeping the swapchains released by the application, to serve later creations.
+        m_swapchainPool.setMaxSize(std::clamp(getSetting("swapchain_pool_size").value_or(0), 0, 4096) * 1024ull * 1024);
+        if (m_swapchainPool.getMaxSize()) {
+            Log("Swapchain pool size is %llu MB\n", m_swapchainPool.getMaxSize() / (1024 * 1024));
+        }
+        TraceLoggingWrite(g_traceProvider, "SwapchainPool_Settings", TLArg(m_swapchainPool.getMaxSize(), "MaxSize"));
+
+        // Whether the swapchains for the slices of texture arrays are created with the images instead of during the
+        // first xrEndFrame() using them.
+        m_useEagerSliceSwapchains = getSetting("eager_slice_swapchains").value_or(1);
+        if (!m_useEagerSliceSwapchains) {
+            Log("Slice swapchains are created on first use\n");
+        }
+        TraceLoggingWrite(g_traceProvider, "SliceSwapchain_Settings", TLArg(m_useEagerSliceSwapchains, "Eager"));
+
+        // Whether the device-level resources are kept after xrDestroySession(), for the next session to reuse them.
+        m_useWarmSessionRestart = getSetting("warm_session_restart").value_or(1);
+        if (!m_useWarmSessionRestart) {
+            Log("Warm session restart is disabled\n");
+        }
+
+        // Keeping the application's own device (D3D11 sessions) holds on to its ID3D11Device and context after the
+        // application destroyed its session, which it may not expect. Only the runtime's interop device is kept unless
+        // opted in.
+        m_useWarmSessionRestartAppDevice = getSetting("warm_session_restart_app_device").value_or(0);
+        if (m_useWarmSessionRestart && m_useWarmSessionRestartAppDevice) {
+            Log("Warm session restart keeps the application's device\n");
+        }
+        TraceLoggingWrite(g_traceProvider,
+                          "WarmSessionRestart_Settings",
+                          TLArg(m_useWarmSessionRestart, "Enabled"),
+                          TLArg(m_useWarmSessionRestartAppDevice, "AppDevice"));
+
+        if (!m_display) {
+            initializeDisplayRefreshRate();
+        }
+
         // Setup common parameters.
         CHECK_PVRCMD(pvr_setTrackingOriginType(m_pvrSession, pvrTrackingOrigin_EyeLevel));
 
@@ -107,6 +250,8 @@ namespace pimax_openxr {
 
         TraceLoggingWrite(g_traceProvider, "xrGetSystem", TLArg((int)*systemId, "SystemId"));
 
+        startupTimeline.record("system", startupBegin);
+
         return XR_SUCCESS;
     }
 
@@ -147,6 +292,40 @@ namespace pimax_openxr {
         properties->graphicsProperties.maxSwapchainImageWidth = 16384;
         properties->graphicsProperties.maxSwapchainImageHeight = 16384;
 
+        XrSystemEyeGazeInteractionPropertiesEXT* eyeGazeInteractionProperties =
+            reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(properties->next);
+        while (eyeGazeInteractionProperties) {
+            if (eyeGazeInteractionProperties->type == XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT) {
+                break;
+            }
+            eyeGazeInteractionProperties =
+                reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(eyeGazeInteractionProperties->next);
+        }
+        if (has_XR_EXT_eye_gaze_interaction && eyeGazeInteractionProperties) {
+            eyeGazeInteractionProperties->supportsEyeGazeInteraction = m_isEyeTrackingAvailable ? XR_TRUE : XR_FALSE;
+            TraceLoggingWrite(g_traceProvider,
+                              "xrGetSystemProperties",
+                              TLArg(!!eyeGazeInteractionProperties->supportsEyeGazeInteraction,
+                                    "SupportsEyeGazeInteraction"));
+        }
+
+        XrSystemFoveatedRenderingPropertiesVARJO* foveatedRenderingProperties =
+            reinterpret_cast<XrSystemFoveatedRenderingPropertiesVARJO*>(properties->next);
+        while (foveatedRenderingProperties) {
+            if (foveatedRenderingProperties->type == XR_TYPE_SYSTEM_FOVEATED_RENDERING_PROPERTIES_VARJO) {
+                break;
+            }
+            foveatedRenderingProperties =
+                reinterpret_cast<XrSystemFoveatedRenderingPropertiesVARJO*>(foveatedRenderingProperties->next);
+        }
+        if (has_XR_VARJO_foveated_rendering && foveatedRenderingProperties) {
+            foveatedRenderingProperties->supportsFoveatedRendering = m_isEyeTrackingAvailable ? XR_TRUE : XR_FALSE;
+            TraceLoggingWrite(g_traceProvider,
+                              "xrGetSystemProperties",
+                              TLArg(!!foveatedRenderingProperties->supportsFoveatedRendering,
+                                    "SupportsFoveatedRendering"));
+        }
+
         TraceLoggingWrite(g_traceProvider,
                           "xrGetSystemProperties",
                           TLArg((int)properties->systemId, "SystemId"),
@@ -186,7 +365,7 @@ namespace pimax_openxr {
             return XR_ERROR_SYSTEM_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
@@ -229,9 +408,13 @@ namespace pimax_openxr {
                           TLArg((int)info.eye_display, "EyeDisplay"),
                           TLArg((int)info.eye_rotate, "EyeRotate"));
 
-        // We also store the expected frame duration.
-        m_displayRefreshRate = info.refresh_rate;
-        m_frameDuration = 1.0 / info.refresh_rate;
+        // We also store the expected frame duration. The refresh rate may later be switched by the application.
+        {
+            std::unique_lock lock(m_frameLock);
+
+            m_displayRefreshRate = m_display->getCurrentRate();
+            m_frameDuration = 1.0 / m_displayRefreshRate;
+        }
 
         memcpy(&m_adapterLuid, &info.luid, sizeof(LUID));
     }
@@ -0,0 +1,474 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "composition.h"
+#include "log.h"
+#include "runtime.h"
+#include "utils.h"
+
+// Implements the optional upscaling of the projection views: the application is told to render at a lower resolution,
+// and the runtime upscales and sharpens each view to the native resolution before submission to PVR.
+
+namespace {
+
+    // Upscaling and sharpening passes. These must be kept in sync with composition::upscaleEdgeAdaptive(),
+    // composition::sharpenContrastAdaptive() and composition::upscaleDepthCpu().
+    const std::string_view UpscalingShaderHlsl = R"_(
+cbuffer config : register(b0) {
+    int2 sourceOffset;
+    int2 sourceExtent;
+    float2 sourceScale;
+    int2 outputExtent;
+    uint sourceSlice;
+    float sharpness;
+    int2 depthOffset;
+    int2 depthExtent;
+    float2 depthScale;
+    uint depthSlice;
+};
+Texture2DArray sourceTexture : register(t0);
+Texture2D intermediateTexture : register(t1);
+Texture2DArray depthTexture : register(t2);
+
+static const float Pi = 3.14159265358979;
+static const float UpscalingEdgeSensitivity = 4;
+static const float SharpeningLimit = 0.25 - 1.0 / 16;
+
+float4 fetchSource(int x, int y)
+{
+    const int2 pos = clamp(int2(x, y), int2(0, 0), sourceExtent - 1) + sourceOffset;
+    return sourceTexture.Load(int4(pos, (int)sourceSlice, 0));
+}
+
+float4 fetchIntermediate(int x, int y)
+{
+    return intermediateTexture.Load(int3(clamp(int2(x, y), int2(0, 0), outputExtent - 1), 0));
+}
+
+float luma(float4 color)
+{
+    return dot(color.rgb, float3(0.299, 0.587, 0.114));
+}
+
+float lanczos2(float x)
+{
+    if (x < 1e-5) {
+        return 1;
+    }
+    if (x >= 2) {
+        return 0;
+    }
+    return 2 * sin(Pi * x) * sin(Pi * x / 2) / (Pi * Pi * x * x);
+}
+
+float4 upscaleMain(float4 position : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET
+{
+    const float2 p = position.xy * sourceScale - 0.5;
+    const int2 base = (int2)floor(p);
+    const float2 f = p - (float2)base;
+
+    // Detect the edge direction from the gradient of the nearest 2x2 texels.
+    const float4 c00 = fetchSource(base.x, base.y);
+    const float4 c10 = fetchSource(base.x + 1, base.y);
+    const float4 c01 = fetchSource(base.x, base.y + 1);
+    const float4 c11 = fetchSource(base.x + 1, base.y + 1);
+    const float l00 = luma(c00);
+    const float l10 = luma(c10);
+    const float l01 = luma(c01);
+    const float l11 = luma(c11);
+    const float2 g = float2((l10 - l00) + (l11 - l01), (l01 - l00) + (l11 - l10)) * 0.5;
+    const float gradient = length(g);
+    const float2 dir = gradient > 1e-4 ? g / gradient : float2(1, 0);
+    const float stretch = 1 / (1 + saturate(gradient * UpscalingEdgeSensitivity));
+
+    float4 sum = 0;
+    float weights = 0;
+    [unroll] for (int j = -1; j <= 2; j++) {
+        [unroll] for (int i = -1; i <= 2; i++) {
+            const float2 o = float2(i, j) - f;
+            const float across = dot(o, dir);
+            const float along = (o.y * dir.x - o.x * dir.y) * stretch;
+            const float weight = lanczos2(sqrt(across * across + along * along));
+            sum += fetchSource(base.x + i, base.y + j) * weight;
+            weights += weight;
+        }
+    }
+    const float4 color = sum / max(weights, 1e-5);
+
+    // Anti-ringing.
+    return clamp(color, min(min(c00, c10), min(c01, c11)), max(max(c00, c10), max(c01, c11)));
+}
+
+float4 sharpenMain(float4 position : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET
+{
+    const int2 pos = (int2)position.xy;
+    const float4 b = fetchIntermediate(pos.x, pos.y - 1);
+    const float4 d = fetchIntermediate(pos.x - 1, pos.y);
+    const float4 e = fetchIntermediate(pos.x, pos.y);
+    const float4 f = fetchIntermediate(pos.x + 1, pos.y);
+    const float4 h = fetchIntermediate(pos.x, pos.y + 1);
+
+    const float3 mn = min(min(saturate(b.rgb), saturate(d.rgb)), min(saturate(f.rgb), saturate(h.rgb)));
+    const float3 mx = max(max(saturate(b.rgb), saturate(d.rgb)), max(saturate(f.rgb), saturate(h.rgb)));
+    const float3 hitMin = min(mn, saturate(e.rgb)) / max(4 * mx, 1e-5);
+    const float3 hitMax = (1 - max(mx, saturate(e.rgb))) / min(4 * mn - 4, -1e-5);
+    const float3 lobes = max(-hitMin, hitMax);
+    const float lobe = max(-SharpeningLimit, min(max(lobes.r, max(lobes.g, lobes.b)), 0)) * sharpness;
+
+    float4 color = ((b + d + f + h) * lobe + e) / (4 * lobe + 1);
+    color.a = e.a;
+    return color;
+}
+
+float depthMain(float4 position : SV_POSITION, float2 uv : TEXCOORD0) : SV_DEPTH
+{
+    const int2 pos = clamp((int2)(position.xy * depthScale), int2(0, 0), depthExtent - 1) + depthOffset;
+    return depthTexture.Load(int4(pos, (int)depthSlice, 0)).x;
+}
+    )_";
+
+    struct alignas(16) UpscalingConstants {
+        int32_t sourceOffset[2];
+        int32_t sourceExtent[2];
+        float sourceScale[2];
+        int32_t outputExtent[2];
+        uint32_t sourceSlice;
+        float sharpness;
+        int32_t depthOffset[2];
+        int32_t depthExtent[2];
+        float depthScale[2];
+        uint32_t depthSlice;
+    };
+
+} // namespace
+
+namespace pimax_openxr {
+
+    using namespace pimax_openxr::log;
+    using namespace pimax_openxr::utils;
+
+    // Lazily create the resources for upscaling.
+    void OpenXrRuntime::initializeUpscalingResources() {
+        if (m_upscalingPixelShader) {
+            return;
+        }
+
+        initializeCompositionResources();
+
+        {
+            const auto shaderBytes = compileShader(UpscalingShaderHlsl, "upscaleMain", "ps_5_0");
+            CHECK_HRCMD(m_d3d11Device->CreatePixelShader(shaderBytes->GetBufferPointer(),
+                                                         shaderBytes->GetBufferSize(),
+                                                         nullptr,
+                                                         m_upscalingPixelShader.ReleaseAndGetAddressOf()));
+            setDebugName(m_upscalingPixelShader.Get(), "Upscaling PS");
+        }
+        {
+            const auto shaderBytes = compileShader(UpscalingShaderHlsl, "sharpenMain", "ps_5_0");
+            CHECK_HRCMD(m_d3d11Device->CreatePixelShader(shaderBytes->GetBufferPointer(),
+                                                         shaderBytes->GetBufferSize(),
+                                                         nullptr,
+                                                         m_sharpeningPixelShader.ReleaseAndGetAddressOf()));
+            setDebugName(m_sharpeningPixelShader.Get(), "Sharpening PS");
+        }
+        {
+            const auto shaderBytes = compileShader(UpscalingShaderHlsl, "depthMain", "ps_5_0");
+            CHECK_HRCMD(m_d3d11Device->CreatePixelShader(shaderBytes->GetBufferPointer(),
+                                                         shaderBytes->GetBufferSize(),
+                                                         nullptr,
+                                                         m_upscalingDepthPixelShader.ReleaseAndGetAddressOf()));
+            setDebugName(m_upscalingDepthPixelShader.Get(), "UpscalingDepth PS");
+        }
+
+        D3D11_BUFFER_DESC bufferDesc{};
+        bufferDesc.ByteWidth = sizeof(UpscalingConstants);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        CHECK_HRCMD(
+            m_d3d11Device->CreateBuffer(&bufferDesc, nullptr, m_upscalingConstants.ReleaseAndGetAddressOf()));
+        setDebugName(m_upscalingConstants.Get(), "Upscaling Constants");
+
+        TraceLoggingWrite(g_traceProvider, "Upscaling_Initialize");
+    }
+
+    void OpenXrRuntime::releaseUpscalingResources() {
+        m_upscalingConstants.Reset();
+        m_upscalingDepthPixelShader.Reset();
+        m_sharpeningPixelShader.Reset();
+        m_upscalingPixelShader.Reset();
+    }
+
+    void OpenXrRuntime::cleanupUpscaling() {
+        for (uint32_t eye = 0; eye < xr::StereoView::Count; eye++) {
+            destroyRuntimeSwapchain(m_upscalingSwapchain[eye]);
+            destroyRuntimeSwapchain(m_upscalingDepthSwapchain[eye]);
+            m_upscalingIntermediateRenderTargetView[eye].Reset();
+            m_upscalingIntermediateResourceView[eye].Reset();
+            m_upscalingIntermediate[eye].Reset();
+        }
+    }
+
+    // Upscale the view to the resolution recommended for its FOV, and return the swapchain to submit in place of the
+    // view. Returns nullptr if the view cannot or does not need to be upscaled.
+    const OpenXrRuntime::RuntimeSwapchain*
+    OpenXrRuntime::upscaleView(uint32_t eye,
+                               const XrCompositionLayerProjectionView& view,
+                               std::set<std::pair<pvrTextureSwapChain, uint32_t>>& committed) {
+        Swapchain& xrSwapchain = *(Swapchain*)view.subImage.swapchain;
+
+        if (pvrToDxgiTextureFormat(xrSwapchain.pvrDesc.Format) == DXGI_FORMAT_UNKNOWN) {
+            LOG_TELEMETRY_ONCE(logUnimplemented("UpscalingFormatNotSupported"));
+            return nullptr;
+        }
+
+        // Target the resolution we would have recommended for this FOV without upscaling.
+        pvrFovPort fov;
+        fov.DownTan = -tan(view.fov.angleDown);
+        fov.UpTan = tan(view.fov.angleUp);
+        fov.LeftTan = -tan(view.fov.angleLeft);
+        fov.RightTan = tan(view.fov.angleRight);
+        pvrSizei outputSize;
+        CHECK_PVRCMD(pvr_getFovTextureSize(m_pvrSession, !eye ? pvrEye_Left : pvrEye_Right, fov, 1.f, &outputSize));
+
+        const XrExtent2Di& inputSize = view.subImage.imageRect.extent;
+        if (outputSize.w <= inputSize.width && outputSize.h <= inputSize.height) {
+            return nullptr;
+        }
+
+        initializeUpscalingResources();
+
+        RuntimeSwapchain& output = m_upscalingSwapchain[eye];
+        ensureRuntimeSwapchain(
+            output, xrSwapchain.pvrDesc.Format, outputSize.w, outputSize.h, fmt::format("Upscaling[{}]", eye));
+        output.imageRect = {{0, 0}, {outputSize.w, outputSize.h}};
+
+        // The sharpening pass needs an intermediate texture. We use a float format to preserve the precision in linear
+        // space.
+        const bool needSharpening = m_upscalingSharpness > 0.f;
+        if (needSharpening) {
+            D3D11_TEXTURE2D_DESC desc{};
+            if (m_upscalingIntermediate[eye]) {
+                m_upscalingIntermediate[eye]->GetDesc(&desc);
+            }
+            if (!m_upscalingIntermediate[eye] || desc.Width != output.pvrDesc.Width ||
+                desc.Height != output.pvrDesc.Height) {
+                desc = {};
+                desc.ArraySize = 1;
+                desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+                desc.Width = output.pvrDesc.Width;
+                desc.Height = output.pvrDesc.Height;
+                desc.MipLevels = 1;
+                desc.SampleDesc.Count = 1;
+                desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+                CHECK_HRCMD(m_d3d11Device->CreateTexture2D(
+                    &desc, nullptr, m_upscalingIntermediate[eye].ReleaseAndGetAddressOf()));
+                setDebugName(m_upscalingIntermediate[eye].Get(), fmt::format("Upscaling Intermediate[{}]", eye));
+                CHECK_HRCMD(m_d3d11Device->CreateShaderResourceView(
+                    m_upscalingIntermediate[eye].Get(),
+                    nullptr,
+                    m_upscalingIntermediateResourceView[eye].ReleaseAndGetAddressOf()));
+                setDebugName(m_upscalingIntermediateResourceView[eye].Get(),
+                             fmt::format("Upscaling Intermediate SRV[{}]", eye));
+                CHECK_HRCMD(m_d3d11Device->CreateRenderTargetView(
+                    m_upscalingIntermediate[eye].Get(),
+                    nullptr,
+                    m_upscalingIntermediateRenderTargetView[eye].ReleaseAndGetAddressOf()));
+                setDebugName(m_upscalingIntermediateRenderTargetView[eye].Get(),
+                             fmt::format("Upscaling Intermediate RTV[{}]", eye));
+            }
+        }
+
+        int outputIndex = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, output.pvrSwapchain, &outputIndex));
+
+        UpscalingConstants constants{};
+        constants.sourceOffset[0] = view.subImage.imageRect.offset.x;
+        constants.sourceOffset[1] = view.subImage.imageRect.offset.y;
+        constants.sourceExtent[0] = inputSize.width;
+        constants.sourceExtent[1] = inputSize.height;
+        constants.sourceScale[0] = (float)inputSize.width / output.pvrDesc.Width;
+        constants.sourceScale[1] = (float)inputSize.height / output.pvrDesc.Height;
+        constants.outputExtent[0] = output.pvrDesc.Width;
+        constants.outputExtent[1] = output.pvrDesc.Height;
+        constants.sourceSlice = view.subImage.imageArrayIndex;
+        constants.sharpness = m_upscalingSharpness;
+
+        TraceLoggingWrite(g_traceProvider,
+                          "Upscaling_Upscale",
+                          TLArg(eye, "Eye"),
+                          TLArg(inputSize.width, "InputWidth"),
+                          TLArg(inputSize.height, "InputHeight"),
+                          TLArg(output.pvrDesc.Width, "OutputWidth"),
+                          TLArg(output.pvrDesc.Height, "OutputHeight"),
+                          TLArg(m_upscalingSharpness, "Sharpness"),
+                          TLArg(outputIndex, "OutputIndex"));
+
+        ComPtr<ID3DDeviceContextState> appContextState;
+        m_d3d11DeviceContext->SwapDeviceContextState(m_compositionContextState.Get(),
+                                                     appContextState.ReleaseAndGetAddressOf());
+
+        m_d3d11DeviceContext->UpdateSubresource(m_upscalingConstants.Get(), 0, nullptr, &constants, 0, 0);
+
+        m_d3d11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_d3d11DeviceContext->IASetInputLayout(nullptr);
+        m_d3d11DeviceContext->VSSetShader(m_fullScreenVertexShader.Get(), nullptr, 0);
+        m_d3d11DeviceContext->PSSetConstantBuffers(0, 1, m_upscalingConstants.GetAddressOf());
+
+        D3D11_VIEWPORT viewport{};
+        viewport.Width = (float)output.pvrDesc.Width;
+        viewport.Height = (float)output.pvrDesc.Height;
+        viewport.MaxDepth = 1.f;
+        m_d3d11DeviceContext->RSSetViewports(1, &viewport);
+
+        // Upscale, either into the intermediate texture or directly into the output. Multisampled swapchains are
+        // resolved before sampling.
+        ID3D11ShaderResourceView* sourceView = getCompositionResourceView(xrSwapchain, view.subImage.imageArrayIndex);
+        m_d3d11DeviceContext->PSSetShader(m_upscalingPixelShader.Get(), nullptr, 0);
+        m_d3d11DeviceContext->PSSetShaderResources(0, 1, &sourceView);
+        m_d3d11DeviceContext->OMSetRenderTargets(1,
+                                                 needSharpening
+                                                     ? m_upscalingIntermediateRenderTargetView[eye].GetAddressOf()
+                                                     : output.renderTargetView[outputIndex].GetAddressOf(),
+                                                 nullptr);
+        m_d3d11DeviceContext->Draw(3, 0);
+
+        // Sharpen into the output.
+        if (needSharpening) {
+            m_d3d11DeviceContext->OMSetRenderTargets(1, output.renderTargetView[outputIndex].GetAddressOf(), nullptr);
+            m_d3d11DeviceContext->PSSetShader(m_sharpeningPixelShader.Get(), nullptr, 0);
+            m_d3d11DeviceContext->PSSetShaderResources(1, 1, m_upscalingIntermediateResourceView[eye].GetAddressOf());
+            m_d3d11DeviceContext->Draw(3, 0);
+        }
+
+        // Unbind all resources to avoid D3D validation errors.
+        ID3D11ShaderResourceView* nullSRV[] = {nullptr, nullptr};
+        m_d3d11DeviceContext->PSSetShaderResources(0, ARRAYSIZE(nullSRV), nullSRV);
+        m_d3d11DeviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+
+        m_d3d11DeviceContext->SwapDeviceContextState(appContextState.Get(), nullptr);
+
+        // The application's swapchain must still be committed in order to advance to the next image.
+        const auto key = std::make_pair(xrSwapchain.pvrSwapchain[0], 0u);
+        if (!committed.count(key)) {
+            CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, xrSwapchain.pvrSwapchain[0]));
+            committed.insert(key);
+        }
+
+        CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, output.pvrSwapchain));
+
+        LOG_TELEMETRY_ONCE(logFeature("Upscaling"));
+
+        return &output;
+    }
+
+    // Upscale the depth submitted with an upscaled view, since PVR expects the depth buffer to map 1:1 to the color
+    // buffer. Returns nullptr if the depth cannot be upscaled, in which case it must not be submitted. The
+    // application's depth swapchain must have been prepared already.
+    const OpenXrRuntime::RuntimeSwapchain* OpenXrRuntime::upscaleDepth(uint32_t eye,
+                                                                       const XrCompositionLayerDepthInfoKHR& depth,
+                                                                       const RuntimeSwapchain& upscaledColor) {
+        Swapchain& xrSwapchain = *(Swapchain*)depth.subImage.swapchain;
+
+        // Depth cannot be resolved like color, since averaging the samples gives depths that belong to no surface.
+        // Without depth, PVR falls back to its regular reprojection.
+        const bool isSupportedFormat = xrSwapchain.needDepthResolve ||
+                                       pvrToDxgiDepthResourceFormat(xrSwapchain.pvrDesc.Format) != DXGI_FORMAT_UNKNOWN;
+        if (xrSwapchain.xrDesc.sampleCount > 1 || !isSupportedFormat) {
+            LOG_TELEMETRY_ONCE(logUnimplemented("UpscalingDepthNotSupported"));
+            return nullptr;
+        }
+
+        RuntimeSwapchain& output = m_upscalingDepthSwapchain[eye];
+        ensureRuntimeSwapchain(output,
+                               PVR_FORMAT_D32_FLOAT,
+                               upscaledColor.pvrDesc.Width,
+                               upscaledColor.pvrDesc.Height,
+                               fmt::format("UpscalingDepth[{}]", eye));
+        output.imageRect = upscaledColor.imageRect;
+
+        int outputIndex = -1;
+        CHECK_PVRCMD(pvr_getTextureSwapChainCurrentIndex(m_pvrSession, output.pvrSwapchain, &outputIndex));
+
+        const XrExtent2Di& inputSize = depth.subImage.imageRect.extent;
+        UpscalingConstants constants{};
+        constants.depthOffset[0] = depth.subImage.imageRect.offset.x;
+        constants.depthOffset[1] = depth.subImage.imageRect.offset.y;
+        constants.depthExtent[0] = inputSize.width;
+        constants.depthExtent[1] = inputSize.height;
+        constants.depthScale[0] = (float)inputSize.width / output.imageRect.extent.width;
+        constants.depthScale[1] = (float)inputSize.height / output.imageRect.extent.height;
+        constants.depthSlice = depth.subImage.imageArrayIndex;
+
+        TraceLoggingWrite(g_traceProvider,
+                          "Upscaling_Depth",
+                          TLArg(eye, "Eye"),
+                          TLArg(inputSize.width, "InputWidth"),
+                          TLArg(inputSize.height, "InputHeight"),
+                          TLArg(output.pvrDesc.Width, "OutputWidth"),
+                          TLArg(output.pvrDesc.Height, "OutputHeight"),
+                          TLArg(outputIndex, "OutputIndex"));
+
+        ID3D11ShaderResourceView* depthView =
+            getCompositionResourceView(xrSwapchain, depth.subImage.imageArrayIndex);
+
+        ComPtr<ID3DDeviceContextState> appContextState;
+        m_d3d11DeviceContext->SwapDeviceContextState(m_compositionContextState.Get(),
+                                                     appContextState.ReleaseAndGetAddressOf());
+
+        m_d3d11DeviceContext->UpdateSubresource(m_upscalingConstants.Get(), 0, nullptr, &constants, 0, 0);
+
+        // With the default depth test (less), clearing to the far plane makes every depth written as-is: a depth equal
+        // to the far plane is the cleared value already.
+        ID3D11DepthStencilView* const depthStencilView = output.depthStencilView[outputIndex].Get();
+        m_d3d11DeviceContext->ClearDepthStencilView(depthStencilView, D3D11_CLEAR_DEPTH, 1.f, 0);
+
+        m_d3d11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        m_d3d11DeviceContext->IASetInputLayout(nullptr);
+        m_d3d11DeviceContext->VSSetShader(m_fullScreenVertexShader.Get(), nullptr, 0);
+        m_d3d11DeviceContext->PSSetShader(m_upscalingDepthPixelShader.Get(), nullptr, 0);
+        m_d3d11DeviceContext->PSSetConstantBuffers(0, 1, m_upscalingConstants.GetAddressOf());
+        m_d3d11DeviceContext->PSSetShaderResources(2, 1, &depthView);
+        m_d3d11DeviceContext->OMSetRenderTargets(0, nullptr, depthStencilView);
+
+        D3D11_VIEWPORT viewport{};
+        viewport.Width = (float)output.imageRect.extent.width;
+        viewport.Height = (float)output.imageRect.extent.height;
+        viewport.MaxDepth = 1.f;
+        m_d3d11DeviceContext->RSSetViewports(1, &viewport);
+
+        m_d3d11DeviceContext->Draw(3, 0);
+
+        // Unbind all resources to avoid D3D validation errors.
+        ID3D11ShaderResourceView* nullSRV[] = {nullptr};
+        m_d3d11DeviceContext->PSSetShaderResources(2, ARRAYSIZE(nullSRV), nullSRV);
+        m_d3d11DeviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+
+        m_d3d11DeviceContext->SwapDeviceContextState(appContextState.Get(), nullptr);
+
+        CHECK_PVRCMD(pvr_commitTextureSwapChain(m_pvrSession, output.pvrSwapchain));
+
+        return &output;
+    }
+
+} // namespace pimax_openxr
@@ -158,22 +158,28 @@ namespace pimax_openxr::utils {
 
     // A GPU asynchronous timer.
     struct GpuTimer : public ITimer {
-        GpuTimer(ID3D11Device* device, ID3D11DeviceContext* context) : m_context(context) {
-            D3D11_QUERY_DESC queryDesc;
-            ZeroMemory(&queryDesc, sizeof(D3D11_QUERY_DESC));
-            queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
-            CHECK_HRCMD(device->CreateQuery(&queryDesc, m_timeStampDis.ReleaseAndGetAddressOf()));
-            queryDesc.Query = D3D11_QUERY_TIMESTAMP;
-            CHECK_HRCMD(device->CreateQuery(&queryDesc, m_timeStampStart.ReleaseAndGetAddressOf()));
-            CHECK_HRCMD(device->CreateQuery(&queryDesc, m_timeStampEnd.ReleaseAndGetAddressOf()));
+        GpuTimer(ID3D11Device* device, ID3D11DeviceContext* context) : m_device(device), m_context(context) {
         }
 
         void start() override {
+            // Most timers are only used when tracing, so the queries are created on first use.
+            if (!m_timeStampDis) {
+                D3D11_QUERY_DESC queryDesc;
+                ZeroMemory(&queryDesc, sizeof(D3D11_QUERY_DESC));
+                queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+                CHECK_HRCMD(m_device->CreateQuery(&queryDesc, m_timeStampDis.ReleaseAndGetAddressOf()));
+                queryDesc.Query = D3D11_QUERY_TIMESTAMP;
+                CHECK_HRCMD(m_device->CreateQuery(&queryDesc, m_timeStampStart.ReleaseAndGetAddressOf()));
+                CHECK_HRCMD(m_device->CreateQuery(&queryDesc, m_timeStampEnd.ReleaseAndGetAddressOf()));
+            }
             m_context->Begin(m_timeStampDis.Get());
             m_context->End(m_timeStampStart.Get());
         }
 
         void stop() override {
+            if (!m_timeStampDis) {
+                return;
+            }
             m_context->End(m_timeStampEnd.Get());
             m_context->End(m_timeStampDis.Get());
             m_valid = true;
@@ -198,6 +204,7 @@ namespace pimax_openxr::utils {
         }
 
       private:
+        const ComPtr<ID3D11Device> m_device;
         const ComPtr<ID3D11DeviceContext> m_context;
         ComPtr<ID3D11Query> m_timeStampDis;
         ComPtr<ID3D11Query> m_timeStampStart;
@@ -261,6 +268,20 @@ namespace pimax_openxr::utils {
         return data;
     }
 
+    static void RegSetDword(HKEY hKey, const std::string& subKey, const std::string& value, DWORD data) {
+        ::RegSetKeyValue(hKey,
+                         std::wstring(subKey.begin(), subKey.end()).c_str(),
+                         std::wstring(value.begin(), value.end()).c_str(),
+                         REG_DWORD,
+                         &data,
+                         sizeof(data));
+    }
+
+    static void RegDeleteDword(HKEY hKey, const std::string& subKey, const std::string& value) {
+        ::RegDeleteKeyValue(
+            hKey, std::wstring(subKey.begin(), subKey.end()).c_str(), std::wstring(value.begin(), value.end()).c_str());
+    }
+
     static std::vector<const char*> ParseExtensionString(char* names) {
         std::vector<const char*> list;
         while (*names != 0) {
@@ -369,6 +390,46 @@ namespace pimax_openxr::utils {
         }
     }
 
+    // Only the color formats usable as render targets are supported.
+    static DXGI_FORMAT pvrToDxgiTextureFormat(pvrTextureFormat format) {
+        switch (format) {
+        case PVR_FORMAT_R8G8B8A8_UNORM:
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case PVR_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case PVR_FORMAT_B8G8R8A8_UNORM:
+            return DXGI_FORMAT_B8G8R8A8_UNORM;
+        case PVR_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        case PVR_FORMAT_B8G8R8X8_UNORM:
+            return DXGI_FORMAT_B8G8R8X8_UNORM;
+        case PVR_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+        case PVR_FORMAT_R16G16B16A16_FLOAT:
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case PVR_FORMAT_R11G11B10_FLOAT:
+            return DXGI_FORMAT_R11G11B10_FLOAT;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    // The formats to sample the depth component of the depth formats with.
+    static DXGI_FORMAT pvrToDxgiDepthResourceFormat(pvrTextureFormat format) {
+        switch (format) {
+        case PVR_FORMAT_D16_UNORM:
+            return DXGI_FORMAT_R16_UNORM;
+        case PVR_FORMAT_D24_UNORM_S8_UINT:
+            return DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+        case PVR_FORMAT_D32_FLOAT:
+            return DXGI_FORMAT_R32_FLOAT;
+        case PVR_FORMAT_D32_FLOAT_S8X24_UINT:
+            return DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
     static pvrTextureFormat vkToPvrTextureFormat(VkFormat format) {
         switch (format) {
         case VK_FORMAT_R8G8B8A8_UNORM:
@@ -460,6 +521,50 @@ namespace pimax_openxr::utils {
         }
     }
 
+    // Block-compressed formats have less than a byte per pixel.
+    static uint32_t pvrGetBitsPerPixel(pvrTextureFormat format) {
+        switch (format) {
+        case PVR_FORMAT_BC1_UNORM:
+        case PVR_FORMAT_BC1_UNORM_SRGB:
+            return 4;
+        case PVR_FORMAT_BC2_UNORM:
+        case PVR_FORMAT_BC2_UNORM_SRGB:
+        case PVR_FORMAT_BC3_UNORM:
+        case PVR_FORMAT_BC3_UNORM_SRGB:
+        case PVR_FORMAT_BC6H_UF16:
+        case PVR_FORMAT_BC6H_SF16:
+        case PVR_FORMAT_BC7_UNORM:
+        case PVR_FORMAT_BC7_UNORM_SRGB:
+            return 8;
+        case PVR_FORMAT_D16_UNORM:
+            return 16;
+        case PVR_FORMAT_R8G8B8A8_UNORM:
+        case PVR_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case PVR_FORMAT_B8G8R8A8_UNORM:
+        case PVR_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case PVR_FORMAT_B8G8R8X8_UNORM:
+        case PVR_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case PVR_FORMAT_D24_UNORM_S8_UINT:
+        case PVR_FORMAT_D32_FLOAT:
+        case PVR_FORMAT_R11G11B10_FLOAT:
+            return 32;
+        case PVR_FORMAT_R16G16B16A16_FLOAT:
+        case PVR_FORMAT_D32_FLOAT_S8X24_UINT:
+            return 64;
+        default:
+            return 0;
+        }
+    }
+
+    // The properties that must match for a PVR swapchain to be used in place of another.
+    struct SwapchainDescEqual {
+        bool operator()(const pvrTextureSwapChainDesc& a, const pvrTextureSwapChainDesc& b) const {
+            return a.Type == b.Type && a.Format == b.Format && a.ArraySize == b.ArraySize && a.Width == b.Width &&
+                   a.Height == b.Height && a.MipLevels == b.MipLevels && a.SampleCount == b.SampleCount &&
+                   a.StaticImage == b.StaticImage && a.MiscFlags == b.MiscFlags && a.BindFlags == b.BindFlags;
+        }
+    };
+
     static inline bool isValidSwapchainRect(pvrTextureSwapChainDesc desc, XrRect2Di rect) {
         if (rect.offset.x < 0 || rect.offset.y < 0 || rect.extent.width <= 0 || rect.extent.height <= 0) {
             return false;
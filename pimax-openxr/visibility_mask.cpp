@@ -63,17 +63,19 @@ namespace pimax_openxr {
             return XR_ERROR_HANDLE_INVALID;
         }
 
-        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) {
+        if (!isViewConfigurationSupported(viewConfigurationType)) {
             return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
         }
 
-        if (viewIndex >= xr::StereoView::Count) {
+        if (viewIndex >= getViewCount(viewConfigurationType)) {
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
         // We only support the hidden area mesh and we don't return a mask with parallel projection.
-        if (visibilityMaskType != XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR || m_useParallelProjection) {
-            if (!m_useParallelProjection) {
+        // The focus views of the quad views are always fully visible.
+        if (visibilityMaskType != XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR || m_useParallelProjection ||
+            viewIndex >= xr::StereoView::Count) {
+            if (visibilityMaskType != XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR && !m_useParallelProjection) {
                 LOG_TELEMETRY_ONCE(logUnimplemented("VisibilityMaskTypeNotSupported"));
             }
 
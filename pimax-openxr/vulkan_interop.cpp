@@ -463,23 +463,7 @@ namespace pimax_openxr {
         m_vkPhysicalDevice = vkBindings.physicalDevice;
 
         // Create the interop device that PVR will be using.
-        ComPtr<ID3D11Device> device;
-        ComPtr<ID3D11DeviceContext> deviceContext;
-        D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
-        UINT flags = 0;
-#ifdef _DEBUG
-        flags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-        CHECK_HRCMD(D3D11CreateDevice(dxgiAdapter.Get(),
-                                      D3D_DRIVER_TYPE_UNKNOWN,
-                                      0,
-                                      flags,
-                                      &featureLevel,
-                                      1,
-                                      D3D11_SDK_VERSION,
-                                      device.ReleaseAndGetAddressOf(),
-                                      nullptr,
-                                      deviceContext.ReleaseAndGetAddressOf()));
+        const ComPtr<ID3D11Device> device = createInteropD3D11Device(dxgiAdapter.Get());
 
         ComPtr<ID3D11Device5> device5;
         CHECK_HRCMD(device->QueryInterface(m_d3d11Device.ReleaseAndGetAddressOf()));
@@ -787,7 +771,7 @@ namespace pimax_openxr {
         if (m_vkDispatch.vkQueueSubmit && m_vkDispatch.vkWaitSemaphoresKHR) {
             m_fenceValue++;
             TraceLoggingWrite(
-                g_traceProvider, "xrDestroySwapchain_Wait", TLArg("Vulkan", "Api"), TLArg(m_fenceValue, "FenceValue"));
+                g_traceProvider, "FlushCommandQueue_Wait", TLArg("Vulkan", "Api"), TLArg(m_fenceValue, "FenceValue"));
             VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
             timelineInfo.signalSemaphoreValueCount = 1;
             timelineInfo.pSignalSemaphoreValues = &m_fenceValue;
@@ -803,6 +787,20 @@ namespace pimax_openxr {
         }
     }
 
+    // Make the D3D11 context wait for the commands submitted so far on the Vulkan queue, without blocking the CPU.
+    void OpenXrRuntime::serializeVulkanWork() {
+        m_fenceValue++;
+        TraceLoggingWrite(g_traceProvider, "SerializeWork", TLArg("Vulkan", "Api"), TLArg(m_fenceValue, "FenceValue"));
+        VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &m_fenceValue;
+        VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO, &timelineInfo};
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &m_vkTimelineSemaphore;
+        CHECK_VKCMD(m_vkDispatch.vkQueueSubmit(m_vkQueue, 1, &submitInfo, VK_NULL_HANDLE));
+        CHECK_HRCMD(m_d3d11DeviceContext->Wait(m_d3d11Fence.Get(), m_fenceValue));
+    }
+
     // Serialize commands from the Vulkan queue to the D3D11 context used by PVR.
     void OpenXrRuntime::serializeVulkanFrame() {
         m_fenceValue++;
@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "action_snapshot.h"
+#include "test.h"
+
+using namespace pimax_openxr::action_snapshot;
+
+// Compare the cost of an action state query validated from the snapshot against the former validation from the
+// bookkeeping sets of the runtime (which is not safe to do concurrently with the application creating actions).
+int main() {
+    constexpr uintptr_t ActionCount = 64;
+    constexpr int QueryCount = 200000;
+
+    struct Action {
+        int32_t type;
+        uintptr_t actionSet;
+    };
+    std::vector<Action> actions(ActionCount);
+    std::set<uintptr_t> knownActions;
+    std::set<uintptr_t> activeActionSets;
+    auto snapshot = std::make_unique<Snapshot<uintptr_t>>();
+    for (uintptr_t action = 0; action < ActionCount; action++) {
+        actions[action] = {(int32_t)(action % 4), action / 8};
+        knownActions.insert(action);
+        activeActionSets.insert(action / 8);
+
+        auto& entry = snapshot->add(action);
+        entry.type = actions[action].type;
+        entry.isAttached = true;
+        entry.states[FilterNone].floatValue = (float)action;
+    }
+    const Snapshot<uintptr_t>* const states = snapshot.get();
+    Publisher<Snapshot<uintptr_t>> publisher;
+    publisher.publish(std::move(snapshot));
+
+    const auto measure = [&](const char* name, const auto& query) {
+        float sum = 0.f;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < QueryCount; i++) {
+            sum += query((uintptr_t)i % ActionCount);
+        }
+        const auto duration = std::chrono::steady_clock::now() - start;
+        std::printf("%s: %.1f ns/query (%.0f)\n",
+                    name,
+                    std::chrono::duration<double, std::nano>(duration).count() / QueryCount,
+                    sum);
+        CHECK(sum > 0.f);
+    };
+
+    measure("Set validation", [&](uintptr_t action) {
+        if (!knownActions.count(action) || actions[action].type != (int32_t)(action % 4) ||
+            !activeActionSets.count(actions[action].actionSet)) {
+            return 0.f;
+        }
+        return states->find(action, FilterNone)->floatValue;
+    });
+
+    measure("Snapshot validation", [&](uintptr_t action) {
+        const auto latest = publisher.get();
+        const Entry* entry = latest->get(action);
+        if (!entry || entry->type != (int32_t)(action % 4) || !entry->isAttached) {
+            return 0.f;
+        }
+        return entry->states[FilterNone].floatValue;
+    });
+
+    return 0;
+}
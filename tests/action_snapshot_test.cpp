@@ -0,0 +1,189 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "action_snapshot.h"
+#include "test.h"
+
+using namespace pimax_openxr::action_snapshot;
+
+int main() {
+    // Change tracking between two syncs.
+    {
+        const State previous;
+        State state;
+        state.isActive = true;
+        state.boolValue = true;
+        trackChanges(state, previous, 100);
+        CHECK(state.changedSinceLastSync);
+        CHECK(state.lastChangeTime == 100);
+
+        // An inactive action keeps its value.
+        State inactive;
+        trackChanges(inactive, state, 200);
+        CHECK(inactive.boolValue);
+        CHECK(!inactive.changedSinceLastSync);
+        CHECK(inactive.lastChangeTime == 100);
+    }
+
+    // Lookup.
+    {
+        Snapshot<uintptr_t> snapshot;
+        auto& entry = snapshot.add(1);
+        entry.type = 2;
+        entry.isAttached = true;
+        entry.states[FilterRightHand].floatValue = 0.5f;
+        CHECK(snapshot.get(1)->type == 2);
+        CHECK(snapshot.get(1)->isAttached);
+        CHECK(!snapshot.get(2));
+        CHECK(snapshot.find(1, FilterRightHand)->floatValue == 0.5f);
+        CHECK(!snapshot.find(2, FilterNone));
+        CHECK(!snapshot.find(1, FilterCount));
+    }
+
+    // A replaced snapshot is freed once no reader can hold it anymore.
+    {
+        struct Counted {
+            explicit Counted(int& liveCount) : liveCount(liveCount) {
+                liveCount++;
+            }
+            ~Counted() {
+                liveCount--;
+            }
+            int& liveCount;
+        };
+
+        int liveCount = 0;
+        {
+            Publisher<Counted> publisher;
+            CHECK(!publisher.get());
+
+            publisher.publish(std::make_unique<Counted>(liveCount));
+            {
+                const auto first = publisher.get();
+                CHECK(first);
+                const Counted* const firstValue = first.get();
+
+                // The first snapshot survives any number of publications while it is read.
+                for (int i = 0; i < 10; i++) {
+                    publisher.publish(std::make_unique<Counted>(liveCount));
+                }
+                CHECK(first.get() == firstValue);
+                CHECK(publisher.get().get() != firstValue);
+                CHECK(publisher.getRetiredCount() >= 1);
+                CHECK(liveCount == 1 + (int)publisher.getRetiredCount());
+
+                // Reloading gives the latest snapshot, without releasing the first one.
+                auto reader = publisher.get();
+                const Counted* const beforeValue = reader.get();
+                publisher.publish(std::make_unique<Counted>(liveCount));
+                CHECK(reader.get() == beforeValue);
+                reader.reload();
+                CHECK(reader.get() != beforeValue);
+                CHECK(first.get() == firstValue);
+            }
+
+            // Without readers, the replaced snapshots are freed by the next publication.
+            publisher.publish(std::make_unique<Counted>(liveCount));
+            CHECK(publisher.getRetiredCount() == 0);
+            CHECK(liveCount == 1);
+
+            publisher.publish(nullptr);
+            CHECK(!publisher.get());
+        }
+        CHECK(liveCount == 0);
+    }
+
+    // Stress: one thread syncing and creating/destroying actions, several threads polling. Each reader must see a whole
+    // snapshot, including the validation information.
+    {
+        constexpr uintptr_t ActionCount = 64;
+        constexpr int SyncCount = 2000;
+        using TestSnapshot = Snapshot<uintptr_t>;
+        Publisher<TestSnapshot> publisher;
+        std::atomic<bool> stop{false};
+
+        std::thread sync([&] {
+            for (int i = 1; i <= SyncCount; i++) {
+                auto snapshot = std::make_unique<TestSnapshot>();
+                for (uintptr_t action = 0; action < ActionCount; action++) {
+                    // Odd actions only exist on odd syncs.
+                    if ((action & 1) && !(i & 1)) {
+                        continue;
+                    }
+
+                    auto& entry = snapshot->add(action);
+                    entry.type = (int32_t)(action % 4);
+                    entry.isAttached = i > SyncCount / 2;
+                    for (auto& state : entry.states) {
+                        state.isActive = true;
+                        state.floatValue = (float)i;
+                        state.lastChangeTime = i;
+                    }
+                }
+                publisher.publish(std::move(snapshot));
+            }
+            stop = true;
+        });
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&] {
+                int64_t lastSync = 0;
+                while (!stop) {
+                    const auto snapshot = publisher.get();
+                    if (!snapshot) {
+                        continue;
+                    }
+
+                    const int64_t syncIndex = snapshot->find(0, FilterNone)->lastChangeTime;
+                    for (uintptr_t action = 0; action < ActionCount; action++) {
+                        const Entry* entry = snapshot->get(action);
+                        if ((action & 1) && !(syncIndex & 1)) {
+                            CHECK(!entry);
+                            continue;
+                        }
+                        CHECK(entry);
+                        CHECK(entry->type == (int32_t)(action % 4));
+                        CHECK(entry->isAttached == (syncIndex > SyncCount / 2));
+
+                        const State* state = snapshot->find(action, FilterLeftHand);
+                        CHECK(state);
+                        CHECK(state->lastChangeTime == syncIndex);
+                        CHECK(state->floatValue == (float)syncIndex);
+                    }
+                    CHECK(syncIndex >= lastSync);
+                    lastSync = syncIndex;
+                }
+            });
+        }
+
+        sync.join();
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        CHECK(publisher.get()->find(ActionCount - 2, FilterEyes)->lastChangeTime == SyncCount);
+    }
+
+    return 0;
+}
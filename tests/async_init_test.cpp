@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "async_init.h"
+#include "test.h"
+
+using namespace pimax_openxr;
+
+// Stands for the PVR client, with an injected initialization latency.
+struct MockPvr {
+    std::chrono::milliseconds latency;
+    std::atomic<bool> initialized{false};
+
+    void initialize() {
+        std::this_thread::sleep_for(latency);
+        initialized = true;
+    }
+};
+
+int main() {
+    // A task that was never started does not block.
+    {
+        async_init::Task task;
+        CHECK(task.isReady());
+        task.wait();
+    }
+
+    // The calls not needing the backend return immediately, while the others wait for it.
+    {
+        MockPvr pvr{200ms};
+        async_init::Task task;
+        const auto begin = std::chrono::steady_clock::now();
+        task.start([&] { pvr.initialize(); });
+        CHECK(std::chrono::steady_clock::now() - begin < 100ms);
+        CHECK(!task.isReady());
+
+        std::atomic<int> sawInitialized{0};
+        std::vector<std::thread> waiters;
+        for (int i = 0; i < 4; i++) {
+            waiters.emplace_back([&] {
+                task.wait();
+                if (pvr.initialized) {
+                    sawInitialized++;
+                }
+            });
+        }
+        task.wait();
+        CHECK(pvr.initialized);
+        CHECK(std::chrono::steady_clock::now() - begin >= pvr.latency);
+        for (auto& waiter : waiters) {
+            waiter.join();
+        }
+        CHECK(sawInitialized == 4);
+        CHECK(task.isReady());
+        task.wait();
+    }
+
+    // A failure is reported to every caller.
+    {
+        async_init::Task task;
+        task.start([] {
+            std::this_thread::sleep_for(50ms);
+            throw std::runtime_error("pvr_initialise failed");
+        });
+        for (int i = 0; i < 2; i++) {
+            bool thrown = false;
+            try {
+                task.wait();
+            } catch (std::runtime_error& exc) {
+                thrown = std::string(exc.what()) == "pvr_initialise failed";
+            }
+            CHECK(thrown);
+        }
+    }
+
+    // Destruction waits for the initialization to complete.
+    {
+        MockPvr pvr{100ms};
+        {
+            async_init::Task task;
+            task.start([&] { pvr.initialize(); });
+        }
+        CHECK(pvr.initialized);
+    }
+
+    return 0;
+}
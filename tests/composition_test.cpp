@@ -0,0 +1,241 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "composition.h"
+#include "test.h"
+
+using namespace pimax_openxr::composition;
+
+// Reference values for a few texels of the CPU passes. The GPU passes are expected to match them within the precision
+// of the render target formats.
+struct GoldenTexel {
+    uint32_t x;
+    uint32_t y;
+    XrColor4f color;
+};
+
+static void checkGolden(const CpuImage& image, const std::vector<GoldenTexel>& golden) {
+    for (const auto& texel : golden) {
+        const XrColor4f& color = image.at(texel.x, texel.y);
+        CHECK_NEAR(color.r, texel.color.r, 1e-4);
+        CHECK_NEAR(color.g, texel.color.g, 1e-4);
+        CHECK_NEAR(color.b, texel.color.b, 1e-4);
+        CHECK_NEAR(color.a, texel.color.a, 1e-4);
+    }
+}
+
+static CpuImage makeImage(uint32_t width, uint32_t height, const XrColor4f& color) {
+    CpuImage image(width, height);
+    std::fill(image.pixels.begin(), image.pixels.end(), color);
+    return image;
+}
+
+// A vertical edge in the red channel and a diagonal gradient in the green channel.
+static CpuImage makePattern(float low, float high) {
+    CpuImage image(4, 4);
+    for (uint32_t y = 0; y < image.height; y++) {
+        for (uint32_t x = 0; x < image.width; x++) {
+            image.at(x, y) = {x >= 2 ? high : low, (x + y) / 6.f, 0.25f, 1.f};
+        }
+    }
+    return image;
+}
+
+static XrFovf makeFov(float left, float right, float up, float down) {
+    return {std::atan(left), std::atan(right), std::atan(up), std::atan(down)};
+}
+
+int main() {
+    // Sub-image placement.
+    {
+        const UvTransform transform = computeSubImageTransform({{100, 50}, {200, 100}}, 400, 200);
+        const XrVector2f topLeft = apply(transform, {0.f, 0.f});
+        const XrVector2f bottomRight = apply(transform, {1.f, 1.f});
+        CHECK_NEAR(topLeft.x, 0.25, 1e-6);
+        CHECK_NEAR(topLeft.y, 0.25, 1e-6);
+        CHECK_NEAR(bottomRight.x, 0.75, 1e-6);
+        CHECK_NEAR(bottomRight.y, 0.75, 1e-6);
+    }
+
+    // Inset placement: a focus view covering the middle half of the peripheral view, in tangent space.
+    {
+        const XrFovf peripheral = makeFov(-1.f, 1.f, 1.f, -1.f);
+        const XrFovf focus = makeFov(-0.5f, 0.5f, 0.5f, -0.5f);
+        const UvTransform identity = computeInsetTransform(peripheral, peripheral);
+        CHECK_NEAR(identity.scale.x, 1.0, 1e-6);
+        CHECK_NEAR(identity.offset.y, 0.0, 1e-6);
+
+        const UvTransform inset = computeInsetTransform(peripheral, focus);
+        CHECK_NEAR(apply(inset, {0.25f, 0.25f}).x, 0.0, 1e-6);
+        CHECK_NEAR(apply(inset, {0.25f, 0.25f}).y, 0.0, 1e-6);
+        CHECK_NEAR(apply(inset, {0.75f, 0.75f}).x, 1.0, 1e-6);
+        CHECK_NEAR(apply(inset, {0.75f, 0.75f}).y, 1.0, 1e-6);
+    }
+
+    // Focus view placement follows the gaze, and stays inside the peripheral view.
+    {
+        const XrFovf peripheral = makeFov(-1.f, 1.f, 1.f, -1.f);
+        XrFovf focus = computeFocusFov(peripheral, 0.5f, {0.f, 0.f});
+        CHECK_NEAR(std::tan(focus.angleLeft), -0.5, 1e-6);
+        CHECK_NEAR(std::tan(focus.angleUp), 0.5, 1e-6);
+        CHECK_NEAR(getFovCenter(focus).x, 0.0, 1e-6);
+
+        focus = computeFocusFov(peripheral, 0.5f, {0.2f, -0.1f});
+        CHECK_NEAR(getFovCenter(focus).x, 0.2, 1e-6);
+        CHECK_NEAR(getFovCenter(focus).y, -0.1, 1e-6);
+
+        focus = computeFocusFov(peripheral, 0.5f, {2.f, 2.f});
+        CHECK_NEAR(std::tan(focus.angleRight), 1.0, 1e-6);
+        CHECK_NEAR(std::tan(focus.angleUp), 1.0, 1e-6);
+    }
+
+    // Feathering of the inset.
+    {
+        CHECK(computeInsetWeight({0.5f, 0.5f}, 0.1f) == 1.f);
+        CHECK(computeInsetWeight({-0.1f, 0.5f}, 0.1f) == 0.f);
+        CHECK(computeInsetWeight({0.f, 0.5f}, 0.1f) == 0.f);
+        CHECK_NEAR(computeInsetWeight({0.05f, 0.5f}, 0.1f), 0.5, 1e-6);
+        CHECK(computeInsetWeight({0.f, 0.5f}, 0.f) == 1.f);
+    }
+
+    // Quad views composition: the focus view replaces the middle of the peripheral view, with a feathered seam.
+    {
+        const CpuImage peripheral = makeImage(64, 64, {1.f, 0.f, 0.f, 1.f});
+        const CpuImage focus = makeImage(32, 32, {0.f, 1.f, 0.f, 1.f});
+        const UvTransform inset =
+            computeInsetTransform(makeFov(-1.f, 1.f, 1.f, -1.f), makeFov(-0.5f, 0.5f, 0.5f, -0.5f));
+        CpuImage output;
+        compositeInsetCpu(peripheral, focus, inset, 0.1f, output);
+        CHECK(output.width == 64);
+        CHECK(output.height == 64);
+        checkGolden(output,
+                    {
+                        {0, 0, {1.f, 0.f, 0.f, 1.f}},
+                        {15, 32, {1.f, 0.f, 0.f, 1.f}},
+                        {32, 32, {0.f, 1.f, 0.f, 1.f}},
+                        {63, 63, {1.f, 0.f, 0.f, 1.f}},
+                    });
+
+        // Across the seam, the weight of the focus view increases monotonically.
+        float lastGreen = 0.f;
+        for (uint32_t x = 16; x < 32; x++) {
+            const XrColor4f& color = output.at(x, 32);
+            CHECK(color.g >= lastGreen);
+            CHECK_NEAR(color.r + color.g, 1.0, 1e-5);
+            lastGreen = color.g;
+        }
+        CHECK(lastGreen == 1.f);
+    }
+
+    // Upscaling.
+    {
+        // A flat image stays flat.
+        const CpuImage flat = makeImage(8, 8, {0.2f, 0.4f, 0.6f, 1.f});
+        CpuImage output(12, 12);
+        upscaleCpu(flat, output);
+        for (const auto& color : output.pixels) {
+            CHECK_NEAR(color.r, 0.2, 1e-5);
+            CHECK_NEAR(color.g, 0.4, 1e-5);
+            CHECK_NEAR(color.b, 0.6, 1e-5);
+        }
+
+        // A hard edge does not ring, and the gradient is preserved.
+        const CpuImage pattern = makePattern(0.f, 1.f);
+        output = CpuImage(6, 6);
+        upscaleCpu(pattern, output);
+        for (const auto& color : output.pixels) {
+            CHECK(color.r >= 0.f && color.r <= 1.f);
+            CHECK(color.g >= 0.f && color.g <= 1.f);
+        }
+        checkGolden(output,
+                    {
+                        {0, 0, {0.000000f, 0.000000f, 0.250000f, 1.000000f}},
+                        {1, 0, {0.000000f, 0.062542f, 0.250000f, 1.000000f}},
+                        {2, 0, {0.043250f, 0.230911f, 0.250000f, 1.000000f}},
+                        {3, 0, {0.956750f, 0.328786f, 0.250000f, 1.000000f}},
+                        {4, 0, {1.000000f, 0.433377f, 0.250000f, 1.000000f}},
+                        {5, 0, {1.000000f, 0.500000f, 0.250000f, 1.000000f}},
+                        {0, 5, {0.000000f, 0.500000f, 0.250000f, 1.000000f}},
+                        {1, 5, {0.000000f, 0.566623f, 0.250000f, 1.000000f}},
+                        {2, 5, {0.043250f, 0.671214f, 0.250000f, 1.000000f}},
+                        {3, 5, {0.956751f, 0.769089f, 0.250000f, 1.000000f}},
+                        {4, 5, {1.000000f, 0.937458f, 0.250000f, 1.000000f}},
+                        {5, 5, {1.000000f, 1.000000f, 0.250000f, 1.000000f}},
+                    });
+    }
+
+    // Depth upscaling only ever outputs depth values from the input.
+    {
+        CpuImage depth(4, 4);
+        for (uint32_t i = 0; i < depth.pixels.size(); i++) {
+            depth.pixels[i] = {i / 16.f, 0.f, 0.f, 1.f};
+        }
+        CpuImage output(6, 6);
+        upscaleDepthCpu(depth, output);
+        for (uint32_t y = 0; y < output.height; y++) {
+            for (uint32_t x = 0; x < output.width; x++) {
+                const uint32_t inputX = (uint32_t)((x + 0.5f) * depth.width / output.width);
+                const uint32_t inputY = (uint32_t)((y + 0.5f) * depth.height / output.height);
+                CHECK(output.at(x, y).r == depth.at(inputX, inputY).r);
+            }
+        }
+    }
+
+    // Sharpening.
+    {
+        // No sharpening, or a flat image, leaves the image as is.
+        const CpuImage pattern = makePattern(0.3f, 0.7f);
+        CpuImage output;
+        sharpenCpu(pattern, 0.f, output);
+        for (size_t i = 0; i < output.pixels.size(); i++) {
+            CHECK_NEAR(output.pixels[i].r, pattern.pixels[i].r, 1e-6);
+        }
+        const CpuImage flat = makeImage(8, 8, {0.2f, 0.4f, 0.6f, 0.5f});
+        sharpenCpu(flat, 1.f, output);
+        for (const auto& color : output.pixels) {
+            CHECK_NEAR(color.r, 0.2, 1e-6);
+            CHECK_NEAR(color.a, 0.5, 1e-6);
+        }
+
+        // The edge gains contrast, within the limit of the negative lobe.
+        sharpenCpu(pattern, 0.5f, output);
+        checkGolden(output,
+                    {
+                        {0, 1, {0.300000f, 0.166667f, 0.250000f, 1.000000f}},
+                        {1, 1, {0.280000f, 0.333333f, 0.250000f, 1.000000f}},
+                        {2, 1, {0.727273f, 0.500000f, 0.250000f, 1.000000f}},
+                        {3, 1, {0.700000f, 0.675000f, 0.250000f, 1.000000f}},
+                    });
+        sharpenCpu(pattern, 1.f, output);
+        checkGolden(output,
+                    {
+                        {0, 1, {0.300000f, 0.166667f, 0.250000f, 1.000000f}},
+                        {1, 1, {0.250000f, 0.333333f, 0.250000f, 1.000000f}},
+                        {2, 1, {0.775000f, 0.500000f, 0.250000f, 1.000000f}},
+                        {3, 1, {0.700000f, 0.687500f, 0.250000f, 1.000000f}},
+                    });
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "deferred_release.h"
+#include "test.h"
+
+using namespace pimax_openxr;
+
+// Stands for a D3D11 fence: the values are signaled on the CPU timeline, and the GPU completes them one by one.
+struct FakeFence {
+    uint64_t signaled{0};
+    uint64_t completed{0};
+
+    uint64_t signal() {
+        return ++signaled;
+    }
+
+    void tick(uint64_t count = 1) {
+        completed = std::min(signaled, completed + count);
+    }
+};
+
+int main() {
+    FakeFence fence;
+    deferred_release::Queue<int> queue;
+    std::vector<int> released;
+    const auto release = [&](int item) { released.push_back(item); };
+
+    CHECK(queue.drain(fence.completed, release) == 0);
+    for (int i = 0; i < 5; i++) {
+        queue.push(fence.signal(), i);
+    }
+    CHECK(queue.size() == 5);
+
+    // Nothing is released before the GPU is done.
+    CHECK(queue.drain(fence.completed, release) == 0);
+    CHECK(released.empty());
+    fence.tick(2);
+    CHECK(queue.drain(fence.completed, release) == 2);
+    CHECK((released == std::vector<int>{0, 1}));
+
+    // Items retired while the GPU progresses are released in order.
+    queue.push(fence.signal(), 5);
+    fence.tick(10);
+    CHECK(queue.drain(fence.completed, release) == 4);
+    CHECK((released == std::vector<int>{0, 1, 2, 3, 4, 5}));
+    CHECK(queue.empty());
+
+    // Several items retired on the same fence value.
+    const uint64_t value = fence.signal();
+    queue.push(value, 6);
+    queue.push(value, 7);
+    queue.push(fence.signal(), 8);
+    fence.tick();
+    CHECK(queue.drain(fence.completed, release) == 2);
+    CHECK(queue.size() == 1);
+
+    // An item with an older value does not overtake the items before it.
+    queue.push(1, 9);
+    CHECK(queue.drain(fence.completed, release) == 0);
+    fence.tick();
+    CHECK(queue.drain(fence.completed, release) == 2);
+    CHECK((released == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+    // Move-only items, and draining everything at the end of the session.
+    deferred_release::Queue<std::unique_ptr<int>> owned;
+    owned.push(fence.signal(), std::make_unique<int>(42));
+    int sum = 0;
+    CHECK(owned.drain(UINT64_MAX, [&](std::unique_ptr<int>& item) { sum += *item; }) == 1);
+    CHECK(sum == 42);
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "device_cache.h"
+#include "test.h"
+
+using namespace pimax_openxr::device_cache;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Stand-ins for D3D11CreateDevice() and for the device-level resources (fence, GPU timers, shaders).
+    constexpr auto CreateDeviceTime = 10ms;
+    constexpr auto CreateResourcesTime = 5ms;
+
+    constexpr uint64_t AdapterLuid = 0x1234;
+    constexpr int SessionCount = 5;
+
+    struct Device {
+        int id;
+    };
+
+    // Follows the runtime's D3D11 session lifecycle for an interop session (D3D12, Vulkan or OpenGL), where the runtime
+    // creates the device itself.
+    class StubRuntime {
+      public:
+        explicit StubRuntime(bool warmRestart) : m_warmRestart(warmRestart) {
+        }
+
+        // createInteropD3D11Device() and initializeD3D11().
+        void createSession() {
+            const Key requested{AdapterLuid, nullptr, true};
+            if (!canReuseDevice(requested)) {
+                std::this_thread::sleep_for(CreateDeviceTime);
+                m_device = std::make_unique<Device>(Device{m_nextDeviceId++});
+                m_deviceCreatedCount++;
+            }
+
+            m_key = {AdapterLuid, m_device.get(), true};
+            const bool reused = canReuseDevice(m_key);
+            m_kept.reset();
+            if (!reused) {
+                std::this_thread::sleep_for(CreateResourcesTime);
+            }
+        }
+
+        // cleanupD3D11().
+        void destroySession() {
+            if (shouldKeep(m_key, m_warmRestart, false)) {
+                m_kept = m_key;
+            } else {
+                m_device.reset();
+            }
+        }
+
+        int getDeviceCreatedCount() const {
+            return m_deviceCreatedCount;
+        }
+
+      private:
+        bool canReuseDevice(const Key& key) {
+            if (!m_kept) {
+                return false;
+            }
+            if (canReuse(*m_kept, key)) {
+                return true;
+            }
+            m_kept.reset();
+            m_device.reset();
+            return false;
+        }
+
+        const bool m_warmRestart;
+        std::unique_ptr<Device> m_device;
+        Key m_key;
+        std::optional<Key> m_kept;
+        int m_nextDeviceId{1};
+        int m_deviceCreatedCount{0};
+    };
+
+    double toMs(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // The time of each xrCreateSession() in a sequence of sessions created and destroyed one after the other.
+    std::vector<double> measure(StubRuntime& runtime) {
+        std::vector<double> times;
+        for (int i = 0; i < SessionCount; i++) {
+            const auto start = Clock::now();
+            runtime.createSession();
+            times.push_back(toMs(Clock::now() - start));
+            runtime.destroySession();
+        }
+        return times;
+    }
+
+} // namespace
+
+// The cost of recreating a session (eg: when an application loads a level) with and without keeping the device-level
+// resources of the previous session.
+int main() {
+    StubRuntime coldRuntime(false);
+    const auto cold = measure(coldRuntime);
+    StubRuntime warmRuntime(true);
+    const auto warm = measure(warmRuntime);
+
+    std::printf("             No reuse  Reuse\n");
+    for (int i = 0; i < SessionCount; i++) {
+        std::printf("Session %-3d  %6.2f ms %6.2f ms\n", i, cold[i], warm[i]);
+    }
+
+    CHECK(coldRuntime.getDeviceCreatedCount() == SessionCount);
+    CHECK(warmRuntime.getDeviceCreatedCount() == 1);
+    CHECK(warm[1] < cold[1]);
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "device_cache.h"
+#include "test.h"
+
+using namespace pimax_openxr::device_cache;
+
+int main() {
+    int deviceA = 0, deviceB = 0;
+
+    // A native session reuses only the very same device on the same adapter.
+    const Key native{toKey(0x1234, 0), &deviceA, false};
+    CHECK(canReuse(native, {toKey(0x1234, 0), &deviceA, false}));
+    CHECK(!canReuse(native, {toKey(0x1234, 0), &deviceB, false}));
+    CHECK(!canReuse(native, {toKey(0x1234, 1), &deviceA, false}));
+    CHECK(!canReuse(native, {toKey(0x1234, 0), nullptr, true}));
+    CHECK(!canReuse(native, {toKey(0x1234, 0), nullptr, false}));
+
+    // An interop session reuses the runtime's device on the same adapter.
+    const Key interop{toKey(0x1234, 0), &deviceB, true};
+    CHECK(canReuse(interop, {toKey(0x1234, 0), nullptr, true}));
+    CHECK(canReuse(interop, {toKey(0x1234, 0), &deviceB, true}));
+    CHECK(!canReuse(interop, {toKey(0x1234, 0), &deviceA, true}));
+    CHECK(!canReuse(interop, {toKey(0x5678, 0), nullptr, true}));
+    CHECK(!canReuse(interop, {toKey(0x1234, 0), &deviceB, false}));
+
+    // Only the runtime's device is kept by default.
+    CHECK(shouldKeep(interop, true, false));
+    CHECK(!shouldKeep(native, true, false));
+    CHECK(shouldKeep(native, true, true));
+    CHECK(!shouldKeep(interop, false, true));
+    CHECK(!shouldKeep(native, false, true));
+
+    CHECK(toKey(0xffffffff, -1) == ~0ull);
+    CHECK(toKey(1, 2) == 0x200000001ull);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "dynamic_resolution.h"
+#include "test.h"
+
+using namespace pimax_openxr::dynamic_resolution;
+
+// A simulated application whose GPU time is proportional to the render area, and which applies the recommended scale
+// one frame late.
+struct MockApplication {
+    double fullScaleGpuTimeUs;
+    float appliedScale{1.f};
+
+    double render(float recommendedScale) {
+        const double gpuTimeUs = fullScaleGpuTimeUs * appliedScale * appliedScale;
+        appliedScale = recommendedScale;
+        return gpuTimeUs;
+    }
+};
+
+int main() {
+    const double frameBudgetUs = 1e6 / 90;
+
+    // A heavy application converges to the target utilization.
+    {
+        Governor governor{GovernorSettings{}};
+        MockApplication application{frameBudgetUs * 1.5};
+        float scale = governor.getScale();
+        CHECK(scale == 1.f);
+        for (int i = 0; i < 300; i++) {
+            const float applied = application.appliedScale;
+            scale = governor.update(application.render(scale), frameBudgetUs, applied);
+        }
+        const double utilization = application.render(scale) / frameBudgetUs;
+        CHECK_NEAR(utilization, governor.getSettings().targetUtilization, 0.05);
+        CHECK(scale > governor.getSettings().minScale);
+        CHECK(scale < 1.f);
+    }
+
+    // A light application stays at the maximum scale.
+    {
+        Governor governor{GovernorSettings{}};
+        MockApplication application{frameBudgetUs * 0.5};
+        float scale = governor.getScale();
+        for (int i = 0; i < 300; i++) {
+            scale = governor.update(application.render(scale), frameBudgetUs);
+        }
+        CHECK(scale == 1.f);
+    }
+
+    // The scale is bounded.
+    {
+        Governor governor{GovernorSettings{}};
+        MockApplication application{frameBudgetUs * 100};
+        float scale = governor.getScale();
+        for (int i = 0; i < 300; i++) {
+            scale = governor.update(application.render(scale), frameBudgetUs);
+        }
+        CHECK_NEAR(scale, governor.getSettings().minScale, 1e-5);
+    }
+
+    // Noise within the hysteresis does not move the scale.
+    {
+        Governor governor{GovernorSettings{}};
+        const double targetUs = frameBudgetUs * governor.getSettings().targetUtilization;
+        for (int i = 0; i < 300; i++) {
+            CHECK(governor.update(targetUs * (i % 2 ? 1.05 : 0.95), frameBudgetUs) == 1.f);
+        }
+        CHECK(!governor.isEngaged());
+    }
+
+    // The scale does not wind up when the application does not follow the recommendation.
+    {
+        Governor governor{GovernorSettings{}};
+        for (int i = 0; i < 300; i++) {
+            governor.update(frameBudgetUs * 1.5, frameBudgetUs, 1.f);
+        }
+        CHECK(governor.getScale() > 0.9f);
+    }
+
+    // The timers are not ready.
+    {
+        Governor governor{GovernorSettings{}};
+        CHECK(governor.update(0, frameBudgetUs) == 1.f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "event_queue.h"
+#include "test.h"
+
+using namespace pimax_openxr::event_queue;
+
+struct Item {
+    uint32_t producer;
+    uint32_t index;
+};
+
+int main() {
+    // Items are delivered in order, and dropped when the queue is full.
+    {
+        BoundedQueue<Item, 64> queue;
+        Item item;
+        CHECK(!queue.pop(item));
+        for (uint32_t i = 0; i < 64; i++) {
+            CHECK(queue.push({0, i}));
+        }
+        CHECK(!queue.push({0, 64}));
+        CHECK(queue.takeLostCount() == 1);
+        CHECK(queue.takeLostCount() == 0);
+        for (uint32_t i = 0; i < 64; i++) {
+            CHECK(queue.pop(item));
+            CHECK(item.index == i);
+        }
+        CHECK(!queue.pop(item));
+
+        queue.push({0, 0});
+        queue.clear();
+        CHECK(!queue.pop(item));
+    }
+
+    // The reserved cells only take priority items, and the order of all items is kept.
+    {
+        BoundedQueue<Item, 16, 4> queue;
+        for (uint32_t i = 0; i < 12; i++) {
+            CHECK(queue.push({0, i}));
+        }
+        CHECK(!queue.push({0, 12}));
+        for (uint32_t i = 12; i < 16; i++) {
+            CHECK(queue.push({1, i}, true));
+        }
+        CHECK(!queue.push({1, 16}, true));
+        CHECK(queue.takeLostCount() == 2);
+
+        Item item;
+        for (uint32_t i = 0; i < 16; i++) {
+            CHECK(queue.pop(item));
+            CHECK(item.index == i);
+            CHECK(item.producer == (i < 12 ? 0u : 1u));
+        }
+
+        // Popping frees the non-reserved cells again.
+        CHECK(queue.push({0, 16}));
+    }
+
+    // Stress: producers flooding the queue with other items never cause a priority item to be dropped, as long as the
+    // consumer polls before more than the reserved number of priority items are pending. This is the case of the
+    // session state changes, which happen in the application's frame loop, and are polled once per frame.
+    {
+        constexpr uint32_t ProducerCount = 2;
+        constexpr uint32_t BurstCount = 100;
+        constexpr uint32_t BurstSize = 4;
+        BoundedQueue<Item, 64, 16> queue;
+        std::atomic<bool> stop{false};
+        std::atomic<uint32_t> polledBursts{0};
+
+        std::vector<std::thread> producers;
+        for (uint32_t producer = 1; producer <= ProducerCount; producer++) {
+            producers.emplace_back([&queue, &stop, producer] {
+                for (uint32_t i = 0; !stop; i++) {
+                    if (!queue.push({producer, i})) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        // Like the application's frame loop.
+        std::thread frameLoop([&] {
+            for (uint32_t burst = 0; burst < BurstCount; burst++) {
+                for (uint32_t i = 0; i < BurstSize; i++) {
+                    CHECK(queue.push({0, burst * BurstSize + i}, true));
+                }
+                while (polledBursts.load() <= burst) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        // Like xrPollEvent().
+        uint32_t nextPriorityIndex = 0;
+        while (nextPriorityIndex < BurstCount * BurstSize) {
+            Item item;
+            if (queue.pop(item) && item.producer == 0) {
+                CHECK(item.index == nextPriorityIndex);
+                nextPriorityIndex++;
+                polledBursts = nextPriorityIndex / BurstSize;
+            }
+        }
+
+        frameLoop.join();
+        stop = true;
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        CHECK(queue.takeLostCount() > 0);
+    }
+
+    // Stress: several producers and one consumer. The items of each producer are delivered in order.
+    {
+        constexpr uint32_t ProducerCount = 8;
+        constexpr uint32_t ItemCount = 5000;
+        BoundedQueue<Item, 64> queue;
+
+        std::vector<std::thread> producers;
+        for (uint32_t producer = 0; producer < ProducerCount; producer++) {
+            producers.emplace_back([&queue, producer] {
+                for (uint32_t i = 0; i < ItemCount; i++) {
+                    while (!queue.push({producer, i})) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<int64_t> last(ProducerCount, -1);
+        uint64_t popped = 0;
+        while (popped < (uint64_t)ProducerCount * ItemCount) {
+            Item item;
+            if (queue.pop(item)) {
+                CHECK((int64_t)item.index == last[item.producer] + 1);
+                last[item.producer] = item.index;
+                popped++;
+            }
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        Item item;
+        CHECK(!queue.pop(item));
+    }
+
+    return 0;
+}
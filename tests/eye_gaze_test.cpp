@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "eye_gaze.h"
+#include "test.h"
+
+using namespace pimax_openxr::eye_gaze;
+
+int main() {
+    constexpr double Pi = 3.14159265358979323846;
+    constexpr double Degree = Pi / 180.0;
+
+    // The simulated gaze sweeps 15 degrees horizontally with a 4 s period, and 10 degrees vertically with a 2 s period.
+    {
+        float horizontal = 1.f, vertical = 1.f;
+        getSimulatedGaze(0.0, horizontal, vertical);
+        CHECK_NEAR(horizontal, 0.0, 1e-6);
+        CHECK_NEAR(vertical, 0.0, 1e-6);
+
+        getSimulatedGaze(1.0, horizontal, vertical);
+        CHECK_NEAR(horizontal, 15.0 * Degree, 1e-6);
+        CHECK_NEAR(vertical, 0.0, 1e-6);
+
+        getSimulatedGaze(0.5, horizontal, vertical);
+        CHECK_NEAR(horizontal, 15.0 * Degree * std::sin(Pi / 4.0), 1e-6);
+        CHECK_NEAR(vertical, 10.0 * Degree, 1e-6);
+
+        getSimulatedGaze(3.0, horizontal, vertical);
+        CHECK_NEAR(horizontal, -15.0 * Degree, 1e-6);
+        CHECK_NEAR(vertical, 0.0, 1e-6);
+
+        // Reproducible from the timestamp alone.
+        float horizontal2 = 0.f, vertical2 = 0.f;
+        getSimulatedGaze(1234.567, horizontal, vertical);
+        getSimulatedGaze(1234.567, horizontal2, vertical2);
+        CHECK(horizontal == horizontal2);
+        CHECK(vertical == vertical2);
+        getSimulatedGaze(1234.567 + 4.0, horizontal2, vertical2);
+        CHECK_NEAR(horizontal, horizontal2, 1e-4);
+        CHECK_NEAR(vertical, vertical2, 1e-4);
+    }
+
+    // Both eyes are averaged.
+    {
+        float horizontal = 0.f, vertical = 0.f;
+        combineEyes(XrVector2f{0.2f, -0.1f}, XrVector2f{0.f, 0.1f}, horizontal, vertical);
+        CHECK_NEAR(horizontal, std::atan(0.1), 1e-6);
+        CHECK_NEAR(vertical, 0.0, 1e-6);
+
+        combineEyes(XrVector2f{1.f, 1.f}, XrVector2f{1.f, 1.f}, horizontal, vertical);
+        CHECK_NEAR(horizontal, Pi / 4.0, 1e-6);
+        CHECK_NEAR(vertical, Pi / 4.0, 1e-6);
+    }
+
+    // The age of the sample gives the confidence.
+    {
+        constexpr XrSpaceLocationFlags Tracked =
+            XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+        constexpr XrSpaceLocationFlags Valid = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+
+        CHECK(getLocationFlags(0.1f, 0.1f, 0.0) == Tracked);
+        CHECK(getLocationFlags(0.1f, 0.1f, TrackedMaxAge) == Tracked);
+        CHECK(getLocationFlags(0.1f, 0.1f, 0.051) == Valid);
+        CHECK(getLocationFlags(0.1f, 0.1f, ValidMaxAge) == Valid);
+        CHECK(getLocationFlags(0.1f, 0.1f, 0.501) == 0);
+
+        // Invalid tangents from the tracker are not reported.
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float inf = std::numeric_limits<float>::infinity();
+        CHECK(getLocationFlags(nan, 0.f, 0.0) == 0);
+        CHECK(getLocationFlags(0.f, inf, 0.0) == 0);
+    }
+
+    return 0;
+}
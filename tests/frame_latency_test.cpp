@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "frame_latency.h"
+#include "test.h"
+
+using namespace pimax_openxr::frame_latency;
+
+int main() {
+    // 20 seconds at 90 Hz, with one frame in 20 submitted 20 ms late.
+    const double framePeriod = 1.0 / 90;
+    Tracker tracker;
+    uint32_t expectedFrames = 0;
+    uint32_t expectedLate = 0;
+    uint32_t expectedStutters = 0;
+    uint32_t summaryCount = 0;
+    double now = 0.0;
+    for (int i = 0; i < 1800; i++) {
+        const bool isSpike = i % 20 == 0;
+
+        FrameRecord record;
+        record.waitStart = now;
+        record.waitEnd = now + 0.002;
+        record.begin = now + 0.0025;
+        record.endSubmit = now + 0.008 + (isSpike ? 0.02 : 0.0);
+        record.compositorReturn = record.endSubmit + 0.0005;
+        record.predictedDisplayTime = now + 0.02;
+        record.framePeriod = framePeriod;
+        CHECK(Tracker::isLate(record) == isSpike);
+        tracker.record(record);
+
+        expectedFrames++;
+        if (isSpike) {
+            expectedLate++;
+            if (i > 0) {
+                expectedStutters++;
+            }
+        }
+
+        now += framePeriod;
+        const auto summary = tracker.getSummaryIfDue(now, 5.0);
+        if (summary) {
+            summaryCount++;
+            CHECK(summary->frameCount == expectedFrames);
+            CHECK(summary->lateFrameCount == expectedLate);
+            CHECK(summary->stutterCount == expectedStutters);
+            CHECK(summary->duration >= 5.0);
+            CHECK_NEAR(summary->motionToPhoton.p50, 0.018, 1e-9);
+            CHECK_NEAR(summary->appFrameTime.p50, 0.0055, 1e-9);
+            CHECK_NEAR(summary->appFrameTime.p99, 0.0255, 1e-9);
+            CHECK_NEAR(summary->submitDuration.p90, 0.0005, 1e-9);
+            CHECK_NEAR(summary->lateness.p50, -0.0115, 1e-9);
+            CHECK(summary->lateness.p99 > 0.0);
+            expectedFrames = expectedLate = expectedStutters = 0;
+        }
+    }
+    CHECK(summaryCount == 3);
+
+    // No summary before the end of the period.
+    tracker.reset();
+    CHECK(!tracker.getSummaryIfDue(100.0, 5.0));
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "frame_pacing.h"
+#include "test.h"
+
+using namespace pimax_openxr::frame_pacing;
+
+int main() {
+    CHECK(getRateDivisor(false, 0) == 1);
+    CHECK(getRateDivisor(true, 0) == 2);
+    CHECK(getRateDivisor(false, 3) == 3);
+    CHECK(getRateDivisor(true, 10) == MaxRateDivisor);
+
+    // The divisor is queried at most once per period.
+    {
+        DivisorSampler sampler(0.1);
+        CHECK(sampler.getDivisor() == 1);
+
+        int queryCount = 0;
+        uint32_t divisor = 2;
+        const auto query = [&] {
+            queryCount++;
+            return divisor;
+        };
+        CHECK(sampler.sample(1.0, query));
+        CHECK(sampler.getDivisor() == 2);
+        divisor = 3;
+        for (int i = 1; i < 9; i++) {
+            CHECK(!sampler.sample(1.0 + i / 90.0, query));
+            CHECK(sampler.getDivisor() == 2);
+        }
+        CHECK(queryCount == 1);
+        CHECK(sampler.sample(1.1, query));
+        CHECK(sampler.getDivisor() == 3);
+        CHECK(queryCount == 2);
+
+        sampler.reset();
+        CHECK(sampler.getDivisor() == 1);
+        CHECK(sampler.sample(1.11, query));
+        CHECK(queryCount == 3);
+    }
+
+    // A higher divisor is followed after a few frames, a lower one immediately.
+    {
+        Pacer pacer(3);
+        CHECK(!pacer.update(2));
+        CHECK(!pacer.update(2));
+        CHECK(pacer.update(2));
+        CHECK(pacer.getDivisor() == 2);
+        CHECK(pacer.update(1));
+        CHECK(pacer.getDivisor() == 1);
+    }
+
+    // Short bursts of a higher divisor are ignored.
+    {
+        Pacer pacer(3);
+        for (int i = 0; i < 10; i++) {
+            CHECK(!pacer.update(i % 3 ? 2 : 1));
+        }
+        CHECK(pacer.getDivisor() == 1);
+    }
+
+    // Divisors are clamped.
+    {
+        Pacer pacer(1);
+        CHECK(pacer.update(10));
+        CHECK(pacer.getDivisor() == MaxRateDivisor);
+    }
+
+    // Frame timing with a divided rate, on a synthetic 90 Hz clock.
+    {
+        const double frameDuration = 1.0 / 90;
+        Pacer pacer(1);
+        double vsync = 1.0;
+        double lastPredicted = pacer.predictDisplayTime(vsync, frameDuration);
+        CHECK(lastPredicted == vsync);
+
+        pacer.update(2);
+        CHECK_NEAR(pacer.getFramePeriod(frameDuration), 2 * frameDuration, 1e-12);
+        CHECK_NEAR(pacer.getNextWakeTime(vsync, frameDuration), vsync + 2 * frameDuration, 1e-12);
+        vsync += frameDuration;
+        double predicted = pacer.predictDisplayTime(vsync, frameDuration);
+        CHECK_NEAR(predicted, vsync + frameDuration, 1e-12);
+        lastPredicted = predicted;
+
+        // Predictions remain strictly increasing across a transition back to the full rate.
+        pacer.update(1);
+        predicted = pacer.predictDisplayTime(vsync, frameDuration);
+        CHECK(predicted > lastPredicted);
+        lastPredicted = predicted;
+        for (int i = 0; i < 10; i++) {
+            vsync += frameDuration;
+            predicted = pacer.predictDisplayTime(vsync, frameDuration);
+            CHECK(predicted > lastPredicted);
+            lastPredicted = predicted;
+        }
+    }
+
+    return 0;
+}
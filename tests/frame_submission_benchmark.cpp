@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "frame_submission.h"
+#include "test.h"
+
+using namespace pimax_openxr::frame_submission;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // A stand-in for pvr_endFrame(), blocking like the compositor does.
+    constexpr auto EndFrameBlockTime = 5ms;
+
+    // The time that the application spends on its next frame before xrBeginFrame().
+    constexpr auto RenderTime = 2ms;
+
+    constexpr int FrameCount = 50;
+
+    void endFrame() {
+        std::this_thread::sleep_for(EndFrameBlockTime);
+    }
+
+    double toMs(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    struct Slot {
+        int frameIndex{0};
+    };
+
+} // namespace
+
+// The time that the application's render thread spends in xrEndFrame(), with pvr_endFrame() called inline or from the
+// submission thread.
+int main() {
+    std::mutex frameLock;
+    std::condition_variable frameCondVar;
+
+    double inlineEndFrameMs = 0.0;
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < FrameCount; i++) {
+            // xrBeginFrame() and rendering.
+            {
+                std::unique_lock lock(frameLock);
+            }
+            std::this_thread::sleep_for(RenderTime);
+
+            // xrEndFrame().
+            const auto endFrameStart = Clock::now();
+            {
+                std::unique_lock lock(frameLock);
+                endFrame();
+            }
+            inlineEndFrameMs += toMs(Clock::now() - endFrameStart);
+        }
+        std::printf("Inline submission: xrEndFrame() %.2f ms, frame %.2f ms\n",
+                    inlineEndFrameMs / FrameCount,
+                    toMs(Clock::now() - start) / FrameCount);
+    }
+
+    double asyncEndFrameMs = 0.0;
+    {
+        Submitter<Slot> submitter;
+        submitter.start(
+            frameLock, frameCondVar, [&](Slot&) { endFrame(); }, [&](Slot&, const std::optional<std::string>&) {});
+
+        const auto start = Clock::now();
+        for (int i = 0; i < FrameCount; i++) {
+            // xrBeginFrame() waits for the previous submission, then rendering.
+            {
+                std::unique_lock lock(frameLock);
+                submitter.wait(lock);
+                submitter.rethrowError();
+            }
+            std::this_thread::sleep_for(RenderTime);
+
+            // xrEndFrame().
+            const auto endFrameStart = Clock::now();
+            {
+                std::unique_lock lock(frameLock);
+                submitter.getSlot().frameIndex = i;
+                submitter.queue(lock);
+            }
+            asyncEndFrameMs += toMs(Clock::now() - endFrameStart);
+        }
+        submitter.stop();
+        std::printf("Submission thread: xrEndFrame() %.2f ms, frame %.2f ms\n",
+                    asyncEndFrameMs / FrameCount,
+                    toMs(Clock::now() - start) / FrameCount);
+    }
+
+    CHECK(asyncEndFrameMs < inlineEndFrameMs);
+
+    return 0;
+}
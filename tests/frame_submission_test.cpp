@@ -0,0 +1,163 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "frame_submission.h"
+#include "test.h"
+
+using namespace pimax_openxr::frame_submission;
+
+namespace {
+
+    struct Slot {
+        int frameIndex{0};
+        bool shouldFail{false};
+    };
+
+} // namespace
+
+int main() {
+    // Frames are submitted in order with the content of the slot at the time they were queued, and completed under the
+    // lock.
+    {
+        std::mutex frameLock;
+        std::condition_variable frameCondVar;
+        std::vector<int> submitted;
+        int completed = 0;
+
+        Submitter<Slot> submitter;
+        submitter.start(
+            frameLock,
+            frameCondVar,
+            [&](Slot& slot) { submitted.push_back(slot.frameIndex); },
+            [&](Slot&, const std::optional<std::string>& error) {
+                CHECK(!error);
+                completed++;
+            });
+        CHECK(submitter.isRunning());
+
+        for (int i = 1; i <= 100; i++) {
+            std::unique_lock lock(frameLock);
+            submitter.wait(lock);
+            submitter.getSlot().frameIndex = i;
+            submitter.queue(lock);
+        }
+        {
+            std::unique_lock lock(frameLock);
+            submitter.wait(lock);
+            CHECK(!submitter.isPending());
+            CHECK(completed == 100);
+        }
+        submitter.stop();
+        CHECK(!submitter.isRunning());
+
+        CHECK(submitted.size() == 100);
+        for (int i = 0; i < 100; i++) {
+            CHECK(submitted[i] == i + 1);
+        }
+    }
+
+    // An error thrown on the thread is rethrown by the next xrBeginFrame(), and only once.
+    {
+        std::mutex frameLock;
+        std::condition_variable frameCondVar;
+        std::optional<std::string> completedError;
+
+        Submitter<Slot> submitter;
+        submitter.start(
+            frameLock,
+            frameCondVar,
+            [&](Slot& slot) {
+                if (slot.shouldFail) {
+                    throw std::runtime_error("pvr_endFrame failed");
+                }
+            },
+            [&](Slot&, const std::optional<std::string>& error) { completedError = error; });
+
+        // xrEndFrame().
+        {
+            std::unique_lock lock(frameLock);
+            submitter.getSlot().shouldFail = true;
+            submitter.queue(lock);
+        }
+
+        // xrBeginFrame(): wait for the previous submission, then report its error.
+        {
+            std::unique_lock lock(frameLock);
+            submitter.wait(lock);
+            CHECK(completedError == std::optional<std::string>("pvr_endFrame failed"));
+
+            bool thrown = false;
+            try {
+                submitter.rethrowError();
+            } catch (std::runtime_error& exc) {
+                thrown = true;
+                CHECK(std::string(exc.what()) == "pvr_endFrame failed");
+            }
+            CHECK(thrown);
+
+            // The next xrBeginFrame() succeeds.
+            submitter.rethrowError();
+        }
+
+        // The thread keeps running after a failure.
+        {
+            std::unique_lock lock(frameLock);
+            submitter.getSlot().shouldFail = false;
+            submitter.queue(lock);
+            submitter.wait(lock);
+            CHECK(!completedError);
+            submitter.rethrowError();
+        }
+    }
+
+    // Stopping completes the pending submission first.
+    {
+        std::mutex frameLock;
+        std::condition_variable frameCondVar;
+        std::atomic<int> submitted{0};
+
+        Submitter<Slot> submitter;
+        submitter.start(
+            frameLock,
+            frameCondVar,
+            [&](Slot&) {
+                std::this_thread::sleep_for(10ms);
+                submitted++;
+            },
+            [&](Slot&, const std::optional<std::string>&) {});
+        {
+            std::unique_lock lock(frameLock);
+            submitter.queue(lock);
+        }
+        submitter.stop();
+        CHECK(submitted == 1);
+
+        // Stopping again, or a submitter that was never started, does nothing.
+        submitter.stop();
+        Submitter<Slot> idle;
+        idle.stop();
+    }
+
+    return 0;
+}
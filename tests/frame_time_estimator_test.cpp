@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "frame_time_estimator.h"
+#include "test.h"
+
+using namespace pimax_openxr::frame_time_estimator;
+
+int main() {
+    // Rolling median, with the upper median for an even count.
+    {
+        RollingMedian median(5);
+        CHECK(median.empty());
+        const double samples[] = {5, 1, 4, 2, 3, 9, 9, 9};
+        const double expected[] = {5, 5, 4, 4, 3, 3, 4, 9};
+        for (size_t i = 0; i < std::size(samples); i++) {
+            median.push(samples[i]);
+            CHECK(median.get() == expected[i]);
+        }
+        median.setWindowLength(1000);
+        CHECK(median.getWindowLength() == MaxWindowLength);
+    }
+
+    // A spike moves the estimate by a bounded amount.
+    {
+        Estimator estimator;
+        estimator.setWindowLength(5);
+        for (int i = 0; i < 10; i++) {
+            CHECK(estimator.update(8000) == 8000);
+        }
+        const double afterSpike = estimator.update(30000);
+        CHECK(afterSpike > 8000);
+        CHECK(afterSpike < 8000 * 1.25);
+        for (int i = 0; i < 10; i++) {
+            estimator.update(8000);
+        }
+        CHECK_NEAR(estimator.getPrediction(), 8000, 100);
+    }
+
+    // A sustained step is detected within stepFrames frames.
+    {
+        EstimatorSettings settings;
+        settings.stepFrames = 3;
+        Estimator estimator(settings);
+        estimator.setWindowLength(15);
+        for (int i = 0; i < 20; i++) {
+            estimator.update(8000);
+        }
+        estimator.update(12000);
+        estimator.update(12000);
+        CHECK(estimator.update(12000) == 12000);
+        CHECK(estimator.getMedian() == 12000);
+        CHECK(estimator.getTrend() == 0.0);
+
+        // Same downwards.
+        estimator.update(6000);
+        estimator.update(6000);
+        CHECK(estimator.update(6000) == 6000);
+    }
+
+    // A gradual ramp is followed with little lag.
+    {
+        Estimator estimator;
+        estimator.setWindowLength(5);
+        for (int i = 0; i < 30; i++) {
+            const double sample = 8000.0 + i * 100;
+            const double prediction = estimator.update(sample);
+            if (i >= 10) {
+                CHECK_NEAR(prediction, sample + 100, 150);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "gpu_memory.h"
+#include "test.h"
+
+using namespace pimax_openxr::gpu_memory;
+
+int main() {
+    // Size estimates.
+    CHECK(estimateTextureSize(4, 4, 1, 1, 1, 32) == 64);
+    CHECK(estimateTextureSize(4, 4, 1, 3, 1, 32) == 64 + 16 + 4);
+    CHECK(estimateTextureSize(4, 4, 2, 1, 4, 32) == 64 * 8);
+    CHECK(estimateTextureSize(4, 4, 1, 1, 1, 4) == 8);
+
+    // Accounting per owner and per category.
+    {
+        Accounting accounting;
+        int a = 0, b = 0;
+        accounting.add(Category::Swapchain, &a, 100);
+        accounting.add(Category::SliceSwapchain, &a, 50);
+        accounting.add(Category::Swapchain, &b, 10);
+        CHECK(accounting.getTotal() == 160);
+        CHECK(accounting.getTotal(&a) == 150);
+        CHECK(accounting.getTotal(Category::Swapchain) == 110);
+
+        // Over-releasing does not underflow.
+        accounting.release(Category::SliceSwapchain, &a, 500);
+        CHECK(accounting.getTotal(&a) == 100);
+        CHECK(accounting.getTotal() == 110);
+
+        accounting.releaseAll(&a);
+        CHECK(accounting.getTotal() == 10);
+        CHECK(accounting.getTotal(&a) == 0);
+        CHECK(accounting.getPeak() == 160);
+
+        accounting.release(Category::Swapchain, &b, 10);
+        CHECK(accounting.getTotal() == 0);
+    }
+
+    // Scratch resources shared between swapchains.
+    {
+        using Pool = ScratchPool<int>;
+        Pool pool;
+        int createdCount = 0;
+        const auto create = [&](uint64_t& size) {
+            size = 1000;
+            return ++createdCount;
+        };
+        const Pool::Key k1{100, 100, 1}, k2{100, 100, 2}, k3{200, 100, 1};
+
+        // Same key, same resource.
+        CHECK(pool.acquire(k1, 0, create) == pool.acquire(k1, 1, create));
+        CHECK(createdCount == 1);
+        CHECK(pool.getCreatedCount() == 1);
+        pool.acquire(k2, 2, create);
+        pool.acquire(k3, 3, create);
+        CHECK(pool.getCount() == 3);
+        CHECK(pool.getSize() == 3000);
+
+        std::vector<uint32_t> evicted;
+        const auto onEvict = [&](const Pool::Key& key, uint64_t size) {
+            evicted.push_back(key.format * 1000 + key.width);
+            CHECK(size == 1000);
+        };
+
+        // Idle eviction.
+        CHECK(pool.evict(3, 10, ~0ull, onEvict) == 0);
+        CHECK(pool.evict(12, 10, ~0ull, onEvict) == 1);
+        CHECK(evicted.back() == 1100);
+
+        // Over the size limit, the least recently used resource goes first.
+        pool.acquire(k1, 13, create);
+        CHECK(createdCount == 4);
+        CHECK(pool.evict(13, 100, 2000, onEvict) == 1);
+        CHECK(evicted.back() == 2100);
+        CHECK(pool.getCount() == 2);
+
+        // The resources used during the current tick are kept, even over the limit.
+        CHECK(pool.evict(13, 100, 0, onEvict) == 1);
+        CHECK(evicted.back() == 1200);
+        CHECK(pool.getCount() == 1);
+        CHECK(pool.getSize() == 1000);
+
+        pool.clear(onEvict);
+        CHECK(pool.getCount() == 0);
+        CHECK(evicted.size() == 4);
+    }
+
+    // Every category has a name.
+    for (uint32_t i = 0; i < (uint32_t)Category::Count; i++) {
+        CHECK(std::string(ToString((Category)i)) != "Unknown");
+    }
+
+    return 0;
+}
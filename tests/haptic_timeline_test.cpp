@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "haptic_timeline.h"
+#include "test.h"
+
+using namespace pimax_openxr::haptic_timeline;
+
+// Stands for the controller: records the pulses it receives.
+struct MockController {
+    std::vector<std::pair<double, float>> pulses;
+};
+
+// Drive a timeline like the haptics thread does: wake up at the next pulse time, late by `jitter`.
+static void run(Timeline& timeline, MockController& controller, double until, double jitter) {
+    double now = 0.0;
+    while (true) {
+        const auto next = timeline.getNextPulseTime();
+        if (!next || next.value() > until) {
+            break;
+        }
+        now = std::max(now, next.value()) + jitter;
+        const auto amplitude = timeline.poll(now);
+        if (amplitude) {
+            controller.pulses.push_back({now, amplitude.value()});
+        }
+    }
+}
+
+int main() {
+    const Settings settings;
+
+    // Pulses at the requested frequency for the requested duration.
+    {
+        Timeline timeline;
+        MockController controller;
+        timeline.start(0.0, {0.5f, 100.0, 0.05}, settings);
+        run(timeline, controller, 1.0, 0.0);
+        CHECK(controller.pulses.size() == 5);
+        for (size_t i = 0; i < controller.pulses.size(); i++) {
+            CHECK_NEAR(controller.pulses[i].first, i * 0.01, 1e-9);
+            CHECK(controller.pulses[i].second == 0.5f);
+        }
+    }
+
+    // XR_MIN_HAPTIC_DURATION is a single pulse.
+    {
+        Timeline timeline;
+        MockController controller;
+        timeline.start(0.0, {1.f, 0.0, 0.0}, settings);
+        run(timeline, controller, 1.0, 0.0);
+        CHECK(controller.pulses.size() == 1);
+    }
+
+    // The frequency is capped.
+    {
+        Timeline timeline;
+        MockController controller;
+        timeline.start(0.0, {1.f, 1000.0, 0.01}, settings);
+        run(timeline, controller, 1.0, 0.0);
+        CHECK(controller.pulses.size() == 4);
+    }
+
+    // A new vibration preempts the current one.
+    {
+        Timeline timeline;
+        MockController controller;
+        timeline.start(0.0, {0.5f, 100.0, 0.1}, settings);
+        run(timeline, controller, 0.025, 0.0);
+        timeline.start(0.03, {0.2f, 50.0, 0.04}, settings);
+        run(timeline, controller, 1.0, 0.0);
+        CHECK(controller.pulses.size() == 5);
+        CHECK(controller.pulses[3].first == 0.03);
+        CHECK(controller.pulses[4].second == 0.2f);
+    }
+
+    // Stopping.
+    {
+        Timeline timeline;
+        MockController controller;
+        timeline.start(0.0, {0.5f, 100.0, 0.1}, settings);
+        run(timeline, controller, 0.025, 0.0);
+        timeline.stop();
+        CHECK(!timeline.getNextPulseTime());
+    }
+
+    // Late wake ups skip pulses rather than bunching them.
+    {
+        Timeline timeline;
+        MockController controller;
+        timeline.start(0.0, {0.5f, 100.0, 0.1}, settings);
+        run(timeline, controller, 1.0, 0.025);
+        CHECK(!controller.pulses.empty());
+        for (size_t i = 1; i < controller.pulses.size(); i++) {
+            CHECK(controller.pulses[i].first - controller.pulses[i - 1].first >= 0.01 - 1e-9);
+        }
+    }
+
+    // A null amplitude does nothing.
+    {
+        Timeline timeline;
+        timeline.start(0.0, {0.f, 100.0, 1.0}, settings);
+        CHECK(!timeline.isActive());
+    }
+
+    return 0;
+}
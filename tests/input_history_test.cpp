@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "input_history.h"
+#include "test.h"
+
+using namespace pimax_openxr::input_history;
+
+// A sample large enough to be torn by a concurrent overwrite, with all fields derived from its index.
+struct TestSample {
+    uint64_t index;
+    double time;
+    std::array<uint32_t, 13> values;
+
+    static TestSample make(uint64_t index) {
+        TestSample sample{index, index * 0.001, {}};
+        for (uint32_t i = 0; i < sample.values.size(); i++) {
+            sample.values[i] = (uint32_t)(index * 31 + i);
+        }
+        return sample;
+    }
+
+    bool isConsistent() const {
+        const TestSample expected = make(index);
+        return time == expected.time && values == expected.values;
+    }
+};
+
+int main() {
+    // Samples are read in order, and the overwritten ones are reported as lost.
+    {
+        SampleRing<int, 8> ring;
+        uint64_t sequence = 0;
+        uint64_t lostCount = 0;
+        std::vector<int> samples;
+        const auto visitor = [&](int sample) { samples.push_back(sample); };
+
+        for (int i = 0; i < 5; i++) {
+            ring.push(i);
+        }
+        sequence = ring.read(sequence, visitor, lostCount);
+        CHECK((samples == std::vector<int>{0, 1, 2, 3, 4}));
+        CHECK(lostCount == 0);
+
+        for (int i = 5; i < 20; i++) {
+            ring.push(i);
+        }
+        samples.clear();
+        sequence = ring.read(sequence, visitor, lostCount);
+        CHECK(samples.size() == 8);
+        CHECK(samples.front() == 12);
+        CHECK(samples.back() == 19);
+        CHECK(lostCount == 7);
+        CHECK(sequence == ring.getWriteSequence());
+
+        int value;
+        CHECK(ring.get(19, value));
+        CHECK(value == 19);
+        CHECK(!ring.get(11, value));
+        CHECK(!ring.get(20, value));
+    }
+
+    // A press and release between two syncs is still reported.
+    {
+        BitChannel channel;
+        channel.reset();
+        channel.observe(1.00, 1);
+        channel.observe(1.02, 0);
+        CHECK(channel.latch() == 1);
+        CHECK(channel.getChangeTime(1) == 1.00);
+        CHECK(channel.latch() == 0);
+        CHECK(channel.getChangeTime(1) == 1.02);
+
+        channel.observe(2.0, 2);
+        CHECK(channel.latch() == 2);
+        CHECK(channel.latch() == 2);
+        CHECK(channel.getChangeTime(2) == 2.0);
+        channel.observe(2.5, 0);
+        CHECK(channel.latch() == 0);
+        CHECK(channel.getChangeTime(2) == 2.5);
+        CHECK(channel.getLatched() == 0);
+    }
+
+    // Stress: the sampler thread overwrites the slots while several threads read them. A small ring makes the readers
+    // lapped often. The samples that are returned must never be torn. Build with PIMAXXR_TESTS_TSAN to also verify
+    // that there is no data race.
+    {
+        constexpr uint64_t SampleCount = 200000;
+        SampleRing<TestSample, 8> ring;
+        std::atomic<bool> stop{false};
+
+        std::thread sampler([&] {
+            for (uint64_t i = 0; i < SampleCount; i++) {
+                ring.push(TestSample::make(i));
+            }
+            stop = true;
+        });
+
+        std::vector<std::thread> readers;
+        std::atomic<uint64_t> readCount{0};
+        std::atomic<uint64_t> lostCount{0};
+
+        // Like xrSyncActions(): drain the samples since the previous read.
+        readers.emplace_back([&] {
+            uint64_t sequence = 0;
+            uint64_t lost = 0;
+            uint64_t lastIndex = 0;
+            uint64_t count = 0;
+            while (!stop) {
+                sequence = ring.read(
+                    sequence,
+                    [&](const TestSample& sample) {
+                        CHECK(sample.isConsistent());
+                        CHECK(count == 0 || sample.index > lastIndex);
+                        lastIndex = sample.index;
+                        count++;
+                    },
+                    lost);
+            }
+            readCount += count;
+            lostCount += lost;
+        });
+
+        // Like the pose history: random access to the recent samples.
+        for (int i = 0; i < 2; i++) {
+            readers.emplace_back([&] {
+                uint64_t count = 0;
+                while (!stop) {
+                    const uint64_t end = ring.getWriteSequence();
+                    for (uint64_t sequence = end > 8 ? end - 8 : 0; sequence < end; sequence++) {
+                        TestSample sample;
+                        if (ring.get(sequence, sample)) {
+                            CHECK(sample.index == sequence);
+                            CHECK(sample.isConsistent());
+                            count++;
+                        }
+                    }
+                }
+                readCount += count;
+            });
+        }
+
+        sampler.join();
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        CHECK(readCount > 0);
+        printf("%llu samples read, %llu lost\n",
+               (unsigned long long)readCount.load(),
+               (unsigned long long)lostCount.load());
+    }
+
+    return 0;
+}
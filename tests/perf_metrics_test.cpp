@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "perf_metrics.h"
+#include "test.h"
+
+using namespace pimax_openxr::perf_metrics;
+
+namespace {
+
+    XrPerformanceMetricsCounterMETA read(const Stats& stats, std::string_view path) {
+        const CounterDefinition* definition = findCounter(path);
+        CHECK(definition);
+        XrPerformanceMetricsCounterMETA counter{};
+        counter.type = XR_TYPE_PERFORMANCE_METRICS_COUNTER_META;
+        readCounter(stats, *definition, counter);
+        return counter;
+    }
+
+    void checkFloat(const XrPerformanceMetricsCounterMETA& counter,
+                    XrPerformanceMetricsCounterUnitMETA unit,
+                    float value) {
+        CHECK(counter.counterUnit == unit);
+        CHECK(counter.counterFlags == (XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META |
+                                       XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META));
+        CHECK_NEAR(counter.floatValue, value, 1e-3);
+        CHECK(counter.uintValue == 0);
+    }
+
+    void checkUint(const XrPerformanceMetricsCounterMETA& counter,
+                   XrPerformanceMetricsCounterUnitMETA unit,
+                   uint32_t value) {
+        CHECK(counter.counterUnit == unit);
+        CHECK(counter.counterFlags == (XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META |
+                                       XR_PERFORMANCE_METRICS_COUNTER_UINT_VALUE_VALID_BIT_META));
+        CHECK(counter.uintValue == value);
+        CHECK(counter.floatValue == 0.f);
+    }
+
+    // Submit frames on a synthetic clock, from the given time, and return the time after the last one.
+    double submit(PacingTracker& tracker, Stats& stats, double now, double interval, double frameInterval, int count) {
+        for (int i = 0; i < count; i++) {
+            now += interval;
+            tracker.update(stats, now, frameInterval);
+        }
+        return now;
+    }
+
+} // namespace
+
+int main() {
+    constexpr double FrameInterval = 1.0 / 90;
+
+    // Every counter is exported with its unit, and reads its own value.
+    {
+        Stats stats;
+        stats.appCpuFrameTimeMs = 4.5f;
+        stats.appGpuFrameTimeMs = 9.25f;
+        stats.precompositionTimeMs = 0.75f;
+        stats.compositorFps = 45.f;
+        stats.pacingErrorMs = 1.5f;
+        stats.droppedFrameCount = 3;
+
+        checkFloat(read(stats, "/perfmetrics_meta/app/cpu_frametime"),
+                   XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+                   4.5f);
+        checkFloat(read(stats, "/perfmetrics_meta/app/gpu_frametime"),
+                   XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+                   9.25f);
+        checkUint(read(stats, "/perfmetrics_meta/compositor/dropped_frame_count"),
+                  XR_PERFORMANCE_METRICS_COUNTER_UNIT_GENERIC_META,
+                  3);
+        checkFloat(read(stats, "/perfmetrics_pimax/runtime/precomposition_gpu_frametime"),
+                   XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+                   0.75f);
+        checkFloat(
+            read(stats, "/perfmetrics_pimax/compositor/fps"), XR_PERFORMANCE_METRICS_COUNTER_UNIT_HERTZ_META, 45.f);
+        checkFloat(read(stats, "/perfmetrics_pimax/app/pacing_error"),
+                   XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+                   1.5f);
+
+        CHECK(std::size(Counters) == 6);
+        CHECK(!findCounter("/perfmetrics_meta/app/unknown"));
+
+        stats.reset();
+        checkFloat(read(stats, "/perfmetrics_meta/app/gpu_frametime"),
+                   XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META,
+                   0.f);
+        checkUint(read(stats, "/perfmetrics_meta/compositor/dropped_frame_count"),
+                  XR_PERFORMANCE_METRICS_COUNTER_UNIT_GENERIC_META,
+                  0);
+    }
+
+    // On-time frames: no pacing error and no dropped frame.
+    {
+        Stats stats;
+        PacingTracker tracker;
+        submit(tracker, stats, 0.0, FrameInterval, FrameInterval, 90);
+        CHECK_NEAR(stats.pacingErrorMs.load(), 0.0, 1e-3);
+        CHECK(stats.droppedFrameCount == 0);
+    }
+
+    // Small jitter is a pacing error, but not a dropped frame.
+    {
+        Stats stats;
+        PacingTracker tracker;
+        double now = submit(tracker, stats, 0.0, FrameInterval, FrameInterval, 10);
+        now = submit(tracker, stats, now, FrameInterval + 0.002, FrameInterval, 1);
+        CHECK_NEAR(stats.pacingErrorMs.load(), 2.0, 1e-3);
+        CHECK(stats.droppedFrameCount == 0);
+    }
+
+    // Frames that miss their slot are counted as dropped over the last second only.
+    {
+        Stats stats;
+        PacingTracker tracker;
+        double now = submit(tracker, stats, 0.0, FrameInterval, FrameInterval, 10);
+
+        // Two slots went by: 1 dropped frame. Four slots: 3 more.
+        now = submit(tracker, stats, now, 2 * FrameInterval, FrameInterval, 1);
+        CHECK(stats.droppedFrameCount == 1);
+        CHECK_NEAR(stats.pacingErrorMs.load(), FrameInterval * 1e3, 1e-3);
+        now = submit(tracker, stats, now, 4 * FrameInterval, FrameInterval, 1);
+        CHECK(stats.droppedFrameCount == 4);
+
+        // The drops age out after one second.
+        now = submit(tracker, stats, now, FrameInterval, FrameInterval, 85);
+        CHECK(stats.droppedFrameCount == 4);
+        now = submit(tracker, stats, now, FrameInterval, FrameInterval, 2);
+        CHECK(stats.droppedFrameCount == 3);
+        submit(tracker, stats, now, FrameInterval, FrameInterval, 4);
+        CHECK(stats.droppedFrameCount == 0);
+    }
+
+    // With the frame rate divided (eg: Smart Smoothing at half rate), frames at the divided rate are on time.
+    {
+        Stats stats;
+        PacingTracker tracker;
+        double now = submit(tracker, stats, 0.0, 2 * FrameInterval, 2 * FrameInterval, 45);
+        CHECK_NEAR(stats.pacingErrorMs.load(), 0.0, 1e-3);
+        CHECK(stats.droppedFrameCount == 0);
+
+        // Missing one slot at the divided rate is one dropped frame.
+        submit(tracker, stats, now, 4 * FrameInterval, 2 * FrameInterval, 1);
+        CHECK(stats.droppedFrameCount == 1);
+        CHECK_NEAR(stats.pacingErrorMs.load(), 2 * FrameInterval * 1e3, 1e-3);
+    }
+
+    // Long pauses are not pacing issues, and a reset forgets the previous frames.
+    {
+        Stats stats;
+        PacingTracker tracker;
+        double now = submit(tracker, stats, 0.0, FrameInterval, FrameInterval, 10);
+        now = submit(tracker, stats, now, 5.0, FrameInterval, 1);
+        CHECK(stats.droppedFrameCount == 0);
+
+        now = submit(tracker, stats, now, 3 * FrameInterval, FrameInterval, 1);
+        CHECK(stats.droppedFrameCount == 2);
+        tracker.reset();
+        submit(tracker, stats, now, 0.5, FrameInterval, 1);
+        CHECK(stats.droppedFrameCount == 0);
+    }
+
+    return 0;
+}
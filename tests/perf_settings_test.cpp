@@ -0,0 +1,133 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "perf_settings.h"
+#include "test.h"
+
+using namespace pimax_openxr::perf_settings;
+
+namespace {
+
+    constexpr double FrameBudgetUs = 11111.0;
+
+    // Feed the same load for a number of frames, and return the levels notified.
+    std::vector<XrPerfSettingsNotificationLevelEXT> run(NotificationTracker& tracker, double load, int frames) {
+        std::vector<XrPerfSettingsNotificationLevelEXT> notified;
+        for (int i = 0; i < frames; i++) {
+            if (const auto level = tracker.update(load * FrameBudgetUs, FrameBudgetUs)) {
+                notified.push_back(level.value());
+            }
+        }
+        return notified;
+    }
+
+} // namespace
+
+int main() {
+    // The thresholds are 0.85 (warning) and 1.0 (impaired) of the frame budget.
+    {
+        NotificationTracker tracker;
+        CHECK(run(tracker, 0.84, 100).empty());
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    }
+    {
+        NotificationTracker tracker;
+        const auto notified = run(tracker, 0.86, 100);
+        CHECK(notified.size() == 1);
+        CHECK(notified[0] == XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+    }
+    {
+        NotificationTracker tracker;
+        const auto notified = run(tracker, 1.0, 100);
+        CHECK(notified.size() == 1);
+        CHECK(notified[0] == XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT);
+    }
+
+    // A new level is only reported once it persisted for 5 frames.
+    {
+        NotificationTracker tracker;
+        CHECK(run(tracker, 0.9, 4).empty());
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+        CHECK(run(tracker, 0.9, 1).size() == 1);
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+    }
+
+    // A spike that does not persist is not reported.
+    {
+        NotificationTracker tracker;
+        CHECK(run(tracker, 0.9, 3).empty());
+        CHECK(run(tracker, 0.5, 100).empty());
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    }
+
+    // Up and down through all levels, with the hysteresis of 0.05 when leaving a level.
+    {
+        NotificationTracker tracker;
+        auto notified = run(tracker, 0.9, 100);
+        CHECK(notified.size() == 1 && notified[0] == XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+
+        // Between 0.8 and 0.85, the warning level is kept.
+        CHECK(run(tracker, 0.82, 100).empty());
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+
+        notified = run(tracker, 1.1, 100);
+        CHECK(notified.size() == 1 && notified[0] == XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT);
+
+        // Between 0.95 and 1.0, the impaired level is kept.
+        CHECK(run(tracker, 0.97, 100).empty());
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT);
+
+        notified = run(tracker, 0.9, 100);
+        CHECK(notified.size() == 1 && notified[0] == XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+
+        notified = run(tracker, 0.78, 100);
+        CHECK(notified.size() == 1 && notified[0] == XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+
+        // From impaired straight down to normal.
+        run(tracker, 1.2, 100);
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT);
+        notified = run(tracker, 0.5, 100);
+        CHECK(!notified.empty());
+        CHECK(notified.back() == XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    }
+
+    // The timers are not ready.
+    {
+        NotificationTracker tracker;
+        CHECK(!tracker.update(0.0, FrameBudgetUs));
+        CHECK(!tracker.update(20000.0, 0.0));
+        CHECK(tracker.getLevel() == XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    }
+
+    // The GPU level biases the render time hinted to the compositor.
+    {
+        CHECK(adjustClientRenderTime(8.0, 11.0, XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT) == 8.0);
+        CHECK_NEAR(adjustClientRenderTime(8.0, 11.0, XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT), 11.55, 1e-9);
+        CHECK_NEAR(adjustClientRenderTime(8.0, 11.0, XR_PERF_SETTINGS_LEVEL_SUSTAINED_LOW_EXT), 9.1, 1e-9);
+        CHECK_NEAR(adjustClientRenderTime(8.0, 11.0, XR_PERF_SETTINGS_LEVEL_BOOST_EXT), 6.9, 1e-9);
+        CHECK(adjustClientRenderTime(0.5, 11.0, XR_PERF_SETTINGS_LEVEL_BOOST_EXT) == 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "pose_history.h"
+#include "test.h"
+
+using namespace pimax_openxr::pose_history;
+
+// A head moving on a circle (10 cm radius, 1 Hz) while yawing at 2 rad/s.
+static Sample getTruth(double time) {
+    const double w = 2 * M_PI;
+    const double yaw = 2 * time;
+    Sample sample;
+    sample.time = time;
+    sample.position = {0.1 * std::cos(w * time), 1.6, 0.1 * std::sin(w * time)};
+    sample.linearVelocity = {-0.1 * w * std::sin(w * time), 0.0, 0.1 * w * std::cos(w * time)};
+    sample.orientation = {0.0, std::sin(yaw / 2), 0.0, std::cos(yaw / 2)};
+    sample.angularVelocity = {0.0, 2.0, 0.0};
+    sample.statusFlags = 3;
+    return sample;
+}
+
+static double getPositionError(const Sample& a, const Sample& b) {
+    return std::hypot(a.position.x - b.position.x, a.position.y - b.position.y, a.position.z - b.position.z);
+}
+
+static double getAngleError(const Sample& a, const Sample& b) {
+    const double dot = a.orientation.x * b.orientation.x + a.orientation.y * b.orientation.y +
+                       a.orientation.z * b.orientation.z + a.orientation.w * b.orientation.w;
+    return 2 * std::acos(std::min(1.0, std::abs(dot)));
+}
+
+int main() {
+    // 2 seconds of samples at 500 Hz.
+    History<512> history;
+    for (int i = 0; i < 1000; i++) {
+        history.push(getTruth(i * 0.002));
+    }
+
+    // Outside of the history.
+    CHECK(!history.sample(2.5, 0.01));
+    CHECK(!history.sample(0.5, 0.01));
+
+    // Interpolation within the history.
+    for (double time = 1.5; time < 1.997; time += 0.00037) {
+        const auto sample = history.sample(time, 0.01);
+        CHECK(sample);
+        const Sample truth = getTruth(time);
+        CHECK(getPositionError(sample.value(), truth) < 1e-6);
+        CHECK(getAngleError(sample.value(), truth) < 1e-4);
+        CHECK(sample->statusFlags == 3);
+    }
+
+    // Exact timestamp.
+    CHECK(getPositionError(history.sample(1.998, 0.01).value(), getTruth(1.998)) < 1e-9);
+
+    // The samples are too far apart.
+    CHECK(!history.sample(1.5, 0.001));
+
+    // With a 20 ms gap, the Hermite interpolation is far more accurate than a linear one.
+    {
+        const Sample a = getTruth(0.0);
+        const Sample b = getTruth(0.02);
+        const Sample truth = getTruth(0.01);
+        Sample linear;
+        linear.position = lerp(a.position, b.position, 0.5);
+        CHECK(getPositionError(interpolate(a, b, 0.01), truth) * 100 < getPositionError(linear, truth));
+    }
+
+    // The status is the intersection of both samples.
+    {
+        Sample a = getTruth(0.0);
+        Sample b = getTruth(0.01);
+        b.statusFlags = 1;
+        CHECK(interpolate(a, b, 0.005).statusFlags == 1);
+    }
+
+    return 0;
+}
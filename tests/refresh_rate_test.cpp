@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "refresh_rate.h"
+#include "test.h"
+
+using namespace pimax_openxr::refresh_rate;
+
+// A simulated display, that takes `switchDelay` seconds to apply a new rate.
+struct MockDisplay : IDisplay {
+    std::vector<float> supportedRates{72.f, 90.f, 120.f};
+    float currentRate{89.99f};
+    std::optional<float> requestedRate;
+    double now{0.0};
+    double requestTime{0.0};
+    double switchDelay{1.0};
+    uint32_t requestCount{0};
+    bool rejectRequests{false};
+
+    std::vector<float> getSupportedRates() override {
+        return supportedRates;
+    }
+
+    float getCurrentRate() override {
+        return currentRate;
+    }
+
+    bool requestRate(float rate) override {
+        if (rejectRequests) {
+            return false;
+        }
+        requestedRate = rate;
+        requestTime = now;
+        requestCount++;
+        return true;
+    }
+
+    void tick(double time) {
+        now = time;
+        if (requestedRate && now - requestTime >= switchDelay) {
+            currentRate = requestedRate.value();
+            requestedRate.reset();
+        }
+    }
+};
+
+int main() {
+    CHECK(isSameRate(89.99f, 90.f));
+    CHECK(!isSameRate(72.f, 90.f));
+
+    // Requesting the current rate does nothing.
+    {
+        MockDisplay display;
+        ModeSwitcher switcher;
+        CHECK(switcher.request(display, 90.f, 0.0));
+        CHECK(display.requestCount == 0);
+        CHECK(switcher.update(display, 0.0) == SwitchStatus::Idle);
+    }
+
+    // A switch completes once the display reports the new rate.
+    {
+        MockDisplay display;
+        ModeSwitcher switcher;
+        CHECK(switcher.request(display, 120.f, 0.0));
+        CHECK(switcher.request(display, 120.f, 0.1));
+        CHECK(display.requestCount == 1);
+        CHECK(switcher.getPendingRate().value() == 120.f);
+        display.tick(0.5);
+        CHECK(switcher.update(display, 0.5) == SwitchStatus::Pending);
+        display.tick(1.0);
+        CHECK(switcher.update(display, 1.0) == SwitchStatus::Completed);
+        CHECK(!switcher.getPendingRate());
+        CHECK(switcher.update(display, 1.1) == SwitchStatus::Idle);
+    }
+
+    // A newer request supersedes the pending one.
+    {
+        MockDisplay display;
+        ModeSwitcher switcher;
+        CHECK(switcher.request(display, 120.f, 0.0));
+        CHECK(switcher.request(display, 72.f, 0.2));
+        CHECK(display.requestCount == 2);
+        CHECK(switcher.getPendingRate().value() == 72.f);
+        display.tick(1.0);
+        CHECK(switcher.update(display, 1.0) == SwitchStatus::Completed);
+        CHECK(display.currentRate == 72.f);
+    }
+
+    // A display that never switches times out.
+    {
+        MockDisplay display;
+        display.switchDelay = 100.0;
+        ModeSwitcher switcher(5.0);
+        CHECK(switcher.request(display, 72.f, 0.0));
+        CHECK(switcher.update(display, 4.0) == SwitchStatus::Pending);
+        CHECK(switcher.update(display, 5.5) == SwitchStatus::TimedOut);
+        CHECK(!switcher.getPendingRate());
+    }
+
+    // A rejected request.
+    {
+        MockDisplay display;
+        display.rejectRequests = true;
+        ModeSwitcher switcher;
+        CHECK(!switcher.request(display, 72.f, 0.0));
+        CHECK(switcher.update(display, 0.0) == SwitchStatus::Idle);
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "shader_cache.h"
+#include "test.h"
+
+using namespace pimax_openxr::shader_cache;
+
+int main() {
+    // The key covers everything that affects the bytecode.
+    const uint64_t key = computeKey("abc", "main", "cs_5_0", 1, 47, "0.1");
+    CHECK(key == computeKey("abc", "main", "cs_5_0", 1, 47, "0.1"));
+    CHECK(key != computeKey("abc", "main", "cs_5_0", 2, 47, "0.1"));
+    CHECK(key != computeKey("abc", "main", "cs_5_0", 1, 48, "0.1"));
+    CHECK(key != computeKey("abc", "main", "cs_5_0", 1, 47, "0.2"));
+    CHECK(computeKey("ab", "cmain", "x", 0, 0, "") != computeKey("abc", "main", "x", 0, 0, ""));
+
+    // Serialization, and rejection of stale or corrupted files.
+    const std::vector<uint8_t> bytecode{1, 2, 3, 4, 5};
+    const auto file = serialize(key, bytecode.data(), bytecode.size());
+    CHECK(deserialize(key, file).value() == bytecode);
+    CHECK(!deserialize(key + 1, file));
+    auto corrupted = file;
+    corrupted.back() ^= 1;
+    CHECK(!deserialize(key, corrupted));
+    auto truncated = file;
+    truncated.pop_back();
+    CHECK(!deserialize(key, truncated));
+    CHECK(!deserialize(key, {}));
+
+    // Storage.
+    const auto directory = std::filesystem::temp_directory_path() / "pimax-openxr-shader-cache-test";
+    std::filesystem::remove_all(directory);
+    CHECK(!load(directory, key));
+    CHECK(store(directory, key, bytecode.data(), bytecode.size()));
+    CHECK(load(directory, key).value() == bytecode);
+    CHECK(!load(directory, key + 1));
+    size_t fileCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        (void)entry;
+        fileCount++;
+    }
+    CHECK(fileCount == 1);
+    std::filesystem::remove_all(directory);
+
+    return 0;
+}
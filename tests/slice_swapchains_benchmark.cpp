@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "slice_swapchains.h"
+#include "test.h"
+
+using namespace pimax_openxr::slice_swapchains;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // A stand-in for the creation of a PVR swapchain with its textures.
+    constexpr auto CreateSwapchainTime = 3ms;
+
+    // The time that the application spends rendering a frame.
+    constexpr auto RenderTime = 2ms;
+
+    // A stereo color and depth swapchain, each a texture array with one slice per eye.
+    constexpr int SwapchainCount = 2;
+    constexpr uint32_t ArraySize = 2;
+
+    constexpr int FrameCount = 10;
+
+    void createSwapchain(uint32_t) {
+        std::this_thread::sleep_for(CreateSwapchainTime);
+    }
+
+    double toMs(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // The time spent enumerating the swapchain images, then the time of each of the first frames.
+    std::vector<double> measure(bool eager) {
+        std::vector<double> times;
+        std::vector<Tracker> trackers(SwapchainCount);
+
+        // xrEnumerateSwapchainImages().
+        const auto enumerateStart = Clock::now();
+        for (auto& tracker : trackers) {
+            tracker.reset(ArraySize);
+            if (eager) {
+                tracker.createAll(0, createSwapchain);
+            }
+        }
+        times.push_back(toMs(Clock::now() - enumerateStart));
+
+        for (uint64_t frame = 0; frame < FrameCount; frame++) {
+            const auto frameStart = Clock::now();
+            std::this_thread::sleep_for(RenderTime);
+
+            // xrEndFrame() commits all the slices.
+            for (auto& tracker : trackers) {
+                for (uint32_t slice = 0; slice < ArraySize; slice++) {
+                    tracker.use(slice, createSwapchain);
+                }
+                tracker.releaseUnused(frame, [](uint32_t) {});
+            }
+            times.push_back(toMs(Clock::now() - frameStart));
+        }
+
+        return times;
+    }
+
+} // namespace
+
+// The cost of creating the slice swapchains while enumerating the images versus during the first frame, which shows as
+// a stutter when the application starts rendering.
+int main() {
+    const auto lazy = measure(false);
+    const auto eager = measure(true);
+
+    std::printf("           Lazy      Eager\n");
+    std::printf("Enumerate  %6.2f ms %6.2f ms\n", lazy[0], eager[0]);
+    for (int frame = 0; frame < FrameCount; frame++) {
+        std::printf("Frame %-3d  %6.2f ms %6.2f ms\n", frame, lazy[frame + 1], eager[frame + 1]);
+    }
+
+    CHECK(eager[1] < lazy[1]);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "slice_swapchains.h"
+#include "test.h"
+
+using namespace pimax_openxr::slice_swapchains;
+
+int main() {
+    // Without eager creation, each slice is created upon its first commit, and never released.
+    {
+        Tracker tracker;
+        tracker.reset(3);
+        CHECK(tracker.isCreated(0));
+        CHECK(!tracker.isCreated(1));
+        CHECK(!tracker.isCreated(2));
+
+        std::vector<uint32_t> created;
+        const auto create = [&](uint32_t slice) { created.push_back(slice); };
+        tracker.use(0, create);
+        tracker.use(1, create);
+        tracker.use(1, create);
+        CHECK(created == std::vector<uint32_t>({1}));
+        CHECK(tracker.isUsed(0));
+        CHECK(tracker.isUsed(1));
+        CHECK(!tracker.isUsed(2));
+
+        CHECK(tracker.releaseUnused(100000, [](uint32_t) { CHECK(false); }) == 0);
+        CHECK(tracker.isCreated(1));
+    }
+
+    // With eager creation, all the slices are created at once, and the ones never committed are released after the
+    // deadline.
+    {
+        Tracker tracker;
+        tracker.reset(3);
+
+        std::vector<uint32_t> created;
+        const auto create = [&](uint32_t slice) { created.push_back(slice); };
+        CHECK(tracker.createAll(10, create) == 10 + MaxUnusedFrames);
+        CHECK(created == std::vector<uint32_t>({1, 2}));
+        CHECK(tracker.getUnusedDeadline() == 10 + MaxUnusedFrames);
+
+        // Committing the slice does not create it again.
+        tracker.use(1, create);
+        CHECK(created.size() == 2);
+
+        std::vector<uint32_t> released;
+        const auto release = [&](uint32_t slice) { released.push_back(slice); };
+        CHECK(tracker.releaseUnused(10 + MaxUnusedFrames - 1, release) == 10 + MaxUnusedFrames);
+        CHECK(released.empty());
+        CHECK(tracker.releaseUnused(10 + MaxUnusedFrames, release) == 0);
+        CHECK(released == std::vector<uint32_t>({2}));
+        CHECK(tracker.isCreated(1));
+        CHECK(!tracker.isCreated(2));
+
+        // The deadline only applies once.
+        CHECK(tracker.releaseUnused(100000, release) == 0);
+        CHECK(released.size() == 1);
+
+        // A released slice is created again if the application starts using it.
+        tracker.use(2, create);
+        CHECK(created == std::vector<uint32_t>({1, 2, 2}));
+        CHECK(tracker.isCreated(2));
+    }
+
+    // Nothing to create ahead of time for a swapchain that is not an array.
+    {
+        Tracker tracker;
+        tracker.reset(1);
+        CHECK(tracker.createAll(10, [](uint32_t) { CHECK(false); }) == 0);
+        CHECK(tracker.getUnusedDeadline() == 0);
+    }
+
+    CHECK(earliestDeadline(0, 0) == 0);
+    CHECK(earliestDeadline(0, 5) == 5);
+    CHECK(earliestDeadline(5, 0) == 5);
+    CHECK(earliestDeadline(7, 5) == 5);
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "smoothing_governor.h"
+#include "test.h"
+
+using namespace pimax_openxr::smoothing_governor;
+
+int main() {
+    const double frameBudgetUs = 1e6 / 90;
+
+    // Engage when the application cannot sustain the rate, release once it can again.
+    {
+        Governor governor;
+        std::vector<std::pair<int, uint32_t>> decisions;
+        for (int i = 0; i < 2000; i++) {
+            const double frameTimeUs = i < 600 ? 12000 : 8000;
+            const auto divisor = governor.update(frameTimeUs, frameBudgetUs, i / 90.0);
+            if (divisor) {
+                decisions.push_back({i, divisor.value()});
+            }
+        }
+        CHECK(decisions.size() == 2);
+        CHECK(decisions[0].second == 2);
+        CHECK(decisions[0].first == (int)governor.getSettings().engageScore - 1);
+        CHECK(decisions[1].second == 1);
+        CHECK(decisions[1].first == 600 + (int)governor.getSettings().releaseFrames - 1);
+        CHECK(!governor.isEngaged());
+    }
+
+    // Occasional misses never engage.
+    {
+        Governor governor;
+        for (int i = 0; i < 2000; i++) {
+            const double frameTimeUs = i % 2 ? 12000 : 8000;
+            CHECK(!governor.update(frameTimeUs, frameBudgetUs, i / 90.0));
+        }
+        CHECK(governor.getDivisor() == 1);
+    }
+
+    // A load between the release and engage thresholds keeps smoothing engaged.
+    {
+        Governor governor;
+        for (int i = 0; i < 100; i++) {
+            governor.update(12000, frameBudgetUs, i / 90.0);
+        }
+        CHECK(governor.isEngaged());
+        for (int i = 100; i < 2000; i++) {
+            CHECK(!governor.update(10500, frameBudgetUs, i / 90.0));
+        }
+        CHECK(governor.getDivisor() == 2);
+        CHECK(governor.getFitFrames() == 0);
+    }
+
+    // Decisions are at least minimumDwellTime apart.
+    {
+        GovernorSettings settings;
+        settings.engageScore = 1;
+        settings.releaseFrames = 1;
+        Governor governor(settings);
+        double lastDecision = -1e9;
+        for (int i = 0; i < 2000; i++) {
+            const double now = i / 90.0;
+            if (governor.update((i / 50) % 2 ? 12000 : 8000, frameBudgetUs, now)) {
+                CHECK(now - lastDecision >= settings.minimumDwellTime);
+                lastDecision = now;
+            }
+        }
+    }
+
+    // The timers are not ready.
+    {
+        Governor governor;
+        CHECK(!governor.update(0, frameBudgetUs, 0));
+        CHECK(governor.getMissScore() == 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "action_snapshot.h"
+#include "test.h"
+
+using namespace pimax_openxr::action_snapshot;
+
+namespace {
+
+    // Mirrors the binding of an action space in the runtime. Every field is derived from the version, so that a torn
+    // binding is detected.
+    struct Binding {
+        uint64_t version{0};
+        int side{-1};
+        bool isEyeGaze{false};
+        float pose[7]{};
+    };
+
+    Binding resolve(uint64_t version) {
+        Binding binding;
+        binding.side = (int)(version % 2);
+        binding.isEyeGaze = version % 3 == 0;
+        for (auto& value : binding.pose) {
+            value = (float)version;
+        }
+        binding.version = version;
+        return binding;
+    }
+
+    void checkBinding(const Binding& binding) {
+        CHECK(binding.side == (int)(binding.version % 2));
+        CHECK(binding.isEyeGaze == (binding.version % 3 == 0));
+        for (const auto& value : binding.pose) {
+            CHECK(value == (float)binding.version);
+        }
+    }
+
+} // namespace
+
+// Several threads locating the same action space while the bindings are invalidated. Compare publishing an immutable
+// binding (as the runtime does) against swapping a shared_ptr with std::atomic_load/store (which take a lock from a
+// global pool), and against guarding a shared binding with a lock.
+int main() {
+    constexpr int ThreadCount = 2;
+    constexpr int LocateCount = 50000;
+    constexpr int RebindInterval = 1000;
+
+    const auto measure = [&](const char* name, const auto& locate) {
+        std::atomic<uint64_t> currentVersion{1};
+        std::vector<std::thread> threads;
+        const auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < ThreadCount; t++) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < LocateCount; i++) {
+                    if (t == 0 && i % RebindInterval == 0) {
+                        currentVersion++;
+                    }
+                    locate(currentVersion.load());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const auto duration = std::chrono::steady_clock::now() - start;
+        std::printf("%s: %.1f ns/locate\n",
+                    name,
+                    std::chrono::duration<double, std::nano>(duration).count() / (ThreadCount * LocateCount));
+    };
+
+    {
+        Publisher<Binding> binding;
+        measure("Published binding", [&](uint64_t version) {
+            auto current = binding.get();
+            if (!current || current->version != version) {
+                binding.publish(std::make_unique<const Binding>(resolve(version)));
+                current.reload();
+            }
+            checkBinding(*current);
+        });
+    }
+
+    {
+        std::shared_ptr<const Binding> binding;
+        measure("Atomic shared_ptr binding", [&](uint64_t version) {
+            auto current = std::atomic_load(&binding);
+            if (!current || current->version != version) {
+                current = std::make_shared<const Binding>(resolve(version));
+                std::atomic_store(&binding, current);
+            }
+            checkBinding(*current);
+        });
+    }
+
+    {
+        std::mutex lock;
+        Binding binding;
+        measure("Locked binding", [&](uint64_t version) {
+            Binding current;
+            {
+                std::unique_lock lk(lock);
+                if (binding.version != version) {
+                    binding = resolve(version);
+                }
+                current = binding;
+            }
+            checkBinding(current);
+        });
+    }
+
+    return 0;
+}
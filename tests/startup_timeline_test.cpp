@@ -0,0 +1,43 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "startup_timeline.h"
+#include "test.h"
+
+using namespace pimax_openxr::startup_timeline;
+
+int main() {
+    Timeline timeline;
+    const auto start = Clock::now();
+    CHECK(timeline.record("negotiate", start, start + 2ms));
+    CHECK(timeline.record("pvr_init", start + 3ms, start + 123ms));
+
+    // Only the first occurrence of a phase is recorded.
+    CHECK(!timeline.record("negotiate", start, start + 50ms));
+    CHECK(timeline.getCount() == 2);
+
+    CHECK(timeline.format() == "negotiate 2.0 ms (+2.0 ms), pvr_init 120.0 ms (+123.0 ms)");
+
+    return 0;
+}
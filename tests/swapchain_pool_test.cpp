@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "swapchain_pool.h"
+#include "test.h"
+
+using namespace pimax_openxr;
+
+// Stands for the PVR swapchain functions: the swapchains are integers, and their creation and destruction are counted.
+struct MockPvr {
+    struct Desc {
+        int format;
+        int width;
+        int height;
+
+        bool operator==(const Desc& other) const {
+            return format == other.format && width == other.width && height == other.height;
+        }
+    };
+
+    int next{1};
+    int createdCount{0};
+    int destroyedCount{0};
+    std::set<int> live;
+
+    int createSwapchain() {
+        createdCount++;
+        live.insert(next);
+        return next++;
+    }
+
+    void destroySwapchain(int swapchain) {
+        CHECK(live.erase(swapchain) == 1);
+        destroyedCount++;
+    }
+};
+
+int main() {
+    using Desc = MockPvr::Desc;
+
+    MockPvr pvr;
+    swapchain_pool::RecyclingPool<Desc, int> pool;
+    const auto evict = [&](int swapchain, uint64_t) { pvr.destroySwapchain(swapchain); };
+    const auto create = [&](const Desc& desc) {
+        const auto recycled = pool.take(desc);
+        return recycled ? recycled.value() : pvr.createSwapchain();
+    };
+    const auto destroy = [&](const Desc& desc, int swapchain) {
+        pool.retire(desc, swapchain, (uint64_t)desc.width * desc.height, evict);
+    };
+
+    // The pool is disabled by default: swapchains are destroyed immediately.
+    const Desc a{1, 100, 100}, b{1, 50, 50}, c{2, 150, 100};
+    destroy(a, create(a));
+    CHECK(pvr.destroyedCount == 1);
+    CHECK(pool.getCount() == 0);
+
+    // Toggling between two resolutions only creates each swapchain once.
+    pool.setMaxSize(25000);
+    for (int i = 0; i < 10; i++) {
+        const int swapchainA = create(a);
+        const int swapchainB = create(b);
+        destroy(a, swapchainA);
+        destroy(b, swapchainB);
+    }
+    CHECK(pvr.createdCount == 3);
+    CHECK(pool.getCount() == 2);
+    CHECK(pool.getSize() == 12500);
+
+    // A different format is a miss.
+    const int swapchainC = create(c);
+    CHECK(pvr.createdCount == 4);
+
+    // Going over the size limit evicts the least recently retired swapchain first.
+    destroy(c, swapchainC);
+    CHECK(pool.getSize() <= 25000);
+    CHECK(pool.getCount() == 2);
+    CHECK(!pool.take(a));
+    CHECK(pool.take(c));
+    CHECK(pool.take(b));
+
+    // The most recently retired swapchain is taken first.
+    const int first = pvr.createSwapchain();
+    const int second = pvr.createSwapchain();
+    destroy(b, first);
+    destroy(b, second);
+    CHECK(pool.take(b).value() == second);
+
+    // A swapchain larger than the limit is destroyed right away.
+    const Desc huge{1, 1000, 1000};
+    const int swapchainHuge = pvr.createSwapchain();
+    destroy(huge, swapchainHuge);
+    CHECK(!pvr.live.count(swapchainHuge));
+
+    pool.clear(evict);
+    CHECK(pool.getCount() == 0);
+    CHECK(pool.getSize() == 0);
+    CHECK(pool.getHitCount() > 0);
+    CHECK(pool.getMissCount() > 0);
+    CHECK(pool.getEvictedCount() > 0);
+
+    return 0;
+}